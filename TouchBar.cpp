@@ -2,6 +2,51 @@
 
 
 
+/* Position arithmetic */
+// Value + Step can run past the top of TouchBarPosition (65535, or 4294967295 with TouchBarWide) when Value is near it or the Step is big (a fling, or a wide Resolution), and then it wraps round to a small number.
+// Comparing the room left with the Step rather then adding first never overflows, and it's no slower. (Same idea as Ramp().)
+TouchBarPosition TouchBarUp (TouchBarPosition Value, TouchBarPosition Step, TouchBarPosition Limit)
+{
+  if (Value >= Limit || Limit - Value <= Step)
+    return Limit;
+  return Value + Step;
+}
+
+TouchBarPosition TouchBarDown (TouchBarPosition Value, TouchBarPosition Step)
+{
+  if (Value <= Step)
+    return 0;
+  return Value - Step;
+}
+
+TouchBarPosition TouchBarAround (TouchBarPosition Value, TouchBarPosition Step, TouchBarPosition Limit, boolean Up)
+{
+  // Both below Limit first, then it's a step less then once round either way.
+  Value %= Limit;
+  Step %= Limit;
+  if (Up)
+  {
+    if (Value >= Limit - Step)
+      return Value - (Limit - Step);
+    return Value + Step;
+  }
+  if (Value >= Step)
+    return Value - Step;
+  return Value + (Limit - Step);
+}
+
+TouchBarPosition TouchBarScale (TouchBarPosition Value, TouchBarPosition Numerator, TouchBarPosition Denominator)
+{
+#ifdef TouchBarWide
+  // Numerator * Value doesn't fit 32 bits, so the whole part of Numerator / Denominator goes first. The rest is less then Denominator, that fits as long as Denominator does 16 bits.
+  return Numerator / Denominator * Value + Numerator % Denominator * Value / Denominator;
+#else
+  return (unsigned long)Value * Numerator / Denominator;
+#endif
+}
+
+
+
 /* General */
 TouchBar::TouchBar (TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr)
 {
@@ -10,12 +55,36 @@ TouchBar::TouchBar (TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr)
   Current = Config->Default;
   Previous = Config->Default;
   Target = Config->Default;
+#ifdef TouchBarRampProfiles
+  RampTo = Config->Default;
+#endif
 }
 
 void TouchBar::Reconfigure (TouchBarConfig *ConfigPtr)
 {
+#ifdef TouchBarRampProfiles
+  if (ProfileRamping ())
+    Current = RampPosition (Common->Clock ()); // Stop where it is right now.
+#endif
   Config = ConfigPtr;
   Target = Current;
+  Steady = false;
+}
+
+void TouchBar::SetEventRing (TouchBarEventRing *RingPtr)
+{
+  Events = RingPtr;
+}
+
+void TouchBar::SetCallback (TouchBarCallback Function, void *Context)
+{
+  Callback = Function;
+  CallbackContext = Context;
+}
+
+void TouchBar::SetRecorder (TouchBarRecorder *RecorderPtr)
+{
+  Recorder = RecorderPtr;
 }
 
 
@@ -27,16 +96,30 @@ void TouchBar::Reset ()
     Target = Config->Default;
   else
     Current = Config->Default;
+#ifdef TouchBarSwipeSpeed
+  FlingVelocity = 0;
+#endif
+  Steady = false;
 }
 
-void TouchBar::SetPosition (unsigned int NewPosition)
+void TouchBar::SetPosition (TouchBarPosition NewPosition)
 {
   Current = NewPosition;
+#ifdef TouchBarSwipeSpeed
+  FlingVelocity = 0;
+#endif
+  if (Common->Clock != 0)
+    RampCounter = 0; // Any ramp in progress starts over from the new position.
+  Steady = false;
 }
 
-void TouchBar::SetTarget (unsigned int NewTarget)
+void TouchBar::SetTarget (TouchBarPosition NewTarget)
 {
   Target = NewTarget;
+#ifdef TouchBarSwipeSpeed
+  FlingVelocity = 0;
+#endif
+  Steady = false;
 }
 
 
@@ -44,16 +127,39 @@ void TouchBar::SetTarget (unsigned int NewTarget)
 /* Input / Output */
 void TouchBar::Update (byte NewValue) // This compiles to 30 bytes less then the other Update method.
 {
+  if (Recorder != 0)
+    Recorder->Record (NewValue & 0x07); // Before anything else, the idle samples count too.
+  if (Steady && (NewValue & 0x07) == 0)
+    return; // Nothing touched, nothing to do...
+
+#ifdef TouchBarInstrumentation
+  unsigned long Start = TouchBarCost ();
+#endif
+  if (Common->Clock != 0)
+    Now = Common->Clock ();
   Shift ();
   
   //TwitchSuppression (NewValue % 8); // This is more beginner friendly...
   TwitchSuppression (NewValue & 0x07);
 
   Main ();
+#ifdef TouchBarInstrumentation
+  Count (TouchBarCost () - Start);
+#endif
 }
 
 void TouchBar::Update (boolean A, boolean B, boolean C)
 {
+  if (Recorder != 0)
+    Recorder->Record (C << 2 | B << 1 | A);
+  if (Steady && !(A || B || C))
+    return;
+
+#ifdef TouchBarInstrumentation
+  unsigned long Start = TouchBarCost ();
+#endif
+  if (Common->Clock != 0)
+    Now = Common->Clock ();
   Shift ();
   
   byte X = 0;
@@ -70,6 +176,9 @@ void TouchBar::Update (boolean A, boolean B, boolean C)
   TwitchSuppression (X);
   
   Main ();
+#ifdef TouchBarInstrumentation
+  Count (TouchBarCost () - Start);
+#endif
 }
 
 void TouchBar::Shift ()
@@ -84,35 +193,147 @@ void TouchBar::Shift ()
 
 void TouchBar::TwitchSuppression (byte NewValue)
 {
-  if (TSCounter < 255)
-    TSCounter += 1;
-  if (NewValue != Raw)
-    TSCounter = 0;
+#ifdef TouchBarDebouncer
+  if (Common->DebounceDelay != 0)
+  {
+    Debounce (NewValue);
+    return;
+  }
+#endif
+
+  boolean Settled;
+  if (Common->Clock == 0)
+  {
+    if (TSCounter < 255)
+      TSCounter += 1;
+    if (NewValue != Raw)
+      TSCounter = 0;
+    Settled = TSCounter == Common->TwitchSuppressionDelay;
+  }
+  else
+  {
+    if (NewValue != Raw)
+      TSStart = Now;
+    Settled = Now - TSStart >= Common->TwitchSuppressionTime; // Unsigned subtraction, so it survives the clock rolling over.
+  }
   
-  if (NewValue != ABCPads && NewValue != 0 && ABCPads != 0 || NewValue ^ ABCPads && TSCounter == Common->TwitchSuppressionDelay)
+  if (NewValue != ABCPads && NewValue != 0 && ABCPads != 0 || NewValue ^ ABCPads && Settled)
     ABCPads = NewValue; // This does the same, compiles to the same size
+#ifdef TouchBarInstrumentation
+  else if (NewValue != ABCPads)
+    Counters.Rejected += 1;
+#endif
+
+  Raw = NewValue;
+}
+
+#ifdef TouchBarDebouncer
+void TouchBar::Debounce (byte NewValue)
+{
+  // TwitchSuppression() starts over whenever any pad changes, so a twitching pad holds back the release of another one. Here every pad has its own counter:
+  // it counts the samples the pad's been different from ABCPads in a row, and the pad flips when it reaches DebounceDelay.
+  // The counters are vertical, DebounceCounter[k] holds bit k of all 3 (bit 0 = pad A...), so all 3 are counted at once with a few byte operations per bit.
+  // Only the pads in Raw ^ ABCPads are ever left counting, so with nothing changing there's nothing to do.
+  byte Changing = NewValue ^ ABCPads;
+  if (Changing == 0 && Raw == ABCPads)
+    return;
+
+  byte Carry = Changing;
+  byte Settled = Changing;
+  unsigned int Delay = Common->DebounceDelay;
+  if ((Delay >> DebounceBits) != 0)
+    Delay = (1U << DebounceBits) - 1;
+  for (byte k = 0; k < DebounceBits && (Delay >> k) != 0; k++) // The counters never go past Delay, the bits above it stay 0.
+  {
+    byte Next = DebounceCounter[k] & Carry;
+    DebounceCounter[k] = (DebounceCounter[k] ^ Carry) & Changing; // Count up the pads that are still different, the rest start over.
+    Carry = Next;
+    if (bitRead(Delay, k))
+      Settled &= DebounceCounter[k];
+    else
+      Settled &= ~DebounceCounter[k];
+  }
+
+  // Same rule as TwitchSuppression(): from touching one pad combination to another (a swipe) passes straight away.
+  if (NewValue != ABCPads && NewValue != 0 && ABCPads != 0)
+    Settled = Changing;
+  if (Settled != 0)
+  {
+    ABCPads ^= Settled;
+    for (byte k = 0; k < DebounceBits; k++)
+      DebounceCounter[k] &= ~Settled; // Those start over.
+  }
+#ifdef TouchBarInstrumentation
+  if (NewValue != ABCPads)
+    Counters.Rejected += 1;
+#endif
 
   Raw = NewValue;
 }
+#endif
+
+boolean TouchBar::Idle ()
+{
+  return Steady;
+}
+
+#ifdef TouchBarInstrumentation
+const TouchBarCounters *TouchBar::GetCounters ()
+{
+  return &Counters;
+}
+
+void TouchBar::ResetCounters ()
+{
+  TouchBarCounters Zero = {};
+  Counters = Zero;
+}
+
+void TouchBar::Count (unsigned long Cost)
+{
+  Counters.Updates += 1;
+  byte Bucket = 0;
+  while (Cost != 0 && Bucket < 15)
+  {
+    Cost >>= 1;
+    Bucket += 1;
+  }
+  if (Counters.Cost[Bucket] < 65535)
+    Counters.Cost[Bucket] += 1;
+}
+#endif
 
 boolean TouchBar::Event ()
 {
   if (Current != Previous)
     return true;
-  else
-    return false;
+#ifdef TouchBarRampProfiles
+  if (ProfileRamping ())
+    return true;
+#endif
+  return false;
 }
 
 char TouchBar::PadEvent ()
 {
-  if (TapCounter < Common->TapTimeout && ABCPads == 0 && ABCPrevious[0] != 0)
+  boolean InTime;
+  if (Common->Clock == 0)
+    InTime = TapCounter < Common->TapTimeout;
+  else
+    InTime = TapCounter == 0; // In wall-clock mode Main() keeps TapCounter at 0 until TapTime runs out.
+
+  if (InTime && ABCPads == 0 && ABCPrevious[0] != 0)
     switch (ABCPrevious[0])
     {
-      case 1: return 'A';
+      case 1: if (Config->GetFlipFlag() == true) // The pads are no longer swapped with the Flip flag set (see GetDirection()), so A and C are swapped here.
+                return 'C';
+              return 'A';
       break;;
       case 2: return 'B';
       break;;
-      case 4: return 'C';
+      case 4: if (Config->GetFlipFlag() == true)
+                return 'A';
+              return 'C';
       break;;
       default: return 'Z';
       break;;
@@ -121,17 +342,21 @@ char TouchBar::PadEvent ()
     return 'Z';
 }
 
-unsigned int TouchBar::GetPositionInt ()
+TouchBarPosition TouchBar::GetPositionInt ()
 {
+#ifdef TouchBarRampProfiles
+  if (ProfileRamping ())
+    return RampPosition (Common->Clock ());
+#endif
   return Current;
 }
 
 float TouchBar::GetPositionFloat ()
 {
-  return float(Current) / 100;
+  return float(GetPositionInt ()) / 100;
 }
 
-unsigned int TouchBar::GetTargetInt ()
+TouchBarPosition TouchBar::GetTargetInt ()
 {
   return Target;
 }
@@ -146,27 +371,49 @@ float TouchBar::GetTargetFloat ()
 /* Execution */
 void TouchBar::Main ()
 {
-  // Swap bits 0 and 2 if necessary
-  if (Config->GetFlipFlag() == true)
+  TouchBarPosition PreviousTarget = Target;
+
+  // Tap detection
+  if (Common->Clock == 0)
   {
-    boolean X = bitRead(ABCPads, 0);
-    bitWrite(ABCPads, 0, bitRead(ABCPads, 2));
-    bitWrite(ABCPads, 2, X);
+    if (ABCPads == 1 || ABCPads == 2 || ABCPads == 4 || ABCPads == 0 && ABCPrevious[0] != 0)
+      TapCounter += 1;
+    else if (ABCPads == 0 && ABCPrevious[0] == 0)
+      TapCounter = 0;
+    else
+      TapCounter = Common->TapTimeout;
   }
-  
-  // Tap detection
-  if (ABCPads == 1 || ABCPads == 2 || ABCPads == 4 || ABCPads == 0 && ABCPrevious[0] != 0)
-    TapCounter += 1;
-  else if (ABCPads == 0 && ABCPrevious[0] == 0)
-    TapCounter = 0;
   else
-    TapCounter = Common->TapTimeout;
+  {
+    // The tap is timed from the update a single pad got touched to the one it got released, so the idle updates in between don't have to do anything.
+    if (ABCPads == 1 || ABCPads == 2 || ABCPads == 4 || ABCPads == 0 && ABCPrevious[0] != 0)
+    {
+      if (ABCPrevious[0] == 0)
+        TapStart = Now;
+      else if (Now - TapStart >= Common->TapTime)
+        TapCounter = 1;
+    }
+    else if (ABCPads == 0 && ABCPrevious[0] == 0)
+      TapCounter = 0;
+    else
+      TapCounter = 1;
+  }
 
   Previous = Current; // This must be before the snap, otherwise snapping works, but does not report the event.
+  char Pad = PadEvent (); // Once, the snap, the instrumentation and Publish() all need it.
+
+#ifdef TouchBarInstrumentation
+  if (Pad != 'Z')
+    Counters.Taps[Pad - 'A'] += 1;
+  else if (ABCPads == 0 && (ABCPrevious[0] == 1 || ABCPrevious[0] == 2 || ABCPrevious[0] == 4))
+    Counters.TapsTimedOut += 1;
+  if (Pad != 'Z' && Config->GetSnapFlag() == true)
+    Counters.Snaps += 1;
+#endif
 
   // Snap
-  if (Config->GetSnapFlag() == true && PadEvent() != 'Z')
-    switch (PadEvent())
+  if (Config->GetSnapFlag() == true && Pad != 'Z')
+    switch (Pad)
     {
       case 'A': if (Config->GetRampFlag() == true)
                   Target = 0;
@@ -183,7 +430,94 @@ void TouchBar::Main ()
     }
   
   GetDirection (); // Caluclate direction
-  AdjustOutput (); // React...
+#ifdef TouchBarInstrumentation
+  if (Direction != Static)
+  {
+    if (Direction == Increment2 || Direction == Decrement2)
+      Counters.Skips += 1;
+    if (ABCPads == 7 || ABCPrevious[0] == 7)
+      Counters.HardDecodes += 1;
+    else
+      Counters.LightDecodes += 1;
+  }
+#endif
+#ifdef TouchBarSwipeSpeed
+  TouchBarPosition Step = Swipe (); // Step size, or more steps at once if it's coasting (see TouchBarSwipe.cpp)
+#else
+  TouchBarPosition Step = Config->Resolution;
+#endif
+#ifdef TouchBarAnalog
+  if (Analog)
+    Step = 0; // The finger is followed more finely then that, see AnalogStep().
+#endif
+  AdjustOutput (Step); // React...
+#ifdef TouchBarAnalog
+  if (Analog)
+    AnalogStep ();
+#endif
+
+#ifdef TouchBarGestures
+  if (Config->Gestures != 0)
+    Recognize ();
+  else
+  {
+    GestureState = 0; // Reconfigure()d half way through one
+    Gesture = NoGesture;
+  }
+#endif
+
+  if (Events != 0 || Callback != 0)
+    Publish (PreviousTarget, Pad);
+
+  // Pads untouched and settled, nothing left to report or ramp. Another update with no pads touched would only keep it that way, so until something changes Update() returns straight away.
+  // (Only the RampCounter stops counting meanwhile, so the first ramp step after that comes within RampDelay updates, just like it did before.)
+  Steady = Raw == 0 && ABCPads == 0 && ABCPrevious[0] == 0 && Current == Previous && (Config->GetRampFlag() == false || Current == Target);
+#ifdef TouchBarSwipeSpeed
+  if (FlingVelocity != 0)
+    Steady = false; // Coasting
+#endif
+#ifdef TouchBarGestures
+  if (GestureState != 0 || Gesture != NoGesture)
+    Steady = false; // Waiting for the time of a gesture to run out, or one to report
+#endif
+}
+
+void TouchBar::Publish (TouchBarPosition PreviousTarget, char Pad) // Reports whatever happened in this update, to the event ring and/or the callback.
+{
+  unsigned long Time;
+  if (Common->Clock != 0)
+    Time = Now;
+  else
+    Time = micros ();
+
+  if (Pad != 'Z')
+    Notify (Time, TapEvent, Pad);
+#ifdef TouchBarGestures
+  if (Gesture != NoGesture)
+    Notify (Time, GestureEvent, Gesture << 8 | GestureFound);
+#endif
+  if (Direction != Static)
+    Notify (Time, StepEvent, Direction);
+  if (Target != PreviousTarget)
+    Notify (Time, TargetEvent, Target);
+  if (Current != Previous)
+  {
+    Notify (Time, PositionEvent, Current);
+    // Only on the way in, sitting at the limit (or pushing against it) doesn't change the position, so it's not reported again.
+    if ((Current == 0 || Current == Config->Limit) && Config->GetRollOverFlag() == false)
+      Notify (Time, LimitEvent, Current);
+  }
+}
+
+void TouchBar::Notify (unsigned long Time, byte Type, TouchBarPosition Value)
+{
+  if (Events != 0)
+    Events->Push (this, Time, Type, Value);
+  if (Callback != 0)
+  {
+    TouchBarEvent Event = {this, Time, Value, Type};
+    Callback (&Event, CallbackContext);
+  }
 }
 
 void TouchBar::GetDirection ()
@@ -198,273 +532,88 @@ void TouchBar::GetDirection ()
   }
   else
   {
-    /*
-    Signals in commenTB (for humans):
-    - T - Touched (Rising edge)
-    - H - Held (High)
-    - R - Released (Falling edge)
-    - LU - Left Untouched (Low)
-    */
-    Direction = Static;
-    
-    // The following does the same as the commented section above, except it compiles to 76-94 bytes less (depending on which Update method is used.).
-    // Light touch scenario (only touching 1-2 pads at a time.)
-    // Update: The condition for skipping a state change was added as an afterthought, which sped up the input significantly, but it can't be optimized the way it was before.
-    // Increment case 1/6
-    if (ABCPads == 3)
-    {
-      if (ABCPrevious[0] == 1) // Normal (A=H, B=T, C=LU)
-        Direction = Increment;
-      if (ABCPrevious[0] == 5) // Skiping (A=H, B=T, C=R)
-        Direction = Increment2;
-    }
-    // Increment case 2/6
-    if (ABCPads == 2)
-    {
-      if (ABCPrevious[0] == 3) // Normal (A=R, B=H, C=LU)
-        Direction = Increment;
-      if (ABCPrevious[0] == 1) // Skiping (A=R, B=T, C=LU)
-        Direction = Increment2;
-    }
-    // Increment case 3/6
-    if (ABCPads == 6)
-    {
-      if (ABCPrevious[0] == 2) // Normal (A=LU, B=H, C=T)
-        Direction = Increment;
-      if (ABCPrevious[0] == 3) // Skiping (A=R, B=H, C=T)
-        Direction = Increment2;
-    }
-    // Increment case 4/6
-    if (ABCPads == 4)
-    {
-      if (ABCPrevious[0] == 6) // Normal (A=LU, B=R, C=H)
-        Direction = Increment;
-      if (ABCPrevious[0] == 2) // Skiping (A=LU, B=R, C=T)
-        Direction = Increment2;
-    }
-    // Increment case 5/6
-    if (ABCPads == 5)
-    {
-      if (ABCPrevious[0] == 4) // Normal (A=T, B=LU, C=H)
-        Direction = Increment;
-      if (ABCPrevious[0] == 6) // Skiping (A=T, B=R, C=H)
-        Direction = Increment2;
-    }
-    // Increment case 6/6
-    if (ABCPads == 1)
-    {
-      if (ABCPrevious[0] == 5) // Normal (A=H, B=LU, C=R)
-        Direction = Increment;
-      if (ABCPrevious[0] == 4) // Skiping (A=T, B=LU, C=R)
-        Direction = Increment2;
-    }
+    // The direction only depends on the current and the last 3 states of the pads, 3 bits each, so it's looked up from a table rather then worked out with a chain of conditions each time.
+    // The table is generated (and checked against the original conditions for every possible history) by extras/DirectionTableGen, the conditions with all the comments live there as well.
+    Direction = pgm_read_byte (&TouchBarDirectionTable[ABCPrevious[2] << 9 | ABCPrevious[1] << 6 | ABCPrevious[0] << 3 | ABCPads]);
 
-    // Decrement case 1/6
-    if (ABCPads == 5)
-    {
-      if (ABCPrevious[0] == 1) // Normal (A=H, B=LU, C=T)
-        Direction = Decrement;
-      if (ABCPrevious[0] == 3) // Skiping (A=H, B=R, C=T)
-        Direction = Decrement2;
-    }
-    // Decrement case 2/6
-    if (ABCPads == 4)
-    {
-      if (ABCPrevious[0] == 5) // Normal (A=R, B=LU, C=H)
-        Direction = Decrement;
-      if (ABCPrevious[0] == 1) // Skiping (A=R, B=LU, C=T)
-        Direction = Decrement2;
-    }
-    // Decrement case 3/6
-    if (ABCPads == 6)
-    {
-      if (ABCPrevious[0] == 4) // Normal (A=LU, B=T, C=H)
-        Direction = Decrement;
-      if (ABCPrevious[0] == 5) // Skiping (A=R, B=T, C=H)
-        Direction = Decrement2;
-    }
-    // Decrement case 4/6
-    if (ABCPads == 2)
-    {
-      if (ABCPrevious[0] == 6) // Normal (A=LU, B=H, C=R)
-        Direction = Decrement;
-      if (ABCPrevious[0] == 4) // Skiping (A=LU, B=T, C=R)
-        Direction = Decrement2;
-    }
-    // Decrement case 5/6
-    if (ABCPads == 3)
-    {
-      if (ABCPrevious[0] == 2) // Normal (A=T, B=H, C=LU)
-        Direction = Decrement;
-      if (ABCPrevious[0] == 6) // Skiping (A=T, B=H, C=R)
-        Direction = Decrement2;
-    }
-    // Decrement case 6/6
-    if (ABCPads == 1)
-    {
-      if (ABCPrevious[0] == 3) // Normal (A=H, B=R, C=LU)
-        Direction = Decrement;
-      if (ABCPrevious[0] == 2) // Skiping (A=T, B=R, C=LU)
-        Direction = Decrement2;
-    }
-    
-    /*
-    // Update: The condition for skipping can only be implemented for light touch, as the twitch suppression would filter out fast change on the same pin anyway, so it would not make sense.
-    // (It is hard to drag your finger so fast that if would skipp state change when you're pushing it hard on the surface, so it has very limited usefulness anyway.)
-    
-    // This commented section works as the next optimized section, however it's kept cause it may be more understandable for beginners. ...and me. :P I don't wanna stare at it and wonder how the hack did I do it in some time... ;)
-    
-    // Hard touch scenario (touching 2-3 pads at a time.) Rrequires checking the 2nd and 3rd previous status(which together shows second previous event) to determine the direction.
-    // Previous event won't do cause the cases for forward and backward are all the same, only determined by the the previously active pad, and each pat is first released and then touched again while the other 2 are held, so we need to go back 1 event further with the checks.
-    // Case 1/6 (A=H, B=H, C=T)
-    if (ABCPads == 7 && ABCPrevious[0] == 3)
-    {
-      if (ABCPrevious[1] == 7 && ABCPrevious[2] == 5 || ABCPrevious[1] == 1 && ABCPrevious[2] == 0) // Increment (2nd previous event B=T || B=LU)
-        Direction = Increment;
-      if (ABCPrevious[1] == 7 && ABCPrevious[2] == 6 || ABCPrevious[1] == 2 && ABCPrevious[2] == 0) // Decrement (2nd previous event A=T || A=LU)
-        Direction = Decrement;
-    }
-    // Case 2/6 (A=R, B=H, C=H)
-    if (ABCPads == 6 && ABCPrevious[0] == 7)
-    {
-      if (ABCPrevious[1] == 3 && ABCPrevious[2] == 7 || ABCPrevious[1] == 3 && ABCPrevious[2] == 1) // Increment (2nd previous event B=T || B=LU)
-        Direction = Increment;
-      if (ABCPrevious[1] == 5 && ABCPrevious[2] == 7 || ABCPrevious[1] == 5 && ABCPrevious[2] == 1) // Decrement (2nd previous event A=T || A=LU)
-        Direction = Decrement;
-    }
-    // Case 3/6 (A=T, B=H, C=H)
-    if (ABCPads == 7 && ABCPrevious[0] == 6)
-    {
-      if (ABCPrevious[1] == 7 && ABCPrevious[2] == 3 || ABCPrevious[1] == 2 && ABCPrevious[2] == 0) // Increment (2nd previous event B=T || B=LU)
-        Direction = Increment;
-      if (ABCPrevious[1] == 7 && ABCPrevious[2] == 5 || ABCPrevious[1] == 4 && ABCPrevious[2] == 0) // Decrement (2nd previous event A=T || A=LU)
-        Direction = Decrement;
-    }
-    // Case 4/6 (A=H, B=R, C=H)
-    if (ABCPads == 5 && ABCPrevious[0] == 7)
-    {
-      if (ABCPrevious[1] == 6 && ABCPrevious[2] == 7 || ABCPrevious[1] == 6 && ABCPrevious[2] == 2) // Increment (2nd previous event B=T || B=LU)
-        Direction = Increment;
-      if (ABCPrevious[1] == 3 && ABCPrevious[2] == 7 || ABCPrevious[1] == 3 && ABCPrevious[2] == 2) // Decrement (2nd previous event A=T || A=LU)
-        Direction = Decrement;
-    }
-    // Case 5/6 (A=H, B=T, C=H)
-    if (ABCPads == 7 && ABCPrevious[0] == 5)
-    {
-      if (ABCPrevious[1] == 7 && ABCPrevious[2] == 6 || ABCPrevious[1] == 4 && ABCPrevious[2] == 0) // Increment (2nd previous event B=T || B=LU)
-        Direction = Increment;
-      if (ABCPrevious[1] == 7 && ABCPrevious[2] == 3 || ABCPrevious[1] == 1 && ABCPrevious[2] == 0) // Decrement (2nd previous event A=T || A=LU)
-        Direction = Decrement;
-    }
-    // Case 6/6 (A=H, B=H, C=R)
-    if (ABCPads == 3 && ABCPrevious[0] == 7)
-    {
-      if (ABCPrevious[1] == 5 && ABCPrevious[2] == 7 || ABCPrevious[1] == 5 && ABCPrevious[2] == 4) // Increment (2nd previous event B=T || B=LU)
-        Direction = Increment;
-      if (ABCPrevious[1] == 6 && ABCPrevious[2] == 7 || ABCPrevious[1] == 6 && ABCPrevious[2] == 4) // Decrement (2nd previous event A=T || A=LU)
-        Direction = Decrement;
-    }
-    */
-    
-    // Hard touch scenario (touching 2-3 pads at a time.) Rrequires checking the 2nd and 3rd previous status(which together shows second previous event) to determine the direction.
-    // Previous event won't do cause the cases for forward and backward are all the same, only determined by the the previously active pad, and each pat is first released and then touched again while the other 2 are held, so we need to go back 1 event further with the checks.
-    // Case 1/6 (A=H, B=H, C=T)
-    if (!(ABCPads ^ 7 | ABCPrevious[0] ^ 3))
-    {
-      if (!(ABCPrevious[1] ^ 7 | ABCPrevious[2] ^ 5) || !(ABCPrevious[1] ^ 1 | ABCPrevious[2] ^ 0)) // Increment (2nd previous event B=T || B=LU)
-        Direction = Increment;
-      if (!(ABCPrevious[1] ^ 7 | ABCPrevious[2] ^ 6) || !(ABCPrevious[1] ^ 2 | ABCPrevious[2] ^ 0)) // Decrement (2nd previous event A=T || A=LU)
-        Direction = Decrement;
-    }
-    // Case 2/6 (A=R, B=H, C=H)
-    if (!(ABCPads ^ 6 | ABCPrevious[0] ^ 7))
-    {
-      if (!(ABCPrevious[1] ^ 3 | ABCPrevious[2] ^ 7) || !(ABCPrevious[1] ^ 3 | ABCPrevious[2] ^ 1)) // Increment (2nd previous event B=T || B=LU)
-        Direction = Increment;
-      if (!(ABCPrevious[1] ^ 5 | ABCPrevious[2] ^ 7) || !(ABCPrevious[1] ^ 5 | ABCPrevious[2] ^ 1)) // Decrement (2nd previous event A=T || A=LU)
-        Direction = Decrement;
-    }
-    // Case 3/6 (A=T, B=H, C=H)
-    if (!(ABCPads ^ 7 | ABCPrevious[0] ^ 6))
-    {
-      if (!(ABCPrevious[1] ^ 7 | ABCPrevious[2] ^ 3) || !(ABCPrevious[1] ^ 2 | ABCPrevious[2] ^ 0)) // Increment (2nd previous event B=T || B=LU)
-        Direction = Increment;
-      if (!(ABCPrevious[1] ^ 7 | ABCPrevious[2] ^ 5) || !(ABCPrevious[1] ^ 4 | ABCPrevious[2] ^ 0)) // Decrement (2nd previous event A=T || A=LU)
-        Direction = Decrement;
-    }
-    // Case 4/6 (A=H, B=R, C=H)
-    if (!(ABCPads ^ 5 | ABCPrevious[0] ^ 7))
-    {
-      if (!(ABCPrevious[1] ^ 6 | ABCPrevious[2] ^ 7) || !(ABCPrevious[1] ^ 6 | ABCPrevious[2] ^ 2)) // Increment (2nd previous event B=T || B=LU)
-        Direction = Increment;
-      if (!(ABCPrevious[1] ^ 3 | ABCPrevious[2] ^ 7) || !(ABCPrevious[1] ^ 3 | ABCPrevious[2] ^ 2)) // Decrement (2nd previous event A=T || A=LU)
-        Direction = Decrement;
-    }
-    // Case 5/6 (A=H, B=T, C=H)
-    if (!(ABCPads ^ 7 | ABCPrevious[0] ^ 5))
-    {
-      if (!(ABCPrevious[1] ^ 7 | ABCPrevious[2] ^ 6) || !(ABCPrevious[1] ^ 4 | ABCPrevious[2] ^ 0)) // Increment (2nd previous event B=T || B=LU)
-        Direction = Increment;
-      if (!(ABCPrevious[1] ^ 7 | ABCPrevious[2] ^ 3) || !(ABCPrevious[1] ^ 1 | ABCPrevious[2] ^ 0)) // Decrement (2nd previous event A=T || A=LU)
-        Direction = Decrement;
-    }
-    // Case 6/6 (A=H, B=H, C=R)
-    if (!(ABCPads ^ 3 | ABCPrevious[0] ^ 7))
-    {
-      if (!(ABCPrevious[1] ^ 5 | ABCPrevious[2] ^ 7) || !(ABCPrevious[1] ^ 5 | ABCPrevious[2] ^ 4)) // Increment (2nd previous event B=T || B=LU)
-        Direction = Increment;
-      if (!(ABCPrevious[1] ^ 6 | ABCPrevious[2] ^ 7) || !(ABCPrevious[1] ^ 6 | ABCPrevious[2] ^ 4)) // Decrement (2nd previous event A=T || A=LU)
-        Direction = Decrement;
-    }
+    // Swapping pads A and C turns every direction around, so with the Flip flag set the result is mirrored instead of swapping the pads. (~Increment == Decrement, ~Increment2 == Decrement2)
+    if (Config->GetFlipFlag() == true && Direction != Static)
+      Direction = ~Direction;
   }
 }
 
-void TouchBar::AdjustOutput ()
+void TouchBar::Ramp (TouchBarPosition Step) // Moves Current towards Target by Step.
 {
+#ifdef TouchBarInstrumentation
+  if (Current != Target)
+    Counters.RampSteps += 1;
+#endif
+  // Comparing the distance rather then Target - Step or Target + Step, those could wrap around when Step is bigger then Target or near the top of TouchBarPosition, and Current would overshoot.
+  if (Current < Target)
+    if (Target - Current > Step)
+      Current += Step;
+    else
+      Current = Target;
+
+  if (Current > Target)
+    if (Current - Target > Step)
+      Current -= Step;
+    else
+      Current = Target;
+}
+
+void TouchBar::AdjustOutput (TouchBarPosition Step)
+{
+  // Increment2 / Decrement2 are 2 steps, each one clamped (or rolled over) on its own, so Step * 2 can't overflow and can't overshoot the Limit either.
   if (Config->GetRampFlag() == true)
   {
     if (Direction > Static)
     {
-      if (Target < Config->Limit - Config->Resolution && Direction == Increment)
-        Target += Config->Resolution;
-      else
-      {
-        if (Target < Config->Limit - Config->Resolution && Direction == Increment2)
-          Target += Config->Resolution * 2;
-        else
-          Target = Config->Limit;
-      }
+      Target = TouchBarUp (Target, Step, Config->Limit);
+      if (Direction == Increment2)
+        Target = TouchBarUp (Target, Step, Config->Limit);
     }
     if (Direction < Static)
     {
-      if (Target >= Config->Resolution && Direction == Decrement)
-        Target -= Config->Resolution;
-      else
-      {
-        if (Target >= Config->Resolution && Direction == Decrement2)
-          Target -= Config->Resolution * 2;
-        else
-          Target = 0;
-      }
+      Target = TouchBarDown (Target, Step);
+      if (Direction == Decrement2)
+        Target = TouchBarDown (Target, Step);
     }
 
-    if (RampCounter == Config->RampDelay - 1)
+    if (Common->Clock == 0)
     {
-      if (Current < Target)
-        if (Current < Target - Config->RampResolution)
-          Current += Config->RampResolution;
-        else
-          Current = Target;
-
-      if (Current > Target)
-        if (Current > Target + Config->RampResolution)
-          Current -= Config->RampResolution;
-        else
-          Current = Target;
-    }
+      if (RampCounter == Config->RampDelay - 1)
+        Ramp (Config->RampResolution);
 
-    RampCounter += 1;
-    RampCounter %= Config->RampDelay;
+      RampCounter += 1;
+      RampCounter %= Config->RampDelay;
+    }
+#ifdef TouchBarRampProfiles
+    else if (Config->RampProfile != SteppedRamp)
+      ProfileRamp ();
+#endif
+    else
+    {
+      // RampCounter isn't counting anything in wall-clock mode, it's 1 while ramping. The ramp starts from the first update that sees Target moved away, however long ago the last update was.
+      if (Current == Target)
+        RampCounter = 0;
+      else if (RampCounter == 0)
+      {
+        RampCounter = 1;
+        RampStart = Now;
+      }
+      else if (Config->RampTime == 0)
+        Current = Target;
+      else if (Now - RampStart >= Config->RampTime)
+      {
+        // Take as many steps as fit in the time since the last one, so the rate doesn't depend on how often Update() is called.
+        unsigned long Steps = (Now - RampStart) / Config->RampTime;
+        RampStart += Steps * Config->RampTime;
+        if (Steps > TouchBarMaxPosition / Config->RampResolution)
+          Steps = TouchBarMaxPosition / Config->RampResolution;
+        Ramp (Steps * Config->RampResolution);
+      }
+    }
   }
   else
   {
@@ -472,53 +621,30 @@ void TouchBar::AdjustOutput ()
     {
       if (Config->GetRollOverFlag() == true)
       {
-        if (Direction == Increment)
-          Current += Config->Resolution;
+        Current = TouchBarAround (Current, Step, Config->Limit, true);
         if (Direction == Increment2)
-          Current += Config->Resolution * 2;
-        Current %= Config->Limit;
+          Current = TouchBarAround (Current, Step, Config->Limit, true);
       }
       else
       {
-        if (Current < Config->Limit - Config->Resolution && Direction == Increment)
-          Current += Config->Resolution;
-        else
-        {
-          if (Current < Config->Limit - Config->Resolution * 2 && Direction == Increment2)
-            Current += Config->Resolution * 2;
-          else
-            Current = Config->Limit;
-        }
+        Current = TouchBarUp (Current, Step, Config->Limit);
+        if (Direction == Increment2)
+          Current = TouchBarUp (Current, Step, Config->Limit);
       }
     }
     if (Direction < Static)
     {
       if (Config->GetRollOverFlag() == true)
       {
-        byte X = 0;
-        if (Direction == Decrement)
-          X = Config->Resolution;
+        Current = TouchBarAround (Current, Step, Config->Limit, false);
         if (Direction == Decrement2)
-          X = Config->Resolution * 2;
-        if (Current - X >= Config->Limit)
-        {
-          X -= Current;
-          Current = Config->Limit - X;
-        }
-        else
-          Current -= X;
+          Current = TouchBarAround (Current, Step, Config->Limit, false);
       }
       else
       {
-        if (Current >= Config->Resolution && Direction == Decrement)
-          Current -= Config->Resolution;
-        else
-        {
-          if (Current >= Config->Resolution * 2 && Direction == Decrement2)
-            Current -= Config->Resolution * 2;
-          else
-            Current = 0;
-        }
+        Current = TouchBarDown (Current, Step);
+        if (Direction == Decrement2)
+          Current = TouchBarDown (Current, Step);
       }
     }
   }
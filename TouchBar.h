@@ -1,7 +1,55 @@
 #ifndef TouchBar_H
 #define TouchBar_H
 
-#include <Arduino.h>
+#ifdef ARDUINO
+  #include <Arduino.h>
+#else
+  #include "TouchBarHost.h" // Host build (simulation, profiling, regression runs)
+#endif
+
+// Instrumentation: uncomment this to have every TouchBar object count what it's doing (see TouchBarCounters and GetCounters()). Costs RAM (76 bytes per object on AVR) and a little time, left out completely otherwise.
+//#define TouchBarInstrumentation
+
+#ifdef TouchBarInstrumentation
+  #if defined(ESP8266) || defined(ESP32)
+    #define TouchBarCost() ESP.getCycleCount() // CPU cycles
+  #elif defined(ARDUINO)
+    #define TouchBarCost() micros() // us (4 us steps on a 16MHz AVR)
+  #else
+    #define TouchBarCost() HostCost() // ns (HostNanos(), see TouchBarHost.h)
+  #endif
+#endif
+
+// Wide positions: uncomment this for 32 bit positions (Default, Limit, position and target up to 4294967294) and 16 bit steps (Resolution, RampResolution up to 65535), for jog wheels and positioning axes that need more then 65535.
+// Costs RAM (10 more bytes per TouchBar object and 6 per config object on AVR) and time (32 bit math on an 8 bit CPU), left out completely otherwise. TouchBarFixed stays 16 bit either way.
+//#define TouchBarWide
+
+#ifdef TouchBarWide
+  typedef uint32_t TouchBarPosition;
+  typedef uint16_t TouchBarStep;
+  #define TouchBarMaxPosition 0xFFFFFFFFUL // Limit must be below it
+  #define TouchBarMaxStep 0xFFFF
+  #define TouchBarPositionBytes 4 // In the EEPROM records, snapshots and link frames
+  #define TouchBarStepBytes 2
+#else
+  typedef unsigned int TouchBarPosition;
+  typedef byte TouchBarStep;
+  #define TouchBarMaxPosition 0xFFFF
+  #define TouchBarMaxStep 0xFF
+  #define TouchBarPositionBytes 2
+  #define TouchBarStepBytes 1
+#endif
+
+// Optional features: what each of these keeps track of takes RAM in every TouchBar object, so it's only compiled in when you uncomment its line (the bytes are per object on AVR).
+// Their settings stay in TouchBarCommon / TouchBarConfig either way, so EEPROM records, TouchBarStore and TouchBarLink don't change, the settings are just ignored without the line.
+//#define TouchBarRampProfiles // TouchBarConfig::RampProfile other then SteppedRamp, see TouchBarRamp.cpp. 8 bytes (12 with TouchBarWide).
+//#define TouchBarSwipeSpeed // Acceleration, fling and GetVelocity(), see TouchBarSwipe.cpp. 16 bytes.
+//#define TouchBarDebouncer // The per-pad debouncer (TouchBarCommon::DebounceDelay), see TouchBar::Debounce(). DebounceBits bytes (8).
+//#define TouchBarAnalog // SetAnalog() and UpdateAnalog() of TouchBar and TouchBarLinear, see TouchBarAnalog.cpp. 16 bytes (14 per TouchBarLinear).
+//#define TouchBarGestures // The gesture recognizer (TouchBarConfig::Gestures, GetGesture(), GestureEvent), see TouchBarGesture.cpp. 8 bytes.
+
+// Per-pad debouncer (TouchBarCommon::DebounceDelay, with TouchBarDebouncer): bits of its counters, DebounceDelay can go up to 2^DebounceBits - 1 samples. Each bit takes a byte of RAM per TouchBar object.
+#define DebounceBits 8
 
 #define Decrement2 0
 #define Decrement 63
@@ -9,11 +57,99 @@
 #define Increment 192
 #define Increment2 255
 
+// Ramp profiles (TouchBarConfig::RampProfile)
+#define SteppedRamp 0 // RampResolution every RampDelay updates (or every RampTime us with a Clock), the way it always worked.
+#define LinearRamp 1 // The rest need a Clock and TouchBarRampProfiles (taken as SteppedRamp without it). Constant speed of RampResolution per RampTime.
+#define TrapezoidRamp 2 // Speeds up over the first quarter of the ramp and slows down over the last, top speed is RampResolution per RampTime.
+#define SCurveRamp 3 // Speeds up and slows down smoothly (no sudden change in speed at all), top speed is RampResolution per RampTime.
+
+// NextDeadline(): nothing to do until a pad changes
+#define NoDeadline 0xFFFFFFFF
+
+// Event types (TouchBarEvent::Type)
+#define TapEvent 1 // Value: 'A', 'B' or 'C' (same as PadEvent())
+#define PositionEvent 2 // Value: new position
+#define TargetEvent 3 // Value: new target
+#define StepEvent 4 // Value: direction (Decrement2, Decrement, Increment or Increment2)
+#define LimitEvent 5 // Value: 0 or Limit, when the position gets there (not with RollOver)
+#define GestureEvent 6 // Value: gesture << 8 | pads (see below)
+
+// Gestures (GetGesture(), TouchBarConfig::Gestures takes 1 << each of these, with TouchBarGestures) See TouchBarGesture.cpp
+#define NoGesture 0
+#define SingleTapGesture 1 // A tap with no other one after it within MultiTapTime. (PadEvent() reports it straight away, without waiting.)
+#define DoubleTapGesture 2 // 2 taps on the same pad.
+#define TripleTapGesture 3 // 3 taps on the same pad.
+#define LongPressGesture 4 // A single pad held for LongPressTime and let go without moving.
+#define PressSwipeGesture 5 // A single pad held for LongPressTime, then swiped. Reported when it starts moving, the swipe goes on as usual.
+#define ChordGesture 6 // 2 pads touched at once (2 fingers, or one across the gap) and let go without moving.
+
+// TouchBarLink frames (see TouchBarLink.cpp)
+#define LinkSync 0xA5 // First byte of every frame
+#define LinkVersion 1
+#define LinkMaxPayload (12 + 2 * TouchBarPositionBytes) // 16, or 20 with TouchBarWide
+#define LinkState 'S' // Board -> host: Fields (1), Time (4), then the fields set in Fields: Position (2, 4 with LinkWide), Target (2, 4 with LinkWide), Tap (1), Gesture (2), Counters (4: frames skipped, bad frames received)
+#define LinkValue 'V' // Board -> host: Config (1), Field (1), Value (4), sequence of the command (1). The answer to LinkRead and LinkWrite.
+#define LinkError 'E' // Board -> host: Config (1), Field (1), Error (1), sequence of the command (1)
+#define LinkInfo 'I' // Board -> host: LinkVersion (1), ConfigCount (1), Interval (4). The answer to LinkHello.
+#define LinkRead 'R' // Host -> board: Config (1, LinkCommon for the Common object), Field (1)
+#define LinkWrite 'W' // Host -> board: Config (1), Field (1), Value (4)
+#define LinkHello 'H' // Host -> board: nothing
+#define LinkCommon 0xFF // Config number of the Common object, and the id every link answers to
+// LinkState fields
+#define LinkPosition 0x01
+#define LinkTarget 0x02
+#define LinkTap 0x04
+#define LinkGesture 0x08
+#define LinkCounters 0x10
+#define LinkWide 0x20 // Not a field: Position and Target are 4 bytes (TouchBarWide), 2 otherwise
+// LinkError errors
+#define LinkNoConfig 1
+#define LinkNoField 2
+#define LinkOutOfRange 3
+#define LinkNoCommand 4
+// Field numbers: Common
+#define LinkTapTimeout 0
+#define LinkTwitchSuppressionDelay 1
+#define LinkTapTime 2
+#define LinkTwitchSuppressionTime 3
+#define LinkDebounceDelay 4
+// Field numbers: Config
+#define LinkDefault 0
+#define LinkLimit 1
+#define LinkResolution 2
+#define LinkRampDelay 3
+#define LinkRampResolution 4
+#define LinkFlags 5 // RollOver bit 7, SpringBack 6, Snap 5, Ramp 4, Flip 3 (same as TouchBarStore)
+#define LinkRampTime 6
+#define LinkRampProfile 7
+#define LinkAccelerationSpeed 8
+#define LinkAccelerationLimit 9
+#define LinkFlingTime 10
+#define LinkFlingSpeed 11
+#define LinkGestures 12
+#define LinkMultiTapTime 13
+#define LinkLongPressTime 14
+
+extern const byte TouchBarDirectionTable[4096] PROGMEM; // Direction for every pad history, see TouchBarDirectionTable.cpp
+
+// Response curves for TouchBarMap (see TouchBarMap.cpp), or make your own: TouchBarCurvePoints (or any other number of) values from 0 to 65535 in PROGMEM.
+#define TouchBarCurvePoints 33
+extern const uint16_t TouchBarLogCurve[TouchBarCurvePoints] PROGMEM; // Rises fast, then levels off.
+extern const uint16_t TouchBarExpCurve[TouchBarCurvePoints] PROGMEM; // Starts slow, then rises fast. (Audio taper, for volume.)
+extern const uint16_t TouchBarGammaCurve[TouchBarCurvePoints] PROGMEM; // Gamma 2.2, for LED brightness.
+extern const uint16_t TouchBarSCurve[TouchBarCurvePoints] PROGMEM; // Slow at both ends.
+
 class TouchBarCommon // These depend on execution speed and should be the same for each touchbar instance, although may require some tuning...
 {
   public:
   unsigned int TapTimeout; // This controls how fast is a tap on any one of the 3 pads. The lower the number, the faster you should tap.
   byte TwitchSuppressionDelay;
+  // Optional wall-clock timing. Leave these out of the initializer and everything is counted in Update() calls as before.
+  unsigned long (*Clock) (); // Set it to micros (or anything else that returns the time in us) and TapTime, TwitchSuppressionTime and RampTime are used instead of the cycle counts, so it doesn't matter how often Update() is called.
+  unsigned long TapTime; // us, replaces TapTimeout when Clock is set.
+  unsigned long TwitchSuppressionTime; // us, replaces TwitchSuppressionDelay when Clock is set. (No 255 limit here.)
+  // Optional per-pad debouncer (only with TouchBarDebouncer defined), leave it out of the initializer (0) for the twitch suppression above.
+  unsigned int DebounceDelay; // Samples (Update() calls, with or without a Clock) a pad has to stay touched or released before it counts, each pad on its own. 1 to 2^DebounceBits - 1. Replaces TwitchSuppressionDelay / TwitchSuppressionTime.
 }; // <<< ; at the end is important!!!
 
 class TouchBarConfig // These are settings specific to a touch bar instance and/or mode of operation...
@@ -27,11 +163,22 @@ class TouchBarConfig // These are settings specific to a touch bar instance and/
     // Flags are easy to mess up, therefore they are configured with methods.
 
   public:
-    unsigned int Default; // Valid range: 0 to Limit
-    unsigned int Limit; // Valid range: Limit > 3 && Limit < 65535 && Limit > Resolution && Limit > RampResolution
-    byte Resolution; // Valid range: Resolution > 0 && Resolution < Limit
+    TouchBarPosition Default; // Valid range: 0 to Limit
+    TouchBarPosition Limit; // Valid range: Limit > 3 && Limit < TouchBarMaxPosition (65535, or 4294967295 with TouchBarWide) && Limit > Resolution && Limit > RampResolution
+    TouchBarStep Resolution; // Valid range: Resolution > 0 && Resolution < Limit (and up to 255, or 65535 with TouchBarWide)
     byte RampDelay; // This depends on execution speed as well. It's defined in cycles of executon not ms or us... Valid range: 0 to 255
-    byte RampResolution; // Valid range: RampResolution > 0 && RampResolution < Limit
+    TouchBarStep RampResolution; // Valid range: RampResolution > 0 && RampResolution < Limit (and up to 255, or 65535 with TouchBarWide)
+    unsigned long RampTime = 0; // us between ramp steps, replaces RampDelay when TouchBarCommon::Clock is set. (When Update() is called less often then this it takes more then one step at a time to keep up.)
+    byte RampProfile = SteppedRamp; // Anything else then SteppedRamp only works when TouchBarCommon::Clock is set (and TouchBarRampProfiles is defined), then the position is worked out from the time whenever it's asked for.
+    // Swipe speed (steps per second, Increment2 / Decrement2 count as 2 steps) See TouchBarSwipe.cpp, only used with TouchBarSwipeSpeed defined.
+    unsigned int AccelerationSpeed = 0; // Swiping faster then this the step grows in proportion to the speed (twice as fast, twice the step). 0 turns it off.
+    byte AccelerationLimit = 8; // The step won't grow more then this many times the Resolution.
+    unsigned long FlingTime = 0; // us, lifting the finger mid-swipe it keeps going, slowing down to a stop in this time. (Like momentum scrolling.) 0 turns it off, so does SpringBack.
+    unsigned int FlingSpeed = 20; // It only keeps going if it was faster then this when lifted.
+    // Gestures, see TouchBarGesture.cpp, only used with TouchBarGestures defined.
+    byte Gestures = 0; // Which gestures GetGesture() reports, 1 << SingleTapGesture | 1 << DoubleTapGesture... 0 turns the recognizer off.
+    unsigned long MultiTapTime = 300000; // us, the most between letting go and the next tap of a double or triple tap.
+    unsigned long LongPressTime = 500000; // us, held at least this long it's a long press (or press and swipe), not a tap.
     // Setting everything with methods would also require getting everthing with methods, which would unnecessarily complicate stuff, so it's public and the user should take care to operate it within valid ranges.
 
     /* Constructor(s) */
@@ -48,30 +195,191 @@ class TouchBarConfig // These are settings specific to a touch bar instance and/
     
 }; // <<< ; at the end is important!!!
 
+class TouchBar;
+
+struct TouchBarEvent
+{
+  TouchBar *Source; // The TouchBar object it came from, so several can share a ring.
+  unsigned long Time; // us, from TouchBarCommon::Clock if set, micros() otherwise.
+  TouchBarPosition Value;
+  byte Type;
+}; // <<< ; at the end is important!!!
+
+typedef void (*TouchBarCallback) (const TouchBarEvent *Event, void *Context); // See TouchBar::SetCallback()
+
+struct TouchBarSnapshot // Runtime state of a TouchBar, see TouchBar::Snapshot(). 14 bytes (18 with TouchBarWide) on AVR, small enough for RTC memory.
+{
+  TouchBarPosition Current;
+  TouchBarPosition Target;
+  unsigned int RampCounter;
+  byte Direction;
+  byte ABCPads; // Bits 3-5: raw input, bit 7: Idle()
+  byte ABCPrevious[3];
+  byte TSCounter;
+  byte Generation; // Counts up on every Snapshot() into the same buffer, of two copies the newer one wins.
+  byte Check; // Blank or random memory (RTC memory after a power cycle) doesn't pass this.
+}; // <<< ; at the end is important!!!
+
+#ifdef TouchBarInstrumentation
+struct TouchBarCounters // See TouchBar::GetCounters()
+{
+  unsigned long Updates; // Update() calls that did something (not counting the ones it returned from straight away while Idle())
+  unsigned long Rejected; // Updates whose input was held back by the twitch suppression
+  unsigned long Taps[3]; // PadEvent() taps on pad A, B and C
+  unsigned long TapsTimedOut; // Single pad touches released too late to count as a tap (TapTimeout / TapTime)
+  unsigned long Skips; // Increment2 / Decrement2, a state was missed (fast swipe, or slow Update() calls)
+  unsigned long HardDecodes; // Steps decoded with all 3 pads touched
+  unsigned long LightDecodes; // Steps decoded with 1 or 2 pads touched
+  unsigned long Snaps;
+  unsigned long RampSteps; // Ramp steps taken (ramps started with a RampProfile)
+  unsigned int Cost[16]; // How long Update() took, Cost[0]: 0, Cost[n]: 2^(n-1) to 2^n - 1 (CPU cycles on ESP8266, us on AVR, ns on the host), stops counting at 65535.
+}; // <<< ; at the end is important!!!
+#endif
+
+class TouchBarEventRing // Lock-free queue of events from Update() (the single producer, it may run in a timer interrupt) to loop() (the single consumer). No allocation, the buffer is yours.
+{
+  private:
+    TouchBarEvent *Buffer;
+    byte Size;
+    volatile byte Head = 0; // Only written by the producer
+    volatile byte Tail = 0; // Only written by the consumer
+    volatile unsigned int Overflows = 0; // Only written by the producer
+
+  public:
+    // Constructor
+    TouchBarEventRing (TouchBarEvent *BufferPtr, byte BufferSize); // BufferSize: 2, 4, 8, 16, 32, 64 or 128, anything else is rounded down to one of these (and uses only that many events of the buffer).
+
+    // Producer side (TouchBar::Update() does this for you)
+    boolean Push (TouchBar *Source, unsigned long Time, byte Type, TouchBarPosition Value); // Returns false (and counts an overflow) if the ring is full, the event is dropped.
+
+    // Consumer side
+    boolean Pop (TouchBarEvent *Event); // Returns false if there's nothing to read.
+    byte Available (); // Number of events waiting.
+    unsigned int GetOverflows (); // Number of events dropped because the ring was full.
+}; // <<< ; at the end is important!!!
+
+class TouchBarRecorder // Records the raw pad samples TouchBar::Update() gets, run length encoded, see TouchBarRecorder.cpp. Replay them on a PC with TouchBarTraceReader.
+{
+  private:
+    void (*Output) (byte Data);
+    unsigned long RunStart = 0; // micros() at the first sample of the run
+    unsigned long PreviousStart = 0; // ...and of the one before
+    unsigned int RunLength = 0;
+    byte RunPads = 0;
+    boolean Started = false;
+    unsigned long Bytes = 0;
+    unsigned long Samples = 0;
+
+    void Put (byte Data);
+    void Emit ();
+
+  public:
+    // Constructor
+    TouchBarRecorder (void (*OutputFunction) (byte Data)); // OutputFunction gets the trace byte by byte, it could write them to Serial, to a file on an SD card or into flash.
+
+    // Operation
+    void Record (byte Pads); // TouchBar::Update() calls this for every sample once it's set with SetRecorder(), you can call it yourself as well.
+    void Flush (); // Writes out the run in progress (it's written only when the pads change otherwise), before turning off, for example.
+    unsigned long GetBytes (); // Bytes written so far
+    unsigned long GetSamples (); // Samples recorded so far
+}; // <<< ; at the end is important!!!
+
 class TouchBar
 {
   private:
     // Input/Output variables
     TouchBarCommon *Common;
     TouchBarConfig *Config;
-    unsigned int Current;
-    unsigned int Target;
+    TouchBarEventRing *Events = 0;
+    TouchBarCallback Callback = 0;
+    void *CallbackContext = 0;
+    TouchBarRecorder *Recorder = 0;
+    TouchBarPosition Current;
+    TouchBarPosition Target;
     byte ABCPads = 0;
     // Internal variables
     unsigned int RampCounter = 0;
-    unsigned int Previous;
-    unsigned int TapCounter;
+    TouchBarPosition Previous;
+    unsigned int TapCounter = 0;
     byte ABCPrevious[3] = {0, 0, 0};
     byte Direction = Static;
     byte Raw = 0;
     byte TSCounter = 0;
+#ifdef TouchBarDebouncer
+    byte DebounceCounter[DebounceBits] = {}; // Vertical counters, see Debounce()
+#endif
+    boolean Steady = false; // See Idle()
+#ifdef TouchBarInstrumentation
+    TouchBarCounters Counters = {};
+    void Count (unsigned long Cost);
+#endif
+    // Wall-clock mode only (TouchBarCommon::Clock set)
+    unsigned long Now = 0; // Read once per Update()
+    unsigned long TapStart = 0; // Last time a single pad got touched
+    unsigned long TSStart = 0; // Last time the raw input changed
+    unsigned long RampStart = 0; // Last ramp step, or the start of the ramp with a RampProfile
+#ifdef TouchBarRampProfiles
+    unsigned long RampDuration = 0; // RampProfile only, see TouchBarRamp.cpp
+    TouchBarPosition RampFrom = 0;
+    TouchBarPosition RampTo;
+#endif
+#ifdef TouchBarSwipeSpeed
+    // Swipe speed, see TouchBarSwipe.cpp
+    unsigned long LastStep = 0; // Time of the last step (or touch)
+    unsigned long FlingStart = 0;
+    unsigned long FlingDone = 0; // Steps taken since lifting the finger (Q8)
+    int Velocity = 0; // Steps per second, + for increment
+    int FlingVelocity = 0; // Speed when lifting the finger, 0 when not coasting
+#endif
+#ifdef TouchBarAnalog
+    // Analog input, see TouchBarAnalog.cpp
+    unsigned int Level[3] = {0, 0, 0}; // Smoothed readings of pad A, B and C
+    unsigned int AnalogThreshold = 0;
+    byte AnalogSmoothing = 0;
+    boolean Analog = false; // Set during UpdateAnalog(), the position moves with the finger rather then by Resolution per step
+    int Phase = -1; // Where the finger is along the A, B, C cycle, 256 per pad, -1 when untouched
+    long Fine = 0; // Movement not taken yet, 128 = Resolution
+#endif
+#ifdef TouchBarGestures
+    // Gestures, see TouchBarGesture.cpp
+    byte GestureState = 0;
+    byte GesturePads = 0; // The pads the gesture is on
+    byte Gesture = NoGesture; // Recognized in this update
+    byte GestureFound = 0; // Its pads
+    unsigned long GestureStart = 0; // The state was entered
+#endif
 
     // Private methods
     void Shift ();
     void Main ();
     void GetDirection ();
-    void AdjustOutput ();
+    void AdjustOutput (TouchBarPosition Step);
+#ifdef TouchBarSwipeSpeed
+    TouchBarPosition Swipe ();
+    TouchBarPosition StepSize (unsigned int Speed);
+    unsigned long SwipeTime ();
+    int VelocityAt (unsigned long Time);
+#endif
+    void Ramp (TouchBarPosition Step);
+#ifdef TouchBarRampProfiles
+    boolean ProfileRamping ();
+    void ProfileRamp ();
+    void StartRamp (boolean Moving);
+    TouchBarPosition RampPosition (unsigned long Time);
+#endif
+    void Publish (TouchBarPosition PreviousTarget, char Pad);
+    void Notify (unsigned long Time, byte Type, TouchBarPosition Value);
     void TwitchSuppression (byte NewValue);
+#ifdef TouchBarDebouncer
+    void Debounce (byte NewValue);
+#endif
+#ifdef TouchBarAnalog
+    void AnalogStep ();
+#endif
+#ifdef TouchBarGestures
+    void Recognize ();
+    unsigned long GestureDeadline (unsigned long Time);
+#endif
 
   public:
     // Constructor
@@ -79,23 +387,276 @@ class TouchBar
 
     // Control Methods
     void Reconfigure (TouchBarConfig *ConfigPtr);
+    void SetRecorder (TouchBarRecorder *RecorderPtr); // Every sample Update() gets goes to the recorder as well. Pass 0 to stop.
+    void SetEventRing (TouchBarEventRing *RingPtr); // Update() pushes every tap, position change, target change and direction step into the ring. Pass 0 to stop.
+    void SetCallback (TouchBarCallback Function, void *Context = 0); // Update() calls Function once for every tap, step, position change, target change and limit reached, as it happens, with Context handed back. Pass 0 to stop.
     // Operation
     
     void Update (byte NewValue); // BiTB: 0(LSB) = PadA; 1 = PadB; 2 = PadC; The rest of the bits are ignored.
     void Update (boolean A, boolean B, boolean C); // Another way to do it.
-    void SetPosition (unsigned int NewPosition); // Direct control over the position.
-    void SetTarget (unsigned int NewTarget); // Set target when changing settings temporarily to current position, otherwise it's gonna move immediatly to previously set target when ramp is enabled.
+#ifdef TouchBarAnalog
+    void SetAnalog (unsigned int Threshold, byte Smoothing = 2); // For UpdateAnalog(): a pad counts as touched from Threshold up, each reading is smoothed over about 2^Smoothing updates (0: not at all).
+    void UpdateAnalog (unsigned int A, unsigned int B, unsigned int C); // Takes how much each pad is touched (such as the MPR121 baseline - filtered data) rather then touched or not, the position follows the finger between the pads too.
+#endif
+    void SetPosition (TouchBarPosition NewPosition); // Direct control over the position.
+    void SetTarget (TouchBarPosition NewTarget); // Set target when changing settings temporarily to current position, otherwise it's gonna move immediatly to previously set target when ramp is enabled.
     void Reset (); // Set position or target to default value.
     char PadEvent (); // Returns A, B or C when a single pad was quickly tapped. Returns Z for no event.
     boolean Event (); // Returns true if there's a change.
-    unsigned int GetPositionInt (); // Returns current as int.
+#ifdef TouchBarGestures
+    byte GetGesture (); // Returns the gesture recognized in this update (SingleTapGesture, DoubleTapGesture...), NoGesture most of the time. Only the ones set in TouchBarConfig::Gestures.
+    byte GetGesturePads (); // The pads of that gesture: 1 = A, 2 = B, 4 = C, 3, 5 or 6 for a chord.
+#endif
+    boolean Idle (); // Returns true if the pads are left untouched and nothing is moving. Update() does nothing but return then, as long as no pads are touched, so you can skip calling it altogether.
+    unsigned long NextDeadline (unsigned long Time); // How long (us from Time, what Common->Clock() says now) until Update() has something to do even if no pad changes: a ramp step, the twitch suppression, a fling or a gesture timing out. NoDeadline if nothing, sleep until a pad changes then. See TouchBarDeadline.cpp
+    TouchBarPosition GetPositionInt (); // Returns current as int.
     float GetPositionFloat (); // Return current as float. (Conveniently it returns the position in % with 2 decimal places if limit set to 10000.)
-    unsigned int GetTargetInt (); // Returns current as int.
+    TouchBarPosition GetTargetInt (); // Returns current as int.
     float GetTargetFloat (); // Returns Target as float.
+    void Snapshot (TouchBarSnapshot *State); // Saves position, target, ramp and pad history into State (and counts State->Generation up). Cheap, call it as often as you like.
+    boolean Restore (const TouchBarSnapshot *State); // Carries on from a snapshot (after a reset) instead of starting from Default. Returns false and changes nothing if it doesn't check out or doesn't fit the current Config.
+#ifdef TouchBarInstrumentation
+    const TouchBarCounters *GetCounters (); // Everything counted since the start (or ResetCounters()), to print over Serial, for example.
+    void ResetCounters ();
+#endif
+#ifdef TouchBarSwipeSpeed
+    int GetVelocity (); // Returns the swipe speed in steps per second, positive when incrementing. (Steps, not position units, it's independent of Resolution.)
+#endif
 }; // <<< ; at the end is important!!!
 
+class TouchBarArray // Updates several TouchBar objects from a single touch word, such as the 12 bits Adafruit_MPR121::touched() returns. (The bars share whatever Common and Config objects they were declared with.)
+{
+  private:
+    TouchBar *Bars;
+    const byte *Map;
+    unsigned long Previous = 0;
+    byte Size;
+
+  public:
+    // Constructor
+    TouchBarArray (TouchBar *BarsPtr, byte Count, const byte *ElectrodeMap = 0); // ElectrodeMap: 3 electrode numbers (0-31, the bits of the touch word) per bar, the electrode of pad A, B and C. Leave it out if bar 0 is on electrodes 0-2, bar 1 on 3-5 and so on.
+
+    // Operation
+    void Update (unsigned long Touched); // Up to 32 electrodes, for 2 MPR121s just pass (Touched2 << 12 | Touched1). Bars with unchanged bits are skipped while they're Idle().
+    unsigned long NextDeadline (unsigned long Time); // The soonest NextDeadline() of all the bars.
+}; // <<< ; at the end is important!!!
+
+class TouchBarLinear // A bar of 2 to 16 electrodes side by side, pad 0 at one end and the last pad at the other (rather then the 3 pads of a TouchBar repeating A, B, C along the bar). See TouchBarLinear.cpp
+{
+  private:
+    TouchBarCommon *Common;
+    TouchBarConfig *Config;
+    unsigned int Mask; // One bit per pad
+    byte Count;
+    boolean Absolute = false;
+    // Input/Output variables
+    TouchBarPosition Current;
+    TouchBarPosition Target;
+    unsigned int Pads = 0; // After the twitch suppression
+    // Internal variables
+    TouchBarPosition Previous;
+    unsigned int Raw = 0;
+    unsigned int TapCounter = 0;
+    byte TSCounter = 0;
+    byte RampCounter = 0;
+    byte Spot = 0; // Where the finger is in half pads: 0 = pad 0, 1 = between pad 0 and 1, 2 = pad 1... (mirrored with the Flip flag)
+    byte TapSpot = 0; // Spot of the first touch, a tap has to stay there
+    char Tap = 'Z';
+    boolean Touched = false;
+    boolean Steady = false;
+    // Wall-clock mode only (TouchBarCommon::Clock set)
+    unsigned long Now = 0;
+    unsigned long TapStart = 0;
+    unsigned long TSStart = 0;
+    unsigned long RampStart = 0;
+#ifdef TouchBarAnalog
+    // Analog input, see TouchBarAnalog.cpp
+    unsigned int AnalogThreshold = 0;
+    byte AnalogSmoothing = 0;
+    boolean Analog = false;
+    const unsigned int *Levels = 0; // The readings UpdateAnalog() got
+    long Centroid = -1; // Where the finger is, 256 per pad, -1 when untouched
+    long Fine = 0; // Movement not taken yet, 128 = Resolution
+#endif
+
+    void TwitchSuppression (unsigned int NewValue);
+    byte GetSpot ();
+#ifdef TouchBarAnalog
+    void AnalogStep ();
+#endif
+    void Move (long Amount);
+    void Jump (byte NewSpot);
+    void Ramp ();
+
+  public:
+    // Constructor
+    TouchBarLinear (TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr, byte PadCount);
+
+    // Control Methods
+    void SetAbsolute (boolean AbsoluteFlag); // Touching the bar jumps to the spot touched (and the position follows the finger from there) rather then swiping up and down from where it was.
+    void SetPosition (TouchBarPosition NewPosition);
+    void SetTarget (TouchBarPosition NewTarget);
+    void Reset ();
+
+    // Input / Output
+    void Update (unsigned int Touched); // BiTB: 0(LSB) = pad 0; 1 = pad 1... up to PadCount, the rest of the bits are ignored. Takes Adafruit_MPR121::touched() as it is.
+#ifdef TouchBarAnalog
+    void SetAnalog (unsigned int Threshold, byte Smoothing = 2); // For UpdateAnalog(): a pad counts as touched from Threshold up, the finger's position is smoothed over about 2^Smoothing updates (0: not at all).
+    void UpdateAnalog (const unsigned int *Readings); // Takes how much each pad is touched (PadCount readings, such as the MPR121 baseline - filtered data) rather then touched or not, the position follows the finger between the pads too.
+#endif
+    char PadEvent (); // Returns 'A' for a quick tap on pad 0, 'B' for pad 1... up to 'P' for pad 15. Returns Z for no event.
+    boolean Event (); // Returns true if there's a change.
+    boolean Idle (); // Same as TouchBar::Idle()
+    unsigned long NextDeadline (unsigned long Time); // Same as TouchBar::NextDeadline()
+    TouchBarPosition GetPositionInt ();
+    float GetPositionFloat ();
+    TouchBarPosition GetTargetInt ();
+    float GetTargetFloat ();
+    unsigned int GetPads (); // The pads touched, after the twitch suppression.
+}; // <<< ; at the end is important!!!
+
+class TouchBarMap // Maps a position (0 to Limit) onto an output range (8 bit PWM, 7 bit MIDI CC, 14 bit pitch bend, a DAC code...), straight or along a curve. Integer math only, no division after the constructor. See TouchBarMap.cpp
+{
+  private:
+    unsigned long Scale; // 0 to Limit -> 0 to 65536, Q16
+    TouchBarPosition Limit;
+#ifdef TouchBarWide
+    byte Shift = 0; // Limit >> Shift fits 16 bits, so Position * Scale still fits 32
+#endif
+    unsigned int Min;
+    unsigned int Span; // Max - Min (or Min - Max when Reverse)
+    boolean Reverse = false;
+    const uint16_t *Curve; // PROGMEM, 0 for a straight line
+    byte Segments; // Curve points - 1
+
+  public:
+    TouchBarMap (TouchBarPosition InputLimit, unsigned int OutputMin, unsigned int OutputMax, const uint16_t *CurvePtr = 0, byte CurvePoints = TouchBarCurvePoints); // Output from OutputMin at 0 to OutputMax at InputLimit (OutputMax may be the smaller one, then it goes the other way).
+    void SetLimit (TouchBarPosition InputLimit); // When the Limit of the config changes.
+    unsigned int Map (TouchBarPosition Position); // Anything over InputLimit counts as InputLimit.
+}; // <<< ; at the end is important!!!
+
+class TouchBarLink // Binary telemetry and control over a serial line (or anything byte wide). Frames with a sequence number and a CRC, the latest position, target, tap and gesture at most once per Interval, and commands to read or write the settings live. See TouchBarLink.cpp
+{
+  private:
+    TouchBar *Bar;
+    TouchBarCommon *Common;
+    TouchBarConfig *Configs;
+    byte Count;
+    void (*Output) (byte Data);
+    int (*Room) ();
+    unsigned long Interval;
+    byte Id;
+    byte Sequence = 0;
+    unsigned int Crc;
+    // Latest values, and which changed since the last frame
+    byte Changed = 0;
+    TouchBarPosition Position = TouchBarMaxPosition;
+    TouchBarPosition Target = TouchBarMaxPosition;
+    char Tap = 'Z';
+    unsigned int Gesture = 0;
+    unsigned int Skipped = 0; // Frames that had to wait, the TX buffer was full
+    unsigned int Broken = 0; // Bad frames received
+    unsigned long LastFrame = 0;
+    boolean Sent = false; // Anything sent yet? (LastFrame means nothing until then)
+    // Receiving
+    byte In[LinkMaxPayload + 7]; // The longest frame, with the sync byte and the CRC
+    byte InLength = 0;
+
+    void Put (byte Data);
+    void Put (unsigned int Data);
+    void Put (unsigned long Data);
+    boolean Begin (byte Type, byte Length);
+    void End ();
+    void Handle ();
+    void Skip (byte Bytes);
+    byte Get (byte Config, byte Field, unsigned long *Value);
+    byte Set (byte Config, byte Field, unsigned long Value);
+
+  public:
+    // Constructor
+    TouchBarLink (TouchBar *BarPtr, TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr, byte ConfigCount, void (*OutputFunction) (byte Data), int (*RoomFunction) () = 0, unsigned long FrameInterval = 20000, byte LinkId = 0);
+    // OutputFunction gets every byte to send (Serial.write() for example). RoomFunction (optional, Serial.availableForWrite() for example) tells how many bytes fit without waiting, a frame that doesn't fit waits for the next Service().
+    // FrameInterval: us, at most one LinkState frame this often, each with the latest values. LinkId tells the bars apart when several links share the line.
+
+    // Operation
+    void Service (); // Call it after every Update(), it keeps the latest values and sends them when the Interval is up.
+    void Receive (byte Data); // Give it every byte that comes in, commands are answered as soon as they're complete.
+    void Flush (); // Sends whatever changed right away, Interval or not.
+    unsigned int GetSkipped ();
+    unsigned int GetBroken ();
+}; // <<< ; at the end is important!!!
+
+class TouchBarStore // Keeps the Common object and a Config array in EEPROM (or emulated EEPROM on ESP8266) as a versioned, CRC checked record, in a ring of slots so the writes are spread out. See TouchBarStore.cpp
+{
+  private:
+    TouchBarCommon *Common;
+    TouchBarConfig *Configs;
+    byte Count;
+    unsigned int Address;
+    byte Slots;
+    unsigned long Delay; // ms
+    unsigned long Changed = 0; // millis() of the last Save()
+    boolean Dirty = false;
+    boolean Valid = false; // Slot holds a good record
+    byte Slot = 0; // The newest record
+    unsigned int Sequence = 0; // ...and its number
+    // Record walking
+    unsigned int Cursor;
+    unsigned int Crc;
+    byte Mode;
+    boolean Different;
+
+    void Put (byte Data);
+    void Put (unsigned int Data);
+    void Put (unsigned long Data);
+    byte GetByte ();
+    unsigned int GetInt ();
+    unsigned long GetLong ();
+    void Record (unsigned int NewSequence);
+    boolean Check (byte Index, unsigned int *RecordSequence);
+    boolean Find ();
+
+  public:
+    // Constructor
+    TouchBarStore (TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr, byte ConfigCount, unsigned int EEPROMAddress, byte SlotCount = 4, unsigned long CommitDelay = 2000);
+
+    // Operation
+    unsigned int Length (); // Bytes of EEPROM used from EEPROMAddress (Slots * SlotLength()), on ESP8266 EEPROM.begin() needs at least EEPROMAddress + Length().
+    unsigned int SlotLength ();
+    boolean Load (); // Loads the newest good record. Returns false (and leaves the objects alone) if there's none: blank, corrupt, or saved by another version or with another ConfigCount.
+    void Save (); // Marks the settings changed. Nothing is written until Service() finds them unchanged for CommitDelay ms, so a burst of changes is written once.
+    boolean Service (); // Call it in loop(). Returns true when it wrote a record.
+    boolean Commit (); // Writes now if anything changed since the last record (Save() or not). Returns true when it wrote a record.
+    boolean Pending (); // Returns true while a Save() is waiting to be written.
+}; // <<< ; at the end is important!!!
+
+// SaveTouchBarConfig() / LoadTouchBarConfig() space the config objects in EEPROM the way the compiler laid out a TouchBarConfig before RampTime and the rest came along (8 bytes on AVR, 16 on ESP8266),
+// so the settings saved by earlier versions still load. It's frozen here, TouchBarConfig can grow without moving them.
+struct TouchBarSavedConfig
+{
+  byte Flags;
+  unsigned int Default;
+  unsigned int Limit;
+  byte Resolution;
+  byte RampDelay;
+  byte RampResolution;
+}; // <<< ; at the end is important!!!
+#define SavedConfigStride sizeof(TouchBarSavedConfig)
+#define SavedConfigBytes(Count) (3 + (Count) * SavedConfigStride) // EEPROM used by SaveTouchBarConfig() from EEPROMAddress
+
+#ifndef TouchBarWide // The old layout has 2 byte positions and 1 byte steps, wide settings would be cut short without a word. With TouchBarWide use TouchBarStore.
 void SaveTouchBarConfig (TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr, size_t Size, unsigned int EEPROMAddress);
 void LoadTouchBarConfig (TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr, size_t Size, unsigned int EEPROMAddress);
+#endif
 boolean UpdateEEPROM (unsigned int Address, byte Data); // For ESP8266 (EEPROM.update() gives an error.)
+unsigned int TouchBarLinkCrc (unsigned int Crc, byte Data); // CRC-16/CCITT, one byte at a time, as the TouchBarLink frames are checked (start from 0xFFFF). For the other end of the line.
+boolean SaveTouchBarState (TouchBar *Bars, byte Count, unsigned int EEPROMAddress); // Snapshots Count bars into EEPROM, 2 * Count * sizeof(TouchBarSnapshot) bytes. Only writes what changed, returns true if it wrote anything.
+byte LoadTouchBarState (TouchBar *Bars, byte Count, unsigned int EEPROMAddress); // Restores the bars from the newest good snapshots, returns the number of bars restored.
+
+// Position arithmetic that can't overflow, whatever the Step (up to the full range of TouchBarPosition). See TouchBar.cpp
+TouchBarPosition TouchBarUp (TouchBarPosition Value, TouchBarPosition Step, TouchBarPosition Limit); // Value + Step, stops at Limit.
+TouchBarPosition TouchBarDown (TouchBarPosition Value, TouchBarPosition Step); // Value - Step, stops at 0.
+TouchBarPosition TouchBarAround (TouchBarPosition Value, TouchBarPosition Step, TouchBarPosition Limit, boolean Up); // (Value +/- Step) modulo Limit, rolling over.
+TouchBarPosition TouchBarScale (TouchBarPosition Value, TouchBarPosition Numerator, TouchBarPosition Denominator); // Value * Numerator / Denominator, as long as it fits (Value <= Denominator).
 
 #endif
@@ -0,0 +1,191 @@
+#include "TouchBar.h"
+
+/*
+Analog input
+Touched or not is all Update() gets, so the position only moves when the finger crosses onto another pad (or off one), Resolution at a time.
+The MPR121 (baseline - filtered data) and TouchLib give how much each pad is touched as well, and from how the finger is shared between the pads the position is worked out in between too:
+a single slide moves the position smoothly, 128 little moves per Resolution, rather then one Resolution step per pad change.
+UpdateAnalog() takes those readings. Each pad counts as touched from the Threshold up (SetAnalog()), the touched pads go through the same twitch suppression, tap detection, snap, springback and ramp as with Update(),
+only the steps are left out and the position follows the finger instead. A swipe moves it the same distance either way, Resolution per half pad.
+TouchBar: the stripes repeat A, B, C along the bar, so where the finger is comes from the strongest pad and the 2 next to it (the one before and after it in the A, B, C cycle), less the weakest one, 256 per pad, going round every 768.
+  Each reading is smoothed on its own (Level += (Reading - Level) / 2^Smoothing, rounded away from 0 so it gets all the way there), from the reading the finger landed with.
+TouchBarLinear: the centroid of the pads (weighted by how much over Threshold / 2 each one is), 256 per pad. The centroid is smoothed the same way, in absolute mode the position is Limit * Centroid / (256 * (PadCount - 1)).
+Only compiled with TouchBarAnalog defined (see the top of TouchBar.h).
+*/
+
+#ifdef TouchBarAnalog
+
+#define AnalogHalfPad 128 // Phase / Centroid units per half pad, that's Resolution
+
+
+
+/* TouchBar */
+void TouchBar::SetAnalog (unsigned int Threshold, byte Smoothing)
+{
+  AnalogThreshold = Threshold;
+  AnalogSmoothing = Smoothing;
+}
+
+void TouchBar::UpdateAnalog (unsigned int A, unsigned int B, unsigned int C)
+{
+  unsigned int Readings[3] = {A, B, C};
+  byte Pads = 0;
+  for (byte i = 0; i < 3; i++)
+  {
+    if (Phase < 0)
+      Level[i] = Readings[i]; // Not following a finger, nothing to smooth yet. (Levels rising from 0 would lean the wrong way for a bit, and the position would creep as the finger lands.)
+    else
+    {
+      // Rounded away from 0, so a reading that stays put is reached exactly, from either side (the position ends up where the finger stopped, whichever way it came from).
+      long Difference = (long)Readings[i] - Level[i];
+      long Rounding = (1 << AnalogSmoothing) - 1;
+      Level[i] += (Difference + (Difference < 0 ? -Rounding : Rounding)) / (1 << AnalogSmoothing);
+    }
+    if (Level[i] >= AnalogThreshold)
+      Pads |= 1 << i;
+  }
+
+  Analog = true;
+  Update (Pads); // Main() calls AnalogStep() in the middle of it.
+  Analog = false;
+}
+
+void TouchBar::AnalogStep ()
+{
+  if (ABCPads == 0)
+  {
+    Phase = -1;
+    Fine = 0;
+    return;
+  }
+
+  // The strongest pad, and how the finger leans towards the next one or the one before.
+  byte Max = 0;
+  if (Level[1] > Level[Max])
+    Max = 1;
+  if (Level[2] > Level[Max])
+    Max = 2;
+  if (Level[Max] < AnalogThreshold)
+    return; // Let go, but the twitch suppression holds the pads for a bit yet. Nothing to follow.
+  // Less the weakest pad, so it doesn't jump where the strongest one changes: with all 3 touched (a wide finger, or the smoothing still catching up) the 2 ways round wouldn't agree there.
+  unsigned int Least = Level[0];
+  if (Level[1] < Least)
+    Least = Level[1];
+  if (Level[2] < Least)
+    Least = Level[2];
+  unsigned int Next = Level[(Max + 1) % 3] - Least;
+  unsigned int Before = Level[(Max + 2) % 3] - Least;
+  long Sum = (long)Level[Max] - Least + Next + Before;
+  int NewPhase = Max * 256;
+  if (Sum != 0)
+    NewPhase += ((long)Next - Before) * 256 / Sum;
+  NewPhase = (NewPhase + 768) % 768;
+
+  if (Phase >= 0)
+  {
+    int Delta = NewPhase - Phase;
+    if (Delta >= 384) // Shorter the other way round
+      Delta -= 768;
+    if (Delta < -384)
+      Delta += 768;
+    if (Config->GetFlipFlag() == true)
+      Delta = -Delta;
+    Fine += (long)Delta * Config->Resolution;
+    long Amount = Fine / AnalogHalfPad;
+    Fine -= Amount * AnalogHalfPad;
+
+    if (Amount != 0)
+    {
+      // Not in a long, a TouchBarWide position doesn't fit one.
+      TouchBarPosition Value = Config->GetRampFlag() == true ? Target : Current;
+      if (Config->GetRollOverFlag() == true)
+        Value = TouchBarAround (Value, Amount < 0 ? -Amount : Amount, Config->Limit, Amount > 0);
+      else if (Amount > 0)
+        Value = TouchBarUp (Value, Amount, Config->Limit);
+      else
+        Value = TouchBarDown (Value, -Amount);
+
+      if (Config->GetRampFlag() == true)
+        Target = Value;
+      else
+        Current = Value;
+    }
+  }
+  Phase = NewPhase;
+}
+
+
+
+/* TouchBarLinear */
+void TouchBarLinear::SetAnalog (unsigned int Threshold, byte Smoothing)
+{
+  AnalogThreshold = Threshold;
+  AnalogSmoothing = Smoothing;
+}
+
+void TouchBarLinear::UpdateAnalog (const unsigned int *Readings)
+{
+  unsigned int NewPads = 0;
+  for (byte i = 0; i < Count; i++)
+    if (Readings[i] >= AnalogThreshold)
+      NewPads |= 1 << i;
+
+  Levels = Readings;
+  Analog = true;
+  Update (NewPads); // Calls AnalogStep() in the middle of it.
+  Analog = false;
+}
+
+void TouchBarLinear::AnalogStep ()
+{
+  if (Pads == 0)
+  {
+    Centroid = -1;
+    Fine = 0;
+    return;
+  }
+
+  // The pads barely touched (noise, mostly) are left out, the rest count by how much they're touched.
+  unsigned long Sum = 0;
+  unsigned long Moment = 0;
+  unsigned int Floor = AnalogThreshold / 2;
+  for (byte i = 0; i < Count; i++)
+    if (Levels[i] > Floor)
+    {
+      Sum += Levels[i] - Floor;
+      Moment += (unsigned long)(Levels[i] - Floor) * i;
+    }
+  if (Sum == 0 || Raw == 0)
+    return; // Let go, but the twitch suppression holds the pads for a bit yet. Nothing to follow.
+  long NewCentroid = (Moment << 8) / Sum; // Fits: 15 * 65535 * 16 * 256 < 2^32
+  if (Config->GetFlipFlag() == true)
+    NewCentroid = 256L * (Count - 1) - NewCentroid;
+
+  if (Centroid < 0)
+    Centroid = NewCentroid; // Just landed, nothing to smooth yet.
+  else
+  {
+    long Difference = NewCentroid - Centroid;
+    long Rounding = (1 << AnalogSmoothing) - 1; // Away from 0, same as the TouchBar readings
+    long Smoothed = Centroid + (Difference + (Difference < 0 ? -Rounding : Rounding)) / (1 << AnalogSmoothing);
+    if (Absolute == false)
+    {
+      Fine += (Smoothed - Centroid) * Config->Resolution;
+      long Amount = Fine / AnalogHalfPad;
+      Fine -= Amount * AnalogHalfPad;
+      if (Amount != 0)
+        Move (Amount);
+    }
+    Centroid = Smoothed;
+  }
+
+  if (Absolute)
+  {
+    TouchBarPosition Value = TouchBarScale (Centroid, Config->Limit, 256UL * (Count - 1));
+    if (Config->GetRampFlag() == true)
+      Target = Value;
+    else
+      Current = Value;
+  }
+}
+#endif
@@ -0,0 +1,42 @@
+#include "TouchBar.h"
+
+
+
+/* General */
+TouchBarArray::TouchBarArray (TouchBar *BarsPtr, byte Count, const byte *ElectrodeMap)
+{
+  Bars = BarsPtr;
+  Size = Count;
+  Map = ElectrodeMap;
+}
+
+
+
+/* Operation */
+void TouchBarArray::Update (unsigned long Touched)
+{
+  unsigned long Changed = Touched ^ Previous;
+  Previous = Touched;
+
+  if (Map == 0)
+  {
+    // Bars on consecutive bits, so it's just shifting 3 bits along for each bar.
+    for (byte i = 0; i < Size; i++)
+    {
+      if ((Changed & 0x07) != 0 || Bars[i].Idle() == false)
+        Bars[i].Update ((byte) (Touched & 0x07));
+      Touched >>= 3;
+      Changed >>= 3;
+    }
+  }
+  else
+  {
+    const byte *Electrode = Map;
+    for (byte i = 0; i < Size; i++)
+    {
+      if (((Changed >> Electrode[0] | Changed >> Electrode[1] | Changed >> Electrode[2]) & 0x01) != 0 || Bars[i].Idle() == false)
+        Bars[i].Update ((byte) (bitRead (Touched, Electrode[0]) | bitRead (Touched, Electrode[1]) << 1 | bitRead (Touched, Electrode[2]) << 2));
+      Electrode += 3;
+    }
+  }
+}
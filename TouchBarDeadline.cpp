@@ -0,0 +1,138 @@
+#include "TouchBar.h"
+
+/*
+Sleeping between updates
+Without a Clock everything counts Update() calls (TapCounter, TSCounter, RampCounter), so a bar has to be updated at a steady rate, there's no sleeping in between. With TouchBarCommon::Clock set it's all timed instead,
+and NextDeadline() tells how long it can be left alone: the soonest of
+  the twitch suppression settling (pads changed and not let through yet, TwitchSuppressionTime),
+  the next ramp step (SteppedRamp, RampTime) or the end of the ramp (any other RampProfile, the position in between is worked out whenever it's asked for),
+  the next ms of a fling (the coasting distance is worked out in whole ms),
+  a gesture timing out (LongPressTime, MultiTapTime).
+A tap is timed from the touch to the release, the update on the release works it out, so it needs no deadline. Neither does a pad held still, or anything else that only changes when a pad does.
+So: update on every pad change (a pin change interrupt, the MPR121 IRQ line...) and whenever the deadline comes up, sleep in between. With nothing due it's NoDeadline, an idle bar costs no wakeups at all.
+The per-pad debouncer (DebounceDelay) counts samples, not time, while it's settling the deadline is 0: keep updating at the usual rate. Same with UpdateAnalog() (once SetAnalog() is called) as long as anything is touched, the readings are smoothed sample by sample. Without a Clock it's 0 unless the bar is Idle().
+The deadlines are us from the same Time, several bars merge by taking the smallest (TouchBarArray::NextDeadline() does), no clock rollover to worry about.
+*/
+
+#define FlingTick 1000 // us, the fling moves in whole ms (see TouchBarSwipe.cpp)
+
+static unsigned long Remaining (unsigned long Time, unsigned long Start, unsigned long Period) // Until Start + Period, 0 if that's passed. (Unsigned subtraction, so it survives the clock rolling over.)
+{
+  unsigned long Elapsed = Time - Start;
+  if (Elapsed >= Period)
+    return 0;
+  return Period - Elapsed;
+}
+
+
+
+/* TouchBar */
+unsigned long TouchBar::NextDeadline (unsigned long Time)
+{
+  if (Steady)
+    return NoDeadline;
+  if (Common->Clock == 0)
+    return 0; // Counting updates
+#ifdef TouchBarAnalog
+  if (AnalogThreshold != 0)
+    return 0; // Smoothing readings (SetAnalog() was called)
+#endif
+  if (ABCPads != ABCPrevious[0])
+    return 0; // The pads just changed, the next update moves them into ABCPrevious (and clears the tap timing after a release).
+
+  unsigned long Wait = NoDeadline;
+  if (Raw != ABCPads)
+  {
+#ifdef TouchBarDebouncer
+    if (Common->DebounceDelay != 0)
+      return 0; // Counting samples
+#endif
+    Wait = Remaining (Time, TSStart, Common->TwitchSuppressionTime);
+  }
+
+  if (Config->GetRampFlag() == true)
+  {
+    unsigned long Ramp = NoDeadline;
+#ifdef TouchBarRampProfiles
+    if (Config->RampProfile != SteppedRamp)
+    {
+      if (Target != RampTo || (RampCounter & 0x01) == 0 && Current != Target)
+        Ramp = 0; // The next update starts a ramp.
+      else if ((RampCounter & 0x01) != 0)
+        Ramp = Remaining (Time, RampStart, RampDuration);
+    }
+    else
+#endif
+    if (Current != Target)
+    {
+      if (RampCounter == 0 || Config->RampTime == 0)
+        Ramp = 0;
+      else
+        Ramp = Remaining (Time, RampStart, Config->RampTime);
+    }
+    else if (RampCounter != 0)
+      Ramp = 0; // Just got there, the next update stops the ramp. Left running, the next target would be stepped to from the old RampStart.
+    if (Ramp < Wait)
+      Wait = Ramp;
+  }
+
+#ifdef TouchBarSwipeSpeed
+  if (FlingVelocity != 0)
+  {
+    unsigned long Fling = FlingTick - (Time - FlingStart) % FlingTick;
+    if (Fling < Wait)
+      Wait = Fling;
+  }
+#endif
+
+#ifdef TouchBarGestures
+  unsigned long Gesture = GestureDeadline (Time);
+  if (Gesture < Wait)
+    Wait = Gesture;
+#endif
+  return Wait;
+}
+
+
+
+/* TouchBarLinear */
+unsigned long TouchBarLinear::NextDeadline (unsigned long Time)
+{
+  if (Steady)
+    return NoDeadline;
+  if (Common->Clock == 0)
+    return 0;
+#ifdef TouchBarAnalog
+  if (AnalogThreshold != 0)
+    return 0;
+#endif
+
+  unsigned long Wait = NoDeadline;
+  if (Raw != Pads)
+    Wait = Remaining (Time, TSStart, Common->TwitchSuppressionTime);
+
+  if (Config->GetRampFlag() == true && (Current != Target || RampCounter != 0))
+  {
+    unsigned long Ramp = 0;
+    if (Current != Target && RampCounter != 0 && Config->RampTime != 0)
+      Ramp = Remaining (Time, RampStart, Config->RampTime);
+    if (Ramp < Wait)
+      Wait = Ramp;
+  }
+  return Wait;
+}
+
+
+
+/* TouchBarArray */
+unsigned long TouchBarArray::NextDeadline (unsigned long Time)
+{
+  unsigned long Wait = NoDeadline;
+  for (byte i = 0; i < Size && Wait != 0; i++)
+  {
+    unsigned long Bar = Bars[i].NextDeadline (Time);
+    if (Bar < Wait)
+      Wait = Bar;
+  }
+  return Wait;
+}
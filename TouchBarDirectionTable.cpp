@@ -0,0 +1,72 @@
+#include "TouchBar.h"
+
+// Generated by extras/DirectionTableGen, don't edit it by hand!
+// Direction for every pad history, indexed by PreviousState2 << 9 | PreviousState1 << 6 | PreviousState0 << 3 | CurrentState (3 bits each, BiTB: 0(LSB) = PadA; 1 = PadB; 2 = PadC;)
+// Decrement2 = 0, Decrement = 63, Static = 127, Increment = 192, Increment2 = 255
+const byte TouchBarDirectionTable[4096] PROGMEM =
+{
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 0, PreviousState1 = 0
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,192,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,63,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 0, PreviousState1 = 1
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,63,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,192,127,127,127,127,127,127,127,127, // PreviousState2 = 0, PreviousState1 = 2
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 0, PreviousState1 = 3
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,192,127,127,63,0,192,255,127,63,127,127,127,127,127,127,127,127, // PreviousState2 = 0, PreviousState1 = 4
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 0, PreviousState1 = 5
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 0, PreviousState1 = 6
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 0, PreviousState1 = 7
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 1, PreviousState1 = 0
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 1, PreviousState1 = 1
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 1, PreviousState1 = 2
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,192,127, // PreviousState2 = 1, PreviousState1 = 3
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 1, PreviousState1 = 4
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,63,127, // PreviousState2 = 1, PreviousState1 = 5
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 1, PreviousState1 = 6
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 1, PreviousState1 = 7
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 2, PreviousState1 = 0
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 2, PreviousState1 = 1
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 2, PreviousState1 = 2
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,63,127,127, // PreviousState2 = 2, PreviousState1 = 3
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 2, PreviousState1 = 4
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 2, PreviousState1 = 5
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,192,127,127, // PreviousState2 = 2, PreviousState1 = 6
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 2, PreviousState1 = 7
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 3, PreviousState1 = 0
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 3, PreviousState1 = 1
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 3, PreviousState1 = 2
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 3, PreviousState1 = 3
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 3, PreviousState1 = 4
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 3, PreviousState1 = 5
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 3, PreviousState1 = 6
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,63,127,127,63,0,192,255,127,192,127,127,127,127,127,127,127,127, // PreviousState2 = 3, PreviousState1 = 7
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 4, PreviousState1 = 0
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 4, PreviousState1 = 1
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 4, PreviousState1 = 2
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 4, PreviousState1 = 3
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 4, PreviousState1 = 4
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,192,127,127,127,127, // PreviousState2 = 4, PreviousState1 = 5
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,63,127,127,127,127, // PreviousState2 = 4, PreviousState1 = 6
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 4, PreviousState1 = 7
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 5, PreviousState1 = 0
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 5, PreviousState1 = 1
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 5, PreviousState1 = 2
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 5, PreviousState1 = 3
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 5, PreviousState1 = 4
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 5, PreviousState1 = 5
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 5, PreviousState1 = 6
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,192,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,63,127,127,127,127,127,127,127,127, // PreviousState2 = 5, PreviousState1 = 7
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 6, PreviousState1 = 0
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 6, PreviousState1 = 1
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 6, PreviousState1 = 2
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 6, PreviousState1 = 3
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 6, PreviousState1 = 4
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 6, PreviousState1 = 5
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 6, PreviousState1 = 6
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,63,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,192,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 6, PreviousState1 = 7
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 7, PreviousState1 = 0
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 7, PreviousState1 = 1
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 7, PreviousState1 = 2
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,63,192,127, // PreviousState2 = 7, PreviousState1 = 3
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127, // PreviousState2 = 7, PreviousState1 = 4
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,192,127,127,63,127, // PreviousState2 = 7, PreviousState1 = 5
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,63,127,192,127,127, // PreviousState2 = 7, PreviousState1 = 6
+  127,127,127,127,127,127,127,127,127,127,255,192,0,63,127,127,127,0,127,63,255,127,192,127,127,63,192,127,127,0,255,127,127,255,0,127,127,192,63,127,127,192,127,255,63,127,0,127,127,127,63,0,192,255,127,127,127,127,127,127,127,127,127,127 // PreviousState2 = 7, PreviousState1 = 7
+};
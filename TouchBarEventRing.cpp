@@ -0,0 +1,75 @@
+#include "TouchBar.h"
+
+// Head and Tail are single bytes, so reading or writing them can't be interrupted halfway on any board. What has to be ordered is the event itself being written before Head moves on.
+#ifdef __AVR__
+  #define TouchBarBarrier() asm volatile ("" ::: "memory") // Single core, keeping the compiler from reordering is enough.
+#else
+  #define TouchBarBarrier() __atomic_thread_fence (__ATOMIC_SEQ_CST) // ESP32 and the host may run the 2 sides on different cores.
+#endif
+
+
+
+/* General */
+TouchBarEventRing::TouchBarEventRing (TouchBarEvent *BufferPtr, byte BufferSize)
+{
+  Buffer = BufferPtr;
+  // Head and Tail wrap at 256, so anything but a power of 2 no more then 128 would index past the buffer or lose events. Round it down to one that fits (0 stays 0, and every event is counted as an overflow).
+  Size = 0;
+  if (BufferSize != 0)
+  {
+    Size = 128;
+    while (Size > BufferSize)
+      Size >>= 1;
+  }
+}
+
+
+
+/* Producer */
+boolean TouchBarEventRing::Push (TouchBar *Source, unsigned long Time, byte Type, TouchBarPosition Value)
+{
+  byte H = Head;
+  if ((byte) (H - Tail) >= Size) // Head and Tail run freely and wrap at 256, that's why Size has to be a power of 2 no more then 128.
+  {
+    Overflows += 1;
+    return false;
+  }
+  TouchBarEvent *Event = &Buffer[H & (Size - 1)];
+  Event->Source = Source;
+  Event->Time = Time;
+  Event->Value = Value;
+  Event->Type = Type;
+  TouchBarBarrier ();
+  Head = H + 1;
+  return true;
+}
+
+
+
+/* Consumer */
+boolean TouchBarEventRing::Pop (TouchBarEvent *Event)
+{
+  byte T = Tail;
+  if (Head == T)
+    return false;
+  TouchBarBarrier ();
+  *Event = Buffer[T & (Size - 1)];
+  TouchBarBarrier ();
+  Tail = T + 1;
+  return true;
+}
+
+byte TouchBarEventRing::Available ()
+{
+  return Head - Tail;
+}
+
+unsigned int TouchBarEventRing::GetOverflows ()
+{
+  // 2 bytes on AVR, the producer might change it between reading them, so read it until it reads the same twice.
+  unsigned int X;
+  do
+    X = Overflows;
+  while (X != Overflows);
+  return X;
+}
@@ -0,0 +1,315 @@
+#ifndef TouchBarFixed_H
+#define TouchBarFixed_H
+
+#include "TouchBar.h"
+
+/*
+TouchBarFixed - a TouchBar whose settings are fixed at compile time, for bars that never change mode.
+Every flag check and every Limit / Resolution expression becomes a constant, so the compiler drops the branches of the modes you don't use (rollover, ramp, snap...) and folds the rest into immediates.
+That makes it smaller and faster then TouchBar, which matters on ATtiny class chips. Same methods as TouchBar, minus Reconfigure() and the extras that need a Clock
+(wall-clock timing, ramp profiles, event ring, velocity, fling), it counts Update() calls just like TouchBar does without a Clock, and gives the exact same results.
+It stays 16 bit (positions up to 65535, steps up to 255) with TouchBarWide too, it's meant for the smallest chips.
+
+The settings are a struct (or class) with static constants, like so:
+struct VolumeBar
+{
+  static const unsigned int Default = 5000;
+  static const unsigned int Limit = 10000;
+  static const byte Resolution = 100;
+  static const byte RampDelay = 100;
+  static const byte RampResolution = 25;
+  static const boolean RollOver = false; // Overrides SpringBack, Snap and Ramp, same as TouchBarConfig::SetFlags (RollOverFlag, FlipFlag)
+  static const boolean SpringBack = false;
+  static const boolean Snap = true;
+  static const boolean Ramp = false;
+  static const boolean Flip = false;
+  static const unsigned int TapTimeout = 140; // TouchBarCommon
+  static const byte TwitchSuppressionDelay = 20; // TouchBarCommon
+}; // <<< ; at the end is important!!!
+
+TouchBarFixed<VolumeBar> TB;
+*/
+
+template <class ConfigT>
+class TouchBarFixed
+{
+  private:
+    // The flags the way TouchBarConfig::GetXFlag() would return them.
+    static const boolean RollOverFlag = ConfigT::RollOver;
+    static const boolean SpringBackFlag = ConfigT::SpringBack && !ConfigT::RollOver;
+    static const boolean SnapFlag = ConfigT::Snap && !ConfigT::RollOver;
+    static const boolean RampFlag = ConfigT::Ramp && !ConfigT::RollOver;
+    static const boolean FlipFlag = ConfigT::Flip;
+
+    static_assert (ConfigT::Limit > 3 && ConfigT::Limit < 65535, "Limit: Limit > 3 && Limit < 65535");
+    static_assert (ConfigT::Resolution > 0 && ConfigT::Resolution < ConfigT::Limit, "Resolution: Resolution > 0 && Resolution < Limit");
+    static_assert (ConfigT::Default <= ConfigT::Limit, "Default: 0 to Limit");
+    static_assert (!RampFlag || (ConfigT::RampDelay > 0 && ConfigT::RampResolution > 0 && ConfigT::RampResolution < ConfigT::Limit), "Ramp: RampDelay > 0 && RampResolution > 0 && RampResolution < Limit");
+
+    // Input/Output variables
+    unsigned int Current = ConfigT::Default;
+    unsigned int Target = ConfigT::Default;
+    byte ABCPads = 0;
+    // Internal variables
+    unsigned int Previous = ConfigT::Default;
+    unsigned int TapCounter = 0;
+    byte RampCounter = 0;
+    byte ABCPrevious[3] = {0, 0, 0};
+    byte Direction = Static;
+    byte Raw = 0;
+    byte TSCounter = 0;
+    boolean Steady = false; // See Idle()
+
+    // Private methods (the same steps as TouchBar, see TouchBar.cpp for the comments)
+    void Shift ()
+    {
+      if (ABCPads != ABCPrevious[0])
+      {
+        ABCPrevious[2] = ABCPrevious[1];
+        ABCPrevious[1] = ABCPrevious[0];
+        ABCPrevious[0] = ABCPads;
+      }
+    }
+
+    void TwitchSuppression (byte NewValue)
+    {
+      if (TSCounter < 255)
+        TSCounter += 1;
+      if (NewValue != Raw)
+        TSCounter = 0;
+
+      if ((NewValue != ABCPads && NewValue != 0 && ABCPads != 0) || (NewValue ^ ABCPads && TSCounter == ConfigT::TwitchSuppressionDelay))
+        ABCPads = NewValue;
+
+      Raw = NewValue;
+    }
+
+    void Main ()
+    {
+      // Tap detection
+      if (ABCPads == 1 || ABCPads == 2 || ABCPads == 4 || (ABCPads == 0 && ABCPrevious[0] != 0))
+        TapCounter += 1;
+      else if (ABCPads == 0 && ABCPrevious[0] == 0)
+        TapCounter = 0;
+      else
+        TapCounter = ConfigT::TapTimeout;
+
+      Previous = Current;
+
+      // Snap
+      if (SnapFlag == true)
+        switch (PadEvent())
+        {
+          case 'A': if (RampFlag == true)
+                      Target = 0;
+                    else
+                      Current = 0;
+          break;;
+          case 'B': Reset();
+          break;;
+          case 'C': if (RampFlag == true)
+                      Target = ConfigT::Limit;
+                    else
+                      Current = ConfigT::Limit;
+          break;;
+        }
+
+      GetDirection ();
+      AdjustOutput ();
+
+      Steady = Raw == 0 && ABCPads == 0 && ABCPrevious[0] == 0 && Current == Previous && (RampFlag == false || Current == Target);
+    }
+
+    void GetDirection ()
+    {
+      if (ABCPads == 0)
+      {
+        Direction = Static;
+        ABCPrevious[1] = 0;
+        ABCPrevious[2] = 0;
+        if (SpringBackFlag == true)
+          Reset ();
+      }
+      else
+      {
+        Direction = pgm_read_byte (&TouchBarDirectionTable[ABCPrevious[2] << 9 | ABCPrevious[1] << 6 | ABCPrevious[0] << 3 | ABCPads]);
+        if (FlipFlag == true && Direction != Static)
+          Direction = ~Direction;
+      }
+    }
+
+    // Same as TouchBarUp(), TouchBarDown() and TouchBarAround() (see TouchBar.cpp), in 16 bit and with the Step and Limit constant. Increment2 / Decrement2 are 2 of these, each one clamped on its own, so nothing overflows or overshoots the Limit.
+    static unsigned int Up (unsigned int Value, unsigned int Step)
+    {
+      if (Value >= ConfigT::Limit || ConfigT::Limit - Value <= Step)
+        return ConfigT::Limit;
+      return Value + Step;
+    }
+
+    static unsigned int Down (unsigned int Value, unsigned int Step)
+    {
+      if (Value <= Step)
+        return 0;
+      return Value - Step;
+    }
+
+    static unsigned int Around (unsigned int Value, unsigned int Step, boolean Increase) // Step < Limit, see the static_assert.
+    {
+      Value %= ConfigT::Limit;
+      if (Increase)
+      {
+        if (Value >= ConfigT::Limit - Step)
+          return Value - (ConfigT::Limit - Step);
+        return Value + Step;
+      }
+      if (Value >= Step)
+        return Value - Step;
+      return Value + (ConfigT::Limit - Step);
+    }
+
+    void AdjustOutput ()
+    {
+      const unsigned int Step = ConfigT::Resolution;
+
+      if (RampFlag == true)
+      {
+        if (Direction > Static)
+        {
+          Target = Up (Target, Step);
+          if (Direction == Increment2)
+            Target = Up (Target, Step);
+        }
+        if (Direction < Static)
+        {
+          Target = Down (Target, Step);
+          if (Direction == Decrement2)
+            Target = Down (Target, Step);
+        }
+
+        if (RampCounter == ConfigT::RampDelay - 1)
+        {
+          if (Current < Target)
+          {
+            if (Target - Current > ConfigT::RampResolution)
+              Current += ConfigT::RampResolution;
+            else
+              Current = Target;
+          }
+          if (Current > Target)
+          {
+            if (Current - Target > ConfigT::RampResolution)
+              Current -= ConfigT::RampResolution;
+            else
+              Current = Target;
+          }
+        }
+        RampCounter += 1;
+        RampCounter %= ConfigT::RampDelay;
+      }
+      else if (RollOverFlag == true)
+      {
+        if (Direction != Static)
+        {
+          Current = Around (Current, Step, Direction > Static);
+          if (Direction == Increment2 || Direction == Decrement2)
+            Current = Around (Current, Step, Direction > Static);
+        }
+      }
+      else
+      {
+        if (Direction > Static)
+        {
+          Current = Up (Current, Step);
+          if (Direction == Increment2)
+            Current = Up (Current, Step);
+        }
+        if (Direction < Static)
+        {
+          Current = Down (Current, Step);
+          if (Direction == Decrement2)
+            Current = Down (Current, Step);
+        }
+      }
+    }
+
+  public:
+    // Operation
+    void Update (byte NewValue) // BiTB: 0(LSB) = PadA; 1 = PadB; 2 = PadC; The rest of the bits are ignored.
+    {
+      if (Steady && (NewValue & 0x07) == 0)
+        return;
+      Shift ();
+      TwitchSuppression (NewValue & 0x07);
+      Main ();
+    }
+
+    void Update (boolean A, boolean B, boolean C)
+    {
+      Update ((byte)(C << 2 | B << 1 | A));
+    }
+
+    void SetPosition (unsigned int NewPosition)
+    {
+      Current = NewPosition;
+      Steady = false;
+    }
+
+    void SetTarget (unsigned int NewTarget)
+    {
+      Target = NewTarget;
+      Steady = false;
+    }
+
+    void Reset ()
+    {
+      if (RampFlag == true)
+        Target = ConfigT::Default;
+      else
+        Current = ConfigT::Default;
+      Steady = false;
+    }
+
+    char PadEvent () // Returns A, B or C when a single pad was quickly tapped. Returns Z for no event.
+    {
+      if (TapCounter < ConfigT::TapTimeout && ABCPads == 0)
+        switch (ABCPrevious[0])
+        {
+          case 1: return FlipFlag ? 'C' : 'A';
+          case 2: return 'B';
+          case 4: return FlipFlag ? 'A' : 'C';
+        }
+      return 'Z';
+    }
+
+    boolean Event () // Returns true if there's a change.
+    {
+      return Current != Previous;
+    }
+
+    boolean Idle () // Returns true if the pads are left untouched and nothing is moving.
+    {
+      return Steady;
+    }
+
+    unsigned int GetPositionInt ()
+    {
+      return Current;
+    }
+
+    float GetPositionFloat ()
+    {
+      return float(Current) / 100;
+    }
+
+    unsigned int GetTargetInt ()
+    {
+      return Target;
+    }
+
+    float GetTargetFloat ()
+    {
+      return float(Target) / 100;
+    }
+}; // <<< ; at the end is important!!!
+
+#endif
@@ -0,0 +1,135 @@
+#include "TouchBar.h"
+
+/*
+Gestures
+A small state machine on top of the (twitch suppressed) pads: every update the pads are sorted into one of a few inputs, and the next state, along with the gesture it recognizes (if any), is looked up from a table. That's the same few steps on every update, whatever the state.
+  Inputs: nothing touched, the same pads as the gesture is on, part of them (one pad of a chord), a single other pad, 2 other pads, all 3, or the time of the state ran out.
+  Timed states: a pad held down (LongPressTime, then it's not a tap any more) and let go between taps (MultiTapTime, then no more taps are coming).
+Taps count on the same pad only, a tap on another pad reports the taps before it and starts over. Swiping (or touching another pad while a pad is held) cancels it all until every pad is let go.
+It's timed with the Clock when TouchBarCommon::Clock is set, with micros() otherwise, so the same settings work whichever way Update() is timed. Update() doesn't go Idle() while a gesture is in progress, otherwise the time could run out without anyone noticing.
+Only compiled with TouchBarGestures defined (see the top of TouchBar.h).
+*/
+
+#ifdef TouchBarGestures
+
+// States
+#define GestureIdle 0
+#define GestureDown1 1 // First press
+#define GestureUp1 2 // Tapped once, waiting for another
+#define GestureDown2 3
+#define GestureUp2 4
+#define GestureDown3 5
+#define GestureHeld 6 // Held past LongPressTime
+#define GestureChord 7
+#define GestureIgnore 8 // Swiping, or anything else that isn't a gesture, until every pad is let go
+
+// Inputs
+#define GestureNone 0
+#define GestureSame 1
+#define GesturePart 2
+#define GestureSingle 3
+#define GesturePair 4
+#define GestureAll 5
+#define GestureTimeout 6
+
+#define GestureGo(State, Found) (State | Found << 4) // Table entry: next state, gesture recognized on the way
+
+// Next state and gesture for every state and input. Rows: states, columns: None, Same, Part, Single, Pair, All, Timeout.
+static const byte GestureTable[9][7] PROGMEM =
+{
+  /* Idle */   {GestureIdle, GestureIdle, GestureIdle, GestureDown1, GestureChord, GestureIgnore, GestureIdle},
+  /* Down1 */  {GestureUp1, GestureDown1, GestureDown1, GestureIgnore, GestureIgnore, GestureIgnore, GestureHeld},
+  /* Up1 */    {GestureUp1, GestureDown2, GestureDown2, GestureGo(GestureDown1, SingleTapGesture), GestureGo(GestureChord, SingleTapGesture), GestureGo(GestureIgnore, SingleTapGesture), GestureGo(GestureIdle, SingleTapGesture)},
+  /* Down2 */  {GestureUp2, GestureDown2, GestureDown2, GestureIgnore, GestureIgnore, GestureIgnore, GestureIgnore},
+  /* Up2 */    {GestureUp2, GestureDown3, GestureDown3, GestureGo(GestureDown1, DoubleTapGesture), GestureGo(GestureChord, DoubleTapGesture), GestureGo(GestureIgnore, DoubleTapGesture), GestureGo(GestureIdle, DoubleTapGesture)},
+  /* Down3 */  {GestureGo(GestureIdle, TripleTapGesture), GestureDown3, GestureDown3, GestureIgnore, GestureIgnore, GestureIgnore, GestureIgnore},
+  /* Held */   {GestureGo(GestureIdle, LongPressGesture), GestureHeld, GestureHeld, GestureGo(GestureIgnore, PressSwipeGesture), GestureGo(GestureIgnore, PressSwipeGesture), GestureGo(GestureIgnore, PressSwipeGesture), GestureHeld},
+  /* Chord */  {GestureGo(GestureIdle, ChordGesture), GestureChord, GestureChord, GestureIgnore, GestureIgnore, GestureIgnore, GestureChord},
+  /* Ignore */ {GestureIdle, GestureIgnore, GestureIgnore, GestureIgnore, GestureIgnore, GestureIgnore, GestureIgnore}
+};
+
+// Which time runs out in each state: 0 none, 1 LongPressTime, 2 MultiTapTime.
+static const byte GestureTimer[9] PROGMEM = {0, 1, 2, 1, 2, 1, 0, 0, 0};
+
+// Number of pads touched, for every ABCPads.
+static const byte GesturePadCount[8] PROGMEM = {0, 1, 1, 2, 1, 2, 2, 3};
+
+
+
+/* Recognizer */
+void TouchBar::Recognize () // Called from Main() when any gesture is turned on.
+{
+  unsigned long Time;
+  if (Common->Clock != 0)
+    Time = Now;
+  else
+    Time = micros ();
+
+  byte Input;
+  byte Timer = pgm_read_byte (&GestureTimer[GestureState]);
+  if (Timer == 1 && Time - GestureStart >= Config->LongPressTime || Timer == 2 && Time - GestureStart >= Config->MultiTapTime)
+    Input = GestureTimeout;
+  else if (ABCPads == 0)
+    Input = GestureNone;
+  else if (ABCPads == GesturePads)
+    Input = GestureSame;
+  else if ((ABCPads & ~GesturePads) == 0)
+    Input = GesturePart;
+  else
+    Input = GestureSingle - 1 + pgm_read_byte (&GesturePadCount[ABCPads]);
+
+  byte Next = pgm_read_byte (&GestureTable[GestureState][Input]);
+  if ((Next & 0x0F) == GestureChord && Direction != Static)
+    Next = (Next & 0xF0) | GestureIgnore; // Going from 2 pads to one of them is a step as well (AB, B...), and a chord that moved isn't one. Only a staggered release that doesn't step stays a chord.
+  Gesture = Next >> 4;
+  if (Gesture != NoGesture)
+  {
+    GestureFound = GesturePads;
+    if (Config->GetFlipFlag() == true) // Reported the way the position goes, same as PadEvent(): A and C swap.
+      GestureFound = (GestureFound & 2) | (GestureFound & 1) << 2 | (GestureFound & 4) >> 2;
+    if (bitRead(Config->Gestures, Gesture) == 0)
+      Gesture = NoGesture; // Recognized all the same, so the ones that are turned on come out right, just not reported.
+  }
+
+  Next &= 0x0F;
+  if (Next != GestureState)
+  {
+    GestureState = Next;
+    GestureStart = Time;
+  }
+  if (Next == GestureIdle)
+    GesturePads = 0;
+  else if (Input >= GestureSingle && Input <= GestureAll)
+    GesturePads = ABCPads;
+}
+
+unsigned long TouchBar::GestureDeadline (unsigned long Time) // For NextDeadline(): when the time of the state runs out.
+{
+  if (Config->Gestures == 0)
+    return NoDeadline;
+  byte Timer = pgm_read_byte (&GestureTimer[GestureState]);
+  unsigned long Period;
+  if (Timer == 1)
+    Period = Config->LongPressTime;
+  else if (Timer == 2)
+    Period = Config->MultiTapTime;
+  else
+    return NoDeadline;
+  unsigned long Elapsed = Time - GestureStart;
+  if (Elapsed >= Period)
+    return 0;
+  return Period - Elapsed;
+}
+
+byte TouchBar::GetGesture ()
+{
+  return Gesture;
+}
+
+byte TouchBar::GetGesturePads ()
+{
+  if (Gesture == NoGesture)
+    return 0;
+  return GestureFound;
+}
+#endif
@@ -0,0 +1,140 @@
+#ifndef ARDUINO
+
+#include "TouchBarHost.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+
+/* Virtual clock */
+static unsigned long VirtualMicros = 0;
+
+unsigned long micros ()
+{
+  return VirtualMicros;
+}
+
+unsigned long millis ()
+{
+  return VirtualMicros / 1000;
+}
+
+void SetVirtualMicros (unsigned long Time)
+{
+  VirtualMicros = Time;
+}
+
+void AdvanceVirtualMicros (unsigned long Time)
+{
+  VirtualMicros += Time;
+}
+
+unsigned long HostNanos ()
+{
+  struct timespec Now;
+  clock_gettime (CLOCK_MONOTONIC, &Now);
+  return Now.tv_sec * 1000000000UL + Now.tv_nsec;
+}
+
+unsigned long (*HostCost) () = HostNanos;
+
+
+
+/* Emulated EEPROM */
+EEPROMClass EEPROM;
+
+EEPROMClass::EEPROMClass ()
+{
+  Data = 0;
+  Size = 0;
+  FileName = 0;
+  Writes = 0;
+  Commits = 0;
+}
+
+EEPROMClass::~EEPROMClass ()
+{
+  free (Data);
+}
+
+void EEPROMClass::begin (size_t NewSize)
+{
+  free (Data);
+  Data = (byte *) malloc (NewSize);
+  Size = NewSize;
+  memset (Data, 0xFF, Size);
+}
+
+boolean EEPROMClass::Attach (const char *NewFileName)
+{
+  if (Data == 0)
+    begin (1024); // Same as an ATmega328
+  FileName = NewFileName;
+  FILE *File = fopen (FileName, "rb");
+  if (File == 0)
+    return false;
+  size_t Loaded = fread (Data, 1, Size, File);
+  fclose (File);
+  return Loaded > 0;
+}
+
+byte EEPROMClass::read (int Address)
+{
+  if (Data == 0)
+    begin (1024);
+  if (Address < 0 || (size_t) Address >= Size)
+    return 0xFF;
+  return Data[Address];
+}
+
+void EEPROMClass::write (int Address, byte Value)
+{
+  if (Data == 0)
+    begin (1024);
+  if (Address < 0 || (size_t) Address >= Size)
+    return;
+  Data[Address] = Value;
+  Writes += 1;
+}
+
+void EEPROMClass::update (int Address, byte Value)
+{
+  if (read (Address) != Value)
+    write (Address, Value);
+}
+
+boolean EEPROMClass::commit ()
+{
+  Commits += 1;
+  if (FileName == 0)
+    return true;
+  FILE *File = fopen (FileName, "wb");
+  if (File == 0)
+    return false;
+  size_t Written = fwrite (Data, 1, Size, File);
+  fclose (File);
+  return Written == Size;
+}
+
+void EEPROMClass::end ()
+{
+  commit ();
+}
+
+size_t EEPROMClass::length ()
+{
+  if (Data == 0)
+    begin (1024);
+  return Size;
+}
+
+byte *EEPROMClass::getDataPtr ()
+{
+  if (Data == 0)
+    begin (1024);
+  return Data;
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef TouchBarHost_H
+#define TouchBarHost_H
+
+// Stand-ins for the few bits of the Arduino core the TouchBar engine uses, so the library also builds natively (g++/clang on Linux) for simulation, profiling and regression runs.
+// It's only pulled in when ARDUINO is not defined, on a real board TouchBar.h includes Arduino.h instead.
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+
+// There's only one address space on the host, so "flash" is just const memory.
+#define PROGMEM
+#define pgm_read_byte(address) (*(const byte *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+
+/* Virtual clock */
+// micros() and millis() don't read any hardware clock on the host, they return a virtual time that only moves when you move it, so the same run gives the same result every time.
+unsigned long micros ();
+unsigned long millis ();
+void SetVirtualMicros (unsigned long Time);
+void AdvanceVirtualMicros (unsigned long Time);
+unsigned long HostNanos (); // The real time in ns (not the virtual clock), for measuring how long things take.
+extern unsigned long (*HostCost) (); // What TouchBarInstrumentation times Update() with on the host, HostNanos by default. A check can point it at a clock of its own, to know the costs in advance.
+
+/* Emulated EEPROM */
+// Behaves like the ESP8266 flavour of the EEPROM library (begin() / commit()), but also has update() like the AVR one, so SaveToEERPOM.cpp compiles unchanged.
+// The content lives in a buffer, optionally backed by a file that is loaded by Attach() and rewritten by commit().
+class EEPROMClass
+{
+  private:
+    byte *Data;
+    size_t Size;
+    const char *FileName;
+
+  public:
+    unsigned long Writes; // Number of bytes actually written (write() calls, and update() calls that changed something).
+    unsigned long Commits; // Number of commit() calls, on ESP8266 each of these erases and rewrites a whole flash sector.
+
+    EEPROMClass ();
+    ~EEPROMClass ();
+
+    void begin (size_t NewSize); // Blank (0xFF) content, unless loaded from a file.
+    boolean Attach (const char *NewFileName); // Loads the file if it exists, and makes commit() write the content back to it. Call it after begin().
+    byte read (int Address);
+    void write (int Address, byte Value);
+    void update (int Address, byte Value);
+    boolean commit ();
+    void end ();
+    size_t length ();
+    byte *getDataPtr ();
+}; // <<< ; at the end is important!!!
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,284 @@
+#include "TouchBar.h"
+
+/*
+Linear bar
+Rather then the 3 pads of a TouchBar repeating A, B, C along the bar, every pad of a TouchBarLinear is an electrode of its own, pad 0 at one end, the last pad at the other, 2 to 16 of them (the 12 of an MPR121, for example).
+The finger is found from the touched pads as a whole: half way between the lowest and the highest pad touched, in half pads (Spot). That's 2 * PadCount - 1 spots along the bar, the same steps as a TouchBar swipe (A, AB, B, BC...).
+Swiping moves the position Resolution per half pad, in either direction, from anywhere along the bar. In absolute mode (SetAbsolute()) it goes straight to the spot touched instead, Limit * Spot / (2 * PadCount - 2).
+The lowest and the highest pad are found with a few mask operations and a lookup, so it takes the same time for 16 pads as for 3, and no matter which ones are touched.
+The Config flags work the same as with a TouchBar: RollOver, SpringBack, Snap (a tap jumps to the pad tapped), Ramp (stepped, RampProfile isn't used), Flip (pad 0 at the other end).
+*/
+
+#define LinearMaxJump 4 // Half pads, the most the finger can move between 2 updates while swiping. A bigger jump is another finger, or a bit of noise at the other end of the bar, it's not followed.
+#define NoTap 0xFF
+
+// Bit number of a single bit (16 bits), with a de Bruijn sequence: the top 4 bits of Bit * 0x09AF are different for every bit.
+static const byte LinearBitIndex[16] PROGMEM = {0, 1, 2, 5, 3, 9, 6, 11, 15, 4, 8, 10, 14, 7, 13, 12};
+
+static byte BitIndex (unsigned int Bit)
+{
+  return pgm_read_byte (&LinearBitIndex[(unsigned int)(Bit * 0x09AF) >> 12 & 0x0F]);
+}
+
+
+
+/* General */
+TouchBarLinear::TouchBarLinear (TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr, byte PadCount)
+{
+  Common = CommonPtr;
+  Config = ConfigPtr;
+  if (PadCount < 2)
+    PadCount = 2;
+  if (PadCount > 16)
+    PadCount = 16;
+  Count = PadCount;
+  Mask = (1UL << PadCount) - 1;
+  Current = Config->Default;
+  Previous = Config->Default;
+  Target = Config->Default;
+}
+
+void TouchBarLinear::SetAbsolute (boolean AbsoluteFlag)
+{
+  Absolute = AbsoluteFlag;
+}
+
+void TouchBarLinear::SetPosition (TouchBarPosition NewPosition)
+{
+  Current = NewPosition;
+  Steady = false;
+}
+
+void TouchBarLinear::SetTarget (TouchBarPosition NewTarget)
+{
+  Target = NewTarget;
+  Steady = false;
+}
+
+void TouchBarLinear::Reset ()
+{
+  if (Config->GetRampFlag() == true)
+    Target = Config->Default;
+  else
+    Current = Config->Default;
+  Steady = false;
+}
+
+
+
+/* Input / Output */
+void TouchBarLinear::Update (unsigned int NewValue)
+{
+  NewValue &= Mask;
+  if (Steady && NewValue == 0)
+    return; // Nothing touched, nothing to do...
+
+  if (Common->Clock != 0)
+    Now = Common->Clock ();
+  Previous = Current;
+  Tap = 'Z';
+  TwitchSuppression (NewValue);
+
+  if (Pads != 0)
+  {
+    byte NewSpot = GetSpot ();
+    if (Touched == false)
+    {
+      // The finger just landed.
+      Touched = true;
+      TapSpot = NewSpot;
+      TapCounter = 0;
+      TapStart = Now;
+#ifdef TouchBarAnalog
+      if (Absolute && Analog == false)
+#else
+      if (Absolute)
+#endif
+        Jump (NewSpot);
+    }
+#ifdef TouchBarAnalog
+    else if (Analog)
+      ; // AnalogStep() moves it.
+#endif
+    else if (Absolute)
+      Jump (NewSpot);
+    else if (NewSpot - Spot <= LinearMaxJump && Spot - NewSpot <= LinearMaxJump)
+      Move ((long)(NewSpot - Spot) * Config->Resolution);
+
+    // A tap is a single pad, touched and let go quickly, without moving.
+    if (NewSpot != TapSpot || (Pads & (Pads - 1)) != 0)
+      TapSpot = NoTap;
+    if (TapCounter < Common->TapTimeout)
+      TapCounter += 1;
+    Spot = NewSpot;
+  }
+  else if (Touched)
+  {
+    // The finger just left.
+    Touched = false;
+    boolean InTime;
+    if (Common->Clock == 0)
+      InTime = TapCounter < Common->TapTimeout;
+    else
+      InTime = Now - TapStart < Common->TapTime;
+    if (InTime && TapSpot != NoTap)
+    {
+      Tap = 'A' + TapSpot / 2;
+      if (Config->GetSnapFlag() == true)
+        Jump (TapSpot);
+    }
+    if (Config->GetSpringBackFlag() == true)
+      Reset ();
+  }
+
+#ifdef TouchBarAnalog
+  if (Analog)
+    AnalogStep ();
+#endif
+  if (Config->GetRampFlag() == true)
+    Ramp ();
+
+  // Same as TouchBar::Update(), untouched and settled: the next updates with nothing touched return straight away.
+  Steady = Raw == 0 && Pads == 0 && Tap == 'Z' && Current == Previous && (Config->GetRampFlag() == false || Current == Target);
+}
+
+void TouchBarLinear::TwitchSuppression (unsigned int NewValue)
+{
+  // Same as TouchBar::TwitchSuppression(), for any number of pads.
+  boolean Settled;
+  if (Common->Clock == 0)
+  {
+    if (TSCounter < 255)
+      TSCounter += 1;
+    if (NewValue != Raw)
+      TSCounter = 0;
+    Settled = TSCounter == Common->TwitchSuppressionDelay;
+  }
+  else
+  {
+    if (NewValue != Raw)
+      TSStart = Now;
+    Settled = Now - TSStart >= Common->TwitchSuppressionTime;
+  }
+
+  if (NewValue != Pads && NewValue != 0 && Pads != 0 || NewValue != Pads && Settled)
+    Pads = NewValue;
+  Raw = NewValue;
+}
+
+byte TouchBarLinear::GetSpot ()
+{
+  // Lowest touched pad: Pads & -Pads leaves only the lowest bit. Highest: smearing the top bit all the way down, then dropping everything below it.
+  unsigned int Low = Pads & (0 - Pads);
+  unsigned int High = Pads;
+  High |= High >> 1;
+  High |= High >> 2;
+  High |= High >> 4;
+  High |= High >> 8;
+  High ^= High >> 1;
+  byte NewSpot = BitIndex (Low) + BitIndex (High);
+  if (Config->GetFlipFlag() == true)
+    NewSpot = 2 * (Count - 1) - NewSpot;
+  return NewSpot;
+}
+
+void TouchBarLinear::Move (long Amount) // Resolution per half pad when swiping, like a TouchBar step.
+{
+  TouchBarPosition Value = Config->GetRampFlag() == true ? Target : Current;
+  if (Config->GetRollOverFlag() == true)
+    Value = TouchBarAround (Value, Amount < 0 ? -Amount : Amount, Config->Limit, Amount > 0);
+  else if (Amount > 0)
+    Value = TouchBarUp (Value, Amount, Config->Limit);
+  else
+    Value = TouchBarDown (Value, -Amount);
+
+  if (Config->GetRampFlag() == true)
+    Target = Value;
+  else
+    Current = Value;
+}
+
+void TouchBarLinear::Jump (byte NewSpot)
+{
+  TouchBarPosition Value = TouchBarScale (NewSpot, Config->Limit, 2 * (Count - 1));
+  if (Config->GetRampFlag() == true)
+    Target = Value;
+  else
+    Current = Value;
+}
+
+void TouchBarLinear::Ramp () // RampResolution every RampDelay updates, or every RampTime us with a Clock, same as a SteppedRamp.
+{
+  unsigned long Steps = 0;
+  if (Current == Target)
+    RampCounter = 0;
+  else if (Common->Clock == 0)
+  {
+    RampCounter += 1;
+    if (RampCounter >= Config->RampDelay)
+    {
+      RampCounter = 0;
+      Steps = 1;
+    }
+  }
+  else if (RampCounter == 0)
+  {
+    RampCounter = 1; // Ramping, timed from now
+    RampStart = Now;
+  }
+  else if (Config->RampTime == 0)
+    Current = Target;
+  else if (Now - RampStart >= Config->RampTime)
+  {
+    Steps = (Now - RampStart) / Config->RampTime;
+    RampStart += Steps * Config->RampTime;
+  }
+
+  if (Steps > 1 && Steps > TouchBarMaxPosition / Config->RampResolution)
+    Steps = TouchBarMaxPosition / Config->RampResolution; // Long enough to get anywhere, and Steps * RampResolution can't overflow.
+  unsigned long Step = Steps * Config->RampResolution;
+  if (Current < Target)
+    Current = Target - Current > Step ? Current + Step : Target;
+  else
+    Current = Current - Target > Step ? Current - Step : Target;
+}
+
+char TouchBarLinear::PadEvent ()
+{
+  return Tap;
+}
+
+boolean TouchBarLinear::Event ()
+{
+  return Current != Previous;
+}
+
+boolean TouchBarLinear::Idle ()
+{
+  return Steady;
+}
+
+TouchBarPosition TouchBarLinear::GetPositionInt ()
+{
+  return Current;
+}
+
+float TouchBarLinear::GetPositionFloat ()
+{
+  return float(Current) / 100;
+}
+
+TouchBarPosition TouchBarLinear::GetTargetInt ()
+{
+  return Target;
+}
+
+float TouchBarLinear::GetTargetFloat ()
+{
+  return float(Target) / 100;
+}
+
+unsigned int TouchBarLinear::GetPads ()
+{
+  return Pads;
+}
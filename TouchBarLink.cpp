@@ -0,0 +1,421 @@
+#include "TouchBar.h"
+
+/*
+Telemetry and control link
+Rather then a line of text for every change (at a few kHz of Update() that's more then 115200 baud can carry, and Serial.print() waits for room in the TX buffer, stalling loop()), the changes go out in small binary frames:
+  LinkSync (0xA5), Length (of the payload), Sequence, Type, Id, Payload (Length bytes), CRC-16 (2) of everything from Length to the end of the payload. Numbers are MSB first.
+  Sequence counts up with every frame sent, so the other end can tell if it missed any. Id tells the bars apart when several links share a line.
+  Position and target are 2 bytes, or 4 with TouchBarWide (LinkWide is set in the fields then, so the host can tell).
+Coalescing: Service() only notes the latest position, target, tap and gesture, a LinkState frame goes out with the ones that changed when Interval is up since the last one. So a swipe is at most one frame per Interval whatever the update rate, and nothing at all while nothing changes.
+With a RoomFunction a frame that doesn't fit the TX buffer isn't sent (it's counted in the counters), the values keep piling up (the latest ones) and go out with the next frame that fits. Service() never waits.
+Commands (LinkRead, LinkWrite, LinkHello) come in the same frames, with Id set to the link's Id or LinkCommon (all links answer). Every one is answered (LinkValue with the value it has now, LinkError, LinkInfo), with the command's sequence number in it so the answer can be matched to the question.
+A frame with a bad CRC is dropped and counted (the counters go out with the next LinkState frame), the host has to ask again if it gets no answer.
+Writing a field checks the range first (Limit > 3, Resolution < Limit...), a bad value is answered with LinkOutOfRange and the field is left alone. Writing the Limit of the config in use doesn't move the position, SetPosition() it if it's over the new Limit.
+The host side: TouchBarLinkHost.h (decoder and commands) and extras/LinkDecode.
+*/
+
+#define LinkOverhead 7 // Sync, Length, Sequence, Type, Id and the CRC
+
+#ifdef TouchBarWide
+  #define PutPosition(Data) Put ((unsigned long)(Data))
+#else
+  #define PutPosition(Data) Put ((unsigned int)(Data))
+#endif
+
+unsigned int TouchBarLinkCrc (unsigned int Crc, byte Data) // CRC-16/CCITT bit by bit, same as TouchBarStore, a table isn't worth the flash for frames this short.
+{
+  Crc ^= (unsigned int)Data << 8;
+  for (byte i = 0; i < 8; i++)
+    if (Crc & 0x8000)
+      Crc = (Crc << 1) ^ 0x1021;
+    else
+      Crc <<= 1;
+  return Crc & 0xFFFF;
+}
+
+
+
+/* General */
+TouchBarLink::TouchBarLink (TouchBar *BarPtr, TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr, byte ConfigCount, void (*OutputFunction) (byte Data), int (*RoomFunction) (), unsigned long FrameInterval, byte LinkId)
+{
+  Bar = BarPtr;
+  Common = CommonPtr;
+  Configs = ConfigPtr;
+  Count = ConfigCount;
+  Output = OutputFunction;
+  Room = RoomFunction;
+  Interval = FrameInterval;
+  Id = LinkId;
+}
+
+unsigned int TouchBarLink::GetSkipped ()
+{
+  return Skipped;
+}
+
+unsigned int TouchBarLink::GetBroken ()
+{
+  return Broken;
+}
+
+
+
+/* Frames */
+void TouchBarLink::Put (byte Data)
+{
+  Crc = TouchBarLinkCrc (Crc, Data);
+  Output (Data);
+}
+
+void TouchBarLink::Put (unsigned int Data)
+{
+  Put ((byte)(Data >> 8));
+  Put ((byte)Data);
+}
+
+void TouchBarLink::Put (unsigned long Data)
+{
+  Put ((unsigned int)(Data >> 16));
+  Put ((unsigned int)Data);
+}
+
+boolean TouchBarLink::Begin (byte Type, byte Length) // Starts a frame, if it fits.
+{
+  if (Room != 0 && Room () < Length + LinkOverhead)
+  {
+    if (Skipped < 0xFFFF)
+      Skipped += 1;
+    Changed |= LinkCounters;
+    return false;
+  }
+  Output (LinkSync);
+  Crc = 0xFFFF;
+  Put (Length);
+  Put (Sequence);
+  Put (Type);
+  Put (Id);
+  Sequence += 1;
+  return true;
+}
+
+void TouchBarLink::End ()
+{
+  unsigned int Sum = Crc; // Put() would keep adding to it.
+  Output (Sum >> 8);
+  Output (Sum);
+}
+
+
+
+/* Telemetry */
+void TouchBarLink::Service ()
+{
+  TouchBarPosition NewPosition = Bar->GetPositionInt ();
+  if (NewPosition != Position)
+  {
+    Position = NewPosition;
+    Changed |= LinkPosition;
+  }
+  TouchBarPosition NewTarget = Bar->GetTargetInt ();
+  if (NewTarget != Target)
+  {
+    Target = NewTarget;
+    Changed |= LinkTarget;
+  }
+  char Pad = Bar->PadEvent ();
+  if (Pad != 'Z')
+  {
+    Tap = Pad;
+    Changed |= LinkTap;
+  }
+#ifdef TouchBarGestures
+  if (Bar->GetGesture () != NoGesture)
+  {
+    Gesture = Bar->GetGesture () << 8 | Bar->GetGesturePads ();
+    Changed |= LinkGesture;
+  }
+#endif
+
+  // micros() is only read when there's something to send.
+  if (Changed != 0 && (Sent == false || micros () - LastFrame >= Interval))
+    Flush ();
+}
+
+void TouchBarLink::Flush ()
+{
+  if (Changed == 0)
+    return;
+  byte Length = 5;
+  if (Changed & LinkPosition)
+    Length += TouchBarPositionBytes;
+  if (Changed & LinkTarget)
+    Length += TouchBarPositionBytes;
+  if (Changed & LinkTap)
+    Length += 1;
+  if (Changed & LinkGesture)
+    Length += 2;
+  if (Changed & LinkCounters)
+    Length += 4;
+  byte Fields = Changed;
+#ifdef TouchBarWide
+  Fields |= LinkWide;
+#endif
+  if (Begin (LinkState, Length) == false)
+    return; // Next time, with whatever changed by then.
+
+  unsigned long Now = micros ();
+  Put (Fields);
+  Put (Now);
+  if (Fields & LinkPosition)
+    PutPosition (Position);
+  if (Fields & LinkTarget)
+    PutPosition (Target);
+  if (Fields & LinkTap)
+    Put ((byte)Tap);
+  if (Fields & LinkGesture)
+    Put (Gesture);
+  if (Fields & LinkCounters)
+  {
+    Put (Skipped);
+    Put (Broken);
+  }
+  End ();
+  Changed = 0;
+  LastFrame = Now;
+  Sent = true;
+}
+
+
+
+/* Control */
+void TouchBarLink::Receive (byte Data)
+{
+  if (InLength == 0 && Data != LinkSync)
+    return; // Not a frame, waiting for the start of one.
+  In[InLength++] = Data;
+  while (InLength >= 2)
+  {
+    byte Length = In[1];
+    if (Length <= LinkMaxPayload)
+    {
+      if (InLength < Length + LinkOverhead)
+        return; // More to come
+      unsigned int Sum = 0xFFFF;
+      for (byte i = 1; i < Length + 5; i++)
+        Sum = TouchBarLinkCrc (Sum, In[i]);
+      if (Sum == ((unsigned int)In[Length + 5] << 8 | In[Length + 6]))
+      {
+        if (In[4] == Id || In[4] == LinkCommon)
+          Handle ();
+        Skip (Length + LinkOverhead);
+        continue;
+      }
+      if (Broken < 0xFFFF)
+        Broken += 1;
+      Changed |= LinkCounters;
+    }
+    Skip (1); // That sync byte was noise (or the frame got hit), the next frame may start at any sync byte after it.
+  }
+}
+
+void TouchBarLink::Skip (byte Bytes) // Drops Bytes from the start of In, and whatever comes after them up to the next sync byte.
+{
+  byte From = Bytes;
+  while (From < InLength && In[From] != LinkSync)
+    From++;
+  for (byte i = From; i < InLength; i++)
+    In[i - From] = In[i];
+  InLength -= From;
+}
+
+void TouchBarLink::Handle ()
+{
+  byte Length = In[1];
+  byte CommandSequence = In[2];
+  byte Type = In[3];
+  byte Config = In[5];
+  byte Field = In[6];
+  byte Error = 0;
+  unsigned long Value = 0;
+
+  if (Type == LinkHello)
+  {
+    if (Begin (LinkInfo, 6))
+    {
+      Put ((byte)LinkVersion);
+      Put (Count);
+      Put (Interval);
+      End ();
+    }
+    return;
+  }
+
+  if (Type == LinkRead && Length >= 2)
+    Error = Get (Config, Field, &Value);
+  else if (Type == LinkWrite && Length >= 6)
+  {
+    Value = (unsigned long)In[7] << 24 | (unsigned long)In[8] << 16 | (unsigned long)In[9] << 8 | In[10];
+    Error = Set (Config, Field, Value);
+    if (Error == 0)
+      Error = Get (Config, Field, &Value); // The answer is what it is now.
+  }
+  else
+  {
+    Error = LinkNoCommand;
+    Config = 0;
+    Field = 0;
+  }
+
+  if (Error != 0)
+  {
+    if (Begin (LinkError, 4))
+    {
+      Put (Config);
+      Put (Field);
+      Put (Error);
+      Put (CommandSequence);
+      End ();
+    }
+  }
+  else if (Begin (LinkValue, 7))
+  {
+    Put (Config);
+    Put (Field);
+    Put (Value);
+    Put (CommandSequence);
+    End ();
+  }
+}
+
+byte TouchBarLink::Get (byte Config, byte Field, unsigned long *Value)
+{
+  if (Config == LinkCommon)
+  {
+    switch (Field)
+    {
+      case LinkTapTimeout: *Value = Common->TapTimeout; break;;
+      case LinkTwitchSuppressionDelay: *Value = Common->TwitchSuppressionDelay; break;;
+      case LinkTapTime: *Value = Common->TapTime; break;;
+      case LinkTwitchSuppressionTime: *Value = Common->TwitchSuppressionTime; break;;
+      case LinkDebounceDelay: *Value = Common->DebounceDelay; break;;
+      default: return LinkNoField;
+    }
+    return 0;
+  }
+  if (Config >= Count)
+    return LinkNoConfig;
+
+  TouchBarConfig *C = &Configs[Config];
+  switch (Field)
+  {
+    case LinkDefault: *Value = C->Default; break;;
+    case LinkLimit: *Value = C->Limit; break;;
+    case LinkResolution: *Value = C->Resolution; break;;
+    case LinkRampDelay: *Value = C->RampDelay; break;;
+    case LinkRampResolution: *Value = C->RampResolution; break;;
+    case LinkFlags: *Value = C->GetRollOverFlag() << 7 | C->GetSpringBackFlag() << 6 | C->GetSnapFlag() << 5 | C->GetRampFlag() << 4 | C->GetFlipFlag() << 3; break;;
+    case LinkRampTime: *Value = C->RampTime; break;;
+    case LinkRampProfile: *Value = C->RampProfile; break;;
+    case LinkAccelerationSpeed: *Value = C->AccelerationSpeed; break;;
+    case LinkAccelerationLimit: *Value = C->AccelerationLimit; break;;
+    case LinkFlingTime: *Value = C->FlingTime; break;;
+    case LinkFlingSpeed: *Value = C->FlingSpeed; break;;
+    case LinkGestures: *Value = C->Gestures; break;;
+    case LinkMultiTapTime: *Value = C->MultiTapTime; break;;
+    case LinkLongPressTime: *Value = C->LongPressTime; break;;
+    default: return LinkNoField;
+  }
+  return 0;
+}
+
+byte TouchBarLink::Set (byte Config, byte Field, unsigned long Value)
+{
+  if (Config == LinkCommon)
+  {
+    switch (Field)
+    {
+      case LinkTapTimeout: if (Value > 0xFFFF)
+                             return LinkOutOfRange;
+                           Common->TapTimeout = Value;
+      break;;
+      case LinkTwitchSuppressionDelay: if (Value > 0xFF)
+                                         return LinkOutOfRange;
+                                       Common->TwitchSuppressionDelay = Value;
+      break;;
+      case LinkTapTime: Common->TapTime = Value;
+      break;;
+      case LinkTwitchSuppressionTime: Common->TwitchSuppressionTime = Value;
+      break;;
+      case LinkDebounceDelay: if (Value >= 1UL << DebounceBits)
+                                return LinkOutOfRange;
+                              Common->DebounceDelay = Value;
+      break;;
+      default: return LinkNoField;
+    }
+    return 0;
+  }
+  if (Config >= Count)
+    return LinkNoConfig;
+
+  TouchBarConfig *C = &Configs[Config];
+  switch (Field)
+  {
+    case LinkDefault: if (Value > C->Limit)
+                        return LinkOutOfRange;
+                      C->Default = Value;
+    break;;
+    case LinkLimit: if (Value < 4 || Value >= TouchBarMaxPosition || Value <= C->Resolution || Value <= C->RampResolution || Value < C->Default)
+                      return LinkOutOfRange;
+                    C->Limit = Value;
+    break;;
+    case LinkResolution: if (Value == 0 || Value > TouchBarMaxStep || Value >= C->Limit)
+                           return LinkOutOfRange;
+                         C->Resolution = Value;
+    break;;
+    case LinkRampDelay: if (Value > 0xFF)
+                          return LinkOutOfRange;
+                        C->RampDelay = Value;
+    break;;
+    case LinkRampResolution: if (Value == 0 || Value > TouchBarMaxStep || Value >= C->Limit)
+                               return LinkOutOfRange;
+                             C->RampResolution = Value;
+    break;;
+    case LinkFlags: if (Value > 0xFF)
+                      return LinkOutOfRange;
+                    if (bitRead(Value, 7) == true) // RollOver overrides the rest, same as TouchBarStore::Load()
+                      C->SetFlags((boolean)bitRead(Value, 7), (boolean)bitRead(Value, 3));
+                    else
+                      C->SetFlags((boolean)bitRead(Value, 6), (boolean)bitRead(Value, 5), (boolean)bitRead(Value, 4), (boolean)bitRead(Value, 3));
+    break;;
+    case LinkRampTime: C->RampTime = Value;
+    break;;
+    case LinkRampProfile: if (Value > SCurveRamp)
+                            return LinkOutOfRange;
+                          C->RampProfile = Value;
+    break;;
+    case LinkAccelerationSpeed: if (Value > 0xFFFF)
+                                  return LinkOutOfRange;
+                                C->AccelerationSpeed = Value;
+    break;;
+    case LinkAccelerationLimit: if (Value == 0 || Value > 0xFF)
+                                  return LinkOutOfRange;
+                                C->AccelerationLimit = Value;
+    break;;
+    case LinkFlingTime: C->FlingTime = Value;
+    break;;
+    case LinkFlingSpeed: if (Value > 0xFFFF)
+                           return LinkOutOfRange;
+                         C->FlingSpeed = Value;
+    break;;
+    case LinkGestures: if (Value > 0xFF)
+                         return LinkOutOfRange;
+                       C->Gestures = Value;
+    break;;
+    case LinkMultiTapTime: C->MultiTapTime = Value;
+    break;;
+    case LinkLongPressTime: C->LongPressTime = Value;
+    break;;
+    default: return LinkNoField;
+  }
+  return 0;
+}
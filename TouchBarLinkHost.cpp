@@ -0,0 +1,184 @@
+#ifndef ARDUINO
+
+#include "TouchBarLinkHost.h"
+#include <string.h>
+
+static size_t BuildFrame (byte *Buffer, byte Type, byte Id, byte Sequence, const byte *Payload, byte Length)
+{
+  Buffer[0] = LinkSync;
+  Buffer[1] = Length;
+  Buffer[2] = Sequence;
+  Buffer[3] = Type;
+  Buffer[4] = Id;
+  if (Length != 0)
+    memcpy (Buffer + 5, Payload, Length);
+  unsigned int Sum = 0xFFFF;
+  for (size_t i = 1; i < Length + 5u; i++)
+    Sum = TouchBarLinkCrc (Sum, Buffer[i]);
+  Buffer[Length + 5] = Sum >> 8;
+  Buffer[Length + 6] = Sum & 0xFF;
+  return Length + 7;
+}
+
+static unsigned long GetNumber (const byte *Data, byte Bytes) // MSB first
+{
+  unsigned long Value = 0;
+  for (byte i = 0; i < Bytes; i++)
+    Value = Value << 8 | Data[i];
+  return Value;
+}
+
+
+
+/* Receiving */
+boolean TouchBarLinkDecoder::Feed (byte Data)
+{
+  if (InLength == 0 && Data != LinkSync)
+    return false;
+  In[InLength++] = Data;
+  while (InLength >= 2)
+  {
+    size_t Length = In[1];
+    if (Length <= LinkHostPayload)
+    {
+      if (InLength < Length + 7)
+        return false; // More to come
+      unsigned int Sum = 0xFFFF;
+      for (size_t i = 1; i < Length + 5; i++)
+        Sum = TouchBarLinkCrc (Sum, In[i]);
+      if (Sum == (unsigned int)(In[Length + 5] << 8 | In[Length + 6]))
+      {
+        Take ();
+        Skip (Length + 7);
+        return true;
+      }
+    }
+    // The sync byte was noise (or the frame got hit), the next frame may start at any sync byte after it. Same as TouchBarLink::Receive().
+    BadFrames += 1;
+    Skip (1);
+  }
+  return false;
+}
+
+void TouchBarLinkDecoder::Skip (size_t Bytes)
+{
+  size_t From = Bytes;
+  while (From < InLength && In[From] != LinkSync)
+    From++;
+  memmove (In, In + From, InLength - From);
+  InLength -= From;
+}
+
+void TouchBarLinkDecoder::Take () // The frame at the start of In checks out.
+{
+  Frame.Length = In[1];
+  Frame.Sequence = In[2];
+  Frame.Type = In[3];
+  Frame.Id = In[4];
+  memcpy (Frame.Payload, In + 5, Frame.Length);
+  if (Synced)
+    Lost += (byte)(Frame.Sequence - NextSequence);
+  Synced = true;
+  NextSequence = Frame.Sequence + 1;
+  Frames += 1;
+}
+
+const TouchBarLinkFrame *TouchBarLinkDecoder::GetFrame ()
+{
+  return &Frame;
+}
+
+boolean TouchBarLinkDecoder::GetState (TouchBarLinkState *State)
+{
+  if (Frame.Type != LinkState || Frame.Length < 5)
+    return false;
+  const byte *Data = Frame.Payload;
+  Latest.Fields = Data[0];
+  Latest.Time = GetNumber (Data + 1, 4);
+  Data += 5;
+  byte Size = Latest.Fields & LinkWide ? 4 : 2;
+  if (Latest.Fields & LinkPosition)
+  {
+    Latest.Position = GetNumber (Data, Size);
+    Data += Size;
+  }
+  if (Latest.Fields & LinkTarget)
+  {
+    Latest.Target = GetNumber (Data, Size);
+    Data += Size;
+  }
+  if (Latest.Fields & LinkTap)
+    Latest.Tap = *Data++;
+  if (Latest.Fields & LinkGesture)
+  {
+    Latest.Gesture = Data[0];
+    Latest.GesturePads = Data[1];
+    Data += 2;
+  }
+  if (Latest.Fields & LinkCounters)
+  {
+    Latest.Skipped = GetNumber (Data, 2);
+    Latest.Broken = GetNumber (Data + 2, 2);
+  }
+  *State = Latest;
+  return true;
+}
+
+boolean TouchBarLinkDecoder::GetValue (byte *Config, byte *Field, unsigned long *Value, byte *CommandSequence)
+{
+  if (Frame.Type != LinkValue || Frame.Length < 7)
+    return false;
+  *Config = Frame.Payload[0];
+  *Field = Frame.Payload[1];
+  *Value = GetNumber (Frame.Payload + 2, 4);
+  *CommandSequence = Frame.Payload[6];
+  return true;
+}
+
+boolean TouchBarLinkDecoder::GetError (byte *Config, byte *Field, byte *Error, byte *CommandSequence)
+{
+  if (Frame.Type != LinkError || Frame.Length < 4)
+    return false;
+  *Config = Frame.Payload[0];
+  *Field = Frame.Payload[1];
+  *Error = Frame.Payload[2];
+  *CommandSequence = Frame.Payload[3];
+  return true;
+}
+
+unsigned long TouchBarLinkDecoder::GetFrames ()
+{
+  return Frames;
+}
+
+unsigned long TouchBarLinkDecoder::GetBadFrames ()
+{
+  return BadFrames;
+}
+
+unsigned long TouchBarLinkDecoder::GetLost ()
+{
+  return Lost;
+}
+
+
+
+/* Commands */
+size_t TouchBarLinkDecoder::Hello (byte *Buffer, byte Id, byte Sequence)
+{
+  return BuildFrame (Buffer, LinkHello, Id, Sequence, 0, 0);
+}
+
+size_t TouchBarLinkDecoder::Read (byte *Buffer, byte Id, byte Sequence, byte Config, byte Field)
+{
+  byte Payload[2] = {Config, Field};
+  return BuildFrame (Buffer, LinkRead, Id, Sequence, Payload, 2);
+}
+
+size_t TouchBarLinkDecoder::Write (byte *Buffer, byte Id, byte Sequence, byte Config, byte Field, unsigned long Value)
+{
+  byte Payload[6] = {Config, Field, (byte)(Value >> 24), (byte)(Value >> 16), (byte)(Value >> 8), (byte)Value};
+  return BuildFrame (Buffer, LinkWrite, Id, Sequence, Payload, 6);
+}
+
+#endif
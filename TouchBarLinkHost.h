@@ -0,0 +1,71 @@
+#ifndef TouchBarLinkHost_H
+#define TouchBarLinkHost_H
+
+// Host only! The PC end of a TouchBarLink: takes the bytes as they come off the serial port, hands back the frames that check out, and builds the commands to send.
+// For supervisory software in C or C++, see extras/LinkDecode for a tool that turns the stream into CSV for anything else.
+
+#ifndef ARDUINO
+
+#include "TouchBar.h"
+#include <stddef.h>
+
+#define LinkHostPayload 20 // The longest payload of either width (LinkMaxPayload of a TouchBarWide board), so the decoder takes frames from both whichever way it's built.
+
+struct TouchBarLinkFrame
+{
+  byte Type; // LinkState, LinkValue, LinkError or LinkInfo
+  byte Sequence;
+  byte Id;
+  byte Length;
+  byte Payload[LinkHostPayload];
+}; // <<< ; at the end is important!!!
+
+struct TouchBarLinkState // A LinkState frame taken apart. Only the fields set in Fields came with it, the rest are what they were in the frame before.
+{
+  byte Fields;
+  unsigned long Time; // micros() on the board when it was sent
+  unsigned long Position; // Either width, see LinkWide
+  unsigned long Target;
+  char Tap; // 'A', 'B' or 'C'
+  byte Gesture; // SingleTapGesture...
+  byte GesturePads;
+  unsigned int Skipped; // Frames the board couldn't send (TX buffer full)
+  unsigned int Broken; // Bad frames the board got
+}; // <<< ; at the end is important!!!
+
+class TouchBarLinkDecoder
+{
+  private:
+    byte In[LinkHostPayload + 7];
+    size_t InLength = 0;
+    TouchBarLinkFrame Frame;
+    TouchBarLinkState Latest = {};
+    unsigned long Frames = 0;
+    unsigned long BadFrames = 0;
+    unsigned long Lost = 0;
+    boolean Synced = false; // Got a frame, so the next sequence number is known
+    byte NextSequence = 0;
+
+    void Skip (size_t Bytes);
+    void Take ();
+
+  public:
+    // Receiving
+    boolean Feed (byte Data); // Give it every byte that comes in, returns true when a good frame is complete, GetFrame() has it then.
+    const TouchBarLinkFrame *GetFrame ();
+    boolean GetState (TouchBarLinkState *State); // If the frame is a LinkState, fills State in (with the latest of each field) and returns true.
+    boolean GetValue (byte *Config, byte *Field, unsigned long *Value, byte *CommandSequence); // If the frame is a LinkValue.
+    boolean GetError (byte *Config, byte *Field, byte *Error, byte *CommandSequence); // If the frame is a LinkError.
+    unsigned long GetFrames (); // Good frames so far
+    unsigned long GetBadFrames (); // Frames with a bad CRC or length
+    unsigned long GetLost (); // Frames missing, from the gaps in the sequence numbers
+
+    // Commands, each is written to Buffer (LinkMaxPayload + 7 bytes is enough for any), returns the number of bytes to send.
+    static size_t Hello (byte *Buffer, byte Id, byte Sequence);
+    static size_t Read (byte *Buffer, byte Id, byte Sequence, byte Config, byte Field);
+    static size_t Write (byte *Buffer, byte Id, byte Sequence, byte Config, byte Field, unsigned long Value);
+}; // <<< ; at the end is important!!!
+
+#endif
+
+#endif
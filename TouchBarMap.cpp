@@ -0,0 +1,119 @@
+#include "TouchBar.h"
+
+/*
+Output mapping
+GetPositionFloat() divides by 100 in floating point on every call, which on AVR pulls in the soft-float library (over a kB of flash) and takes hundreds of cycles. TouchBarMap does the same kind of job with integers:
+  The position is first scaled to 0 - 65536 with a factor worked out once in SetLimit(): Scale is 2^32 / Limit, and Position * Scale >> 16 takes it as Q16, so it's a multiply and a shift per call, no division.
+  Then, with a curve, that's looked up between the 2 nearest points of the curve and interpolated in a straight line (the points are evenly spread from 0 to Limit).
+  Then it's scaled onto OutputMin - OutputMax, rounded to the nearest.
+The curves live in flash, 2 bytes per point, 66 bytes for the ones here. The ones you don't use aren't linked in. 33 points follow these curves within 0.3% (a true log10(1 + 99x) would be 5% off near 0, it's too steep there, that's why the log curve here is the exp one turned around).
+In between it's all Q16 with 65536 = 1 (not 65535), so the output range comes out exact at both ends, even 0 - 65535.
+With TouchBarWide the Limit can take 32 bits, then the position is shifted down to 16 bits first (Shift), otherwise Scale would be too small to be exact (a Limit over 65536 leaves less then 16 bits of it).
+*/
+
+// Generated (65535 * f(x) for x = 0, 1/32 ... 1)
+const uint16_t TouchBarLogCurve[TouchBarCurvePoints] PROGMEM = // 1 - (100^(1 - x) - 1) / 99: rises fast, then levels off (the exp curve turned around)
+{
+  0, 8873, 16556, 23210, 28972, 33961, 38282, 42024, 45264, 48069, 50499,
+  52603, 54425, 56003, 57369, 58553, 59577, 60465, 61233, 61898, 62474, 62973,
+  63405, 63780, 64104, 64384, 64627, 64838, 65020, 65178, 65314, 65433, 65535
+};
+
+const uint16_t TouchBarExpCurve[TouchBarCurvePoints] PROGMEM = // (100^x - 1) / 99: the other way round, starts slow
+{
+  0, 102, 221, 357, 515, 697, 908, 1151, 1431, 1755, 2130,
+  2562, 3061, 3637, 4302, 5070, 5958, 6982, 8166, 9532, 11110, 12932,
+  15036, 17466, 20271, 23511, 27253, 31574, 36563, 42325, 48979, 56662, 65535
+};
+
+const uint16_t TouchBarGammaCurve[TouchBarCurvePoints] PROGMEM = // x^2.2: even looking LED brightness
+{
+  0, 32, 147, 359, 676, 1104, 1648, 2314, 3104, 4022, 5072,
+  6255, 7574, 9033, 10632, 12375, 14263, 16298, 18482, 20816, 23303, 25943,
+  28739, 31692, 34802, 38072, 41503, 45097, 48853, 52774, 56860, 61114, 65535
+};
+
+const uint16_t TouchBarSCurve[TouchBarCurvePoints] PROGMEM = // 3x^2 - 2x^3: slow at both ends
+{
+  0, 188, 736, 1620, 2816, 4300, 6048, 8036, 10240, 12636, 15200,
+  17908, 20736, 23660, 26656, 29700, 32768, 35835, 38879, 41875, 44799, 47627,
+  50335, 52899, 55295, 57499, 59487, 61235, 62719, 63915, 64799, 65347, 65535
+};
+
+
+
+/* General */
+TouchBarMap::TouchBarMap (TouchBarPosition InputLimit, unsigned int OutputMin, unsigned int OutputMax, const uint16_t *CurvePtr, byte CurvePoints)
+{
+  Min = OutputMin;
+  if (OutputMax < OutputMin)
+  {
+    Reverse = true;
+    Span = OutputMin - OutputMax;
+  }
+  else
+    Span = OutputMax - OutputMin;
+  Curve = CurvePtr;
+  if (CurvePoints < 2)
+    Curve = 0; // Takes 2 points at least, a straight line then.
+  Segments = CurvePoints - 1;
+  SetLimit (InputLimit);
+}
+
+void TouchBarMap::SetLimit (TouchBarPosition InputLimit)
+{
+  if (InputLimit == 0)
+    InputLimit = 1;
+  Limit = InputLimit;
+#ifdef TouchBarWide
+  Shift = 0;
+  while (InputLimit > 0xFFFF)
+  {
+    InputLimit >>= 1;
+    Shift += 1;
+  }
+#endif
+  Scale = 0xFFFFFFFFUL / InputLimit; // 2^32 / Limit, just under, so Position * Scale fits 32 bits as long as Position <= Limit.
+}
+
+
+
+/* Operation */
+unsigned int TouchBarMap::Map (TouchBarPosition Position)
+{
+  unsigned long X; // 0 to 65536
+#ifdef TouchBarWide
+  // Compared after the shift: with an odd Limit over 65535 Position >> Shift can come out the same as Limit >> Shift below the Limit, and Position * Scale + 0x8000 would reach 2^32 there.
+  Position >>= Shift;
+  if (Position >= Limit >> Shift)
+#else
+  if (Position >= Limit)
+#endif
+    X = 65536; // Scale is rounded down, the top has to come out exact.
+  else
+    X = ((unsigned long)Position * Scale + 0x8000) >> 16; // Still fits, Position < Limit (>> Shift) here.
+
+  if (Curve != 0)
+  {
+    unsigned long Point = X * Segments; // Which segment (high 16 bits) and how far along it (low 16 bits)
+    byte Index = Point >> 16;
+    unsigned int Along = Point & 0xFFFF;
+    unsigned int From = pgm_read_word (&Curve[Index]);
+    if (Index < Segments)
+    {
+      unsigned int To = pgm_read_word (&Curve[Index + 1]);
+      // Curves don't have to go up all the way, so the difference may be either way.
+      if (To >= From)
+        From += (unsigned long)(To - From) * Along >> 16;
+      else
+        From -= (unsigned long)(From - To) * Along >> 16;
+    }
+    X = From;
+    X += X >> 15; // 0 - 65535 -> 0 - 65536 (in a long, it doesn't fit 16 bits)
+  }
+
+  unsigned int Offset = (X * Span + 0x8000) >> 16;
+  if (Reverse)
+    return Min - Offset;
+  return Min + Offset;
+}
@@ -0,0 +1,151 @@
+#include "TouchBar.h"
+
+/*
+Ramp profiles (TouchBarConfig::RampProfile other then SteppedRamp, wall-clock mode only)
+Rather then moving Current a step on every update, a ramp is stored as where it started (RampFrom, RampStart), where it goes (RampTo) and how long it takes (RampDuration),
+and the position is worked out from the time when GetPositionInt() / GetPositionFloat() is called. Update() only checks if the ramp is over, or if the target moved.
+RampCounter bit 0 is set while ramping, bit 1 if the ramp started from standstill (eases in). When the target moves further the same way mid-ramp, the new ramp starts at full speed instead.
+All the math is 32 bit fixed point (Q15, 32768 = 1), no floats. With TouchBarWide the distance alone takes 32 bits, so the products are split up to fit (that's left out otherwise).
+Only compiled with TouchBarRampProfiles defined (see the top of TouchBar.h), without it every RampProfile ramps like SteppedRamp.
+*/
+
+#ifdef TouchBarRampProfiles
+
+// Top speed / average speed for each profile, eased in and not (as numerator, denominator), so the top speed is RampResolution per RampTime whichever profile it is.
+static const byte PeakNumerator[4][2] = {{1, 1}, {1, 1}, {8, 4}, {3, 3}};
+static const byte PeakDenominator[4][2] = {{1, 1}, {1, 1}, {7, 3}, {2, 2}};
+
+// Fraction of the distance covered (Q15) at fraction U of the time (Q15, 0 - 32767).
+static unsigned long RampShape (byte Profile, boolean EaseIn, unsigned long U)
+{
+  if (Profile == TrapezoidRamp)
+  {
+    if (EaseIn)
+    {
+      // Speeds up over the first quarter, cruises at 4/3 of the average speed, slows down over the last quarter.
+      if (U < 8192)
+        return (U * U >> 15) * 8 / 3;
+      if (U < 24576)
+        return 5461 + (U - 8192) * 4 / 3;
+      return 32768 - ((32768 - U) * (32768 - U) >> 15) * 8 / 3;
+    }
+    // Already at full speed (8/7 of the average), only slows down over the last quarter.
+    if (U < 24576)
+      return U * 8 / 7;
+    return 32768 - ((32768 - U) * (32768 - U) >> 15) * 16 / 7;
+  }
+  if (Profile == SCurveRamp)
+  {
+    if (EaseIn)
+    {
+      // 3u^2 - 2u^3
+      unsigned long U2 = U * U >> 15;
+      unsigned long U3 = U2 * U >> 15;
+      return 3 * U2 - 2 * U3;
+    }
+    // Second half of the same curve, stretched: (1 + u)^2 * (2 - u) / 2 - 1, starts at full speed.
+    unsigned long A = 32768 + U;
+    unsigned long A2 = A * A >> 15;
+    return ((A2 >> 1) * (65536 - U) >> 15) - 32768;
+  }
+  return U; // LinearRamp
+}
+
+
+
+boolean TouchBar::ProfileRamping ()
+{
+  return (RampCounter & 0x01) != 0 && Common->Clock != 0 && Config->RampProfile != SteppedRamp;
+}
+
+TouchBarPosition TouchBar::RampPosition (unsigned long Time)
+{
+  if ((RampCounter & 0x01) == 0)
+    return Current;
+  unsigned long Elapsed = Time - RampStart;
+  if (Elapsed >= RampDuration)
+    return RampTo;
+
+  // Scale both down until Elapsed << 15 fits in 32 bits.
+  unsigned long Duration = RampDuration;
+  while (Duration > 0xFFFF)
+  {
+    Duration >>= 1;
+    Elapsed >>= 1;
+  }
+  unsigned long Done = RampShape (Config->RampProfile, (RampCounter & 0x02) != 0, (Elapsed << 15) / Duration);
+
+#ifdef TouchBarWide
+  // Distance * Done >> 15, the top and the bottom 15 bits of the distance on their own.
+  if (RampTo > RampFrom)
+    return RampFrom + ((RampTo - RampFrom) >> 15) * Done + (((RampTo - RampFrom) & 0x7FFF) * Done >> 15);
+  return RampFrom - ((RampFrom - RampTo) >> 15) * Done - (((RampFrom - RampTo) & 0x7FFF) * Done >> 15);
+#else
+  if (RampTo > RampFrom)
+    return RampFrom + ((RampTo - RampFrom) * Done >> 15);
+  return RampFrom - ((RampFrom - RampTo) * Done >> 15);
+#endif
+}
+
+void TouchBar::StartRamp (boolean Moving)
+{
+  RampFrom = Current;
+  RampTo = Target;
+  RampStart = Now;
+  if (Current == Target)
+  {
+    RampCounter = 0;
+    return;
+  }
+
+  byte Profile = Config->RampProfile & 0x03;
+  byte Shape = Moving ? 0 : 1;
+  unsigned long Distance = Current < Target ? Target - Current : Current - Target;
+  unsigned long PerStep = (unsigned long) PeakDenominator[Profile][Shape] * Config->RampResolution;
+#ifdef TouchBarWide
+  // Distance * PeakNumerator could overflow, so the whole PerSteps go first. What's left over is less then PerStep, that fits.
+  unsigned long Steps = Distance / PerStep;
+  if (Steps >= 0xFFFFFFFF / 8)
+    Steps = 0xFFFFFFFF; // Longer then the RampDuration can be anyway.
+  else
+    Steps = Steps * PeakNumerator[Profile][Shape] + (Distance % PerStep * PeakNumerator[Profile][Shape] + PerStep - 1) / PerStep;
+#else
+  unsigned long Steps = Distance * PeakNumerator[Profile][Shape];
+  Steps = (Steps + PerStep - 1) / PerStep; // Number of RampTime periods it takes at the average speed, rounded up.
+#endif
+  if (Config->RampTime != 0 && Steps > 0xFFFFFFFF / Config->RampTime)
+    RampDuration = 0xFFFFFFFF;
+  else
+    RampDuration = Steps * Config->RampTime;
+
+  if (RampDuration == 0)
+  {
+    Current = Target;
+    RampCounter = 0;
+  }
+  else
+  {
+    RampCounter = Moving ? 0x01 : 0x03;
+#ifdef TouchBarInstrumentation
+    Counters.RampSteps += 1;
+#endif
+  }
+}
+
+void TouchBar::ProfileRamp ()
+{
+  if (Target != RampTo || (RampCounter & 0x01) == 0 && Current != Target)
+  {
+    // New target (or SetPosition() stopped the ramp), a new ramp starts from wherever it is right now.
+    TouchBarPosition Position = RampPosition (Now);
+    boolean Moving = (RampCounter & 0x01) != 0 && Position != RampTo && (RampTo > RampFrom) == (Target > Position);
+    Current = Position;
+    StartRamp (Moving);
+  }
+  else if ((RampCounter & 0x01) != 0 && Now - RampStart >= RampDuration)
+  {
+    Current = Target;
+    RampCounter = 0;
+  }
+}
+#endif
@@ -0,0 +1,98 @@
+#include "TouchBar.h"
+
+/*
+Trace recorder
+The pads hardly ever change from one sample to the next, so rather then every sample, a run of identical samples is written once:
+  Header: 'T', 'B', 'T', 1 (version), written before the first run.
+  Each run: Pads | (Length & 0x0F) << 3 | More << 7, then if More: the rest of Length (Length >> 4) as a varint, then Delta as a varint.
+  Length is the number of samples in the run, Delta is the time (us, micros()) from the first sample of the run before to the first sample of this one. (For the first run it's micros() itself.)
+  Varint: 7 bits at a time, lowest first, bit 7 set on every byte but the last.
+A run is written when the pads change (or on Flush()), that's 2-4 bytes for anything from 1 to 65535 samples. micros() is only read then, not on every sample.
+The replay spreads the samples of each run evenly over the time until the next run, which is exactly how they came if Update() is called at a steady rate.
+*/
+
+#define TraceMaxRun 65535 // A run is cut after this many samples, so the Delta of a very long one can't roll over micros(). (Unless Update() is called less then every 65 ms.)
+
+
+
+/* General */
+TouchBarRecorder::TouchBarRecorder (void (*OutputFunction) (byte Data))
+{
+  Output = OutputFunction;
+}
+
+
+
+/* Output */
+void TouchBarRecorder::Put (byte Data)
+{
+  Output (Data);
+  Bytes += 1;
+}
+
+void TouchBarRecorder::Emit () // Writes the run in progress.
+{
+  if (Started == false)
+  {
+    Put ('T');
+    Put ('B');
+    Put ('T');
+    Put (1);
+    Started = true;
+  }
+
+  unsigned long Value = RunLength >> 4;
+  Put (RunPads | (RunLength & 0x0F) << 3 | (Value != 0 ? 0x80 : 0));
+  while (Value != 0)
+  {
+    Put ((Value & 0x7F) | (Value > 0x7F ? 0x80 : 0));
+    Value >>= 7;
+  }
+
+  Value = RunStart - PreviousStart;
+  while (Value > 0x7F)
+  {
+    Put ((Value & 0x7F) | 0x80);
+    Value >>= 7;
+  }
+  Put (Value);
+
+  PreviousStart = RunStart;
+  RunLength = 0;
+}
+
+
+
+/* Operation */
+void TouchBarRecorder::Record (byte Pads)
+{
+  Samples += 1;
+  if (RunLength != 0 && Pads == RunPads && RunLength < TraceMaxRun)
+  {
+    RunLength += 1;
+    return;
+  }
+
+  unsigned long Now = micros ();
+  if (RunLength != 0)
+    Emit ();
+  RunPads = Pads & 0x07;
+  RunStart = Now;
+  RunLength = 1;
+}
+
+void TouchBarRecorder::Flush ()
+{
+  if (RunLength != 0)
+    Emit ();
+}
+
+unsigned long TouchBarRecorder::GetBytes ()
+{
+  return Bytes;
+}
+
+unsigned long TouchBarRecorder::GetSamples ()
+{
+  return Samples;
+}
@@ -0,0 +1,157 @@
+#ifndef ARDUINO
+
+#include "TouchBarSimulator.h"
+
+// Pad states of a swipe in the Up (increment) direction, all starting from pad A. The stripes repeat A, B, C, A, B, C... along the bar, so these cycles can go on forever.
+// Down is the same cycle walked backwards (A, AC, C, BC...), except for the hard swipe.
+static const byte LightCycle[6] = {1, 3, 2, 6, 4, 5};
+static const byte HardCycle[6] = {3, 7, 6, 7, 5, 7};
+static const byte SkipCycle[3] = {1, 2, 4};
+
+
+
+/* General */
+TouchBarSimulator::TouchBarSimulator (unsigned long SamplePeriodUs)
+{
+  SamplePeriod = SamplePeriodUs;
+}
+
+
+
+/* Script */
+void TouchBarSimulator::Clear ()
+{
+  Script.clear ();
+  Rewind ();
+}
+
+void TouchBarSimulator::Hold (byte Pads, unsigned long Duration)
+{
+  if (Duration == 0)
+    return;
+  Pads &= 0x07;
+  if (!Script.empty () && Script.back().Pads == Pads)
+    Script.back().Duration += Duration;
+  else
+    Script.push_back ({Pads, Duration});
+}
+
+void TouchBarSimulator::Idle (unsigned long Duration)
+{
+  Hold (0, Duration);
+}
+
+void TouchBarSimulator::Tap (char Pad, unsigned long Duration)
+{
+  Hold (1 << (Pad - 'A'), Duration);
+  Idle (SamplePeriod);
+}
+
+void TouchBarSimulator::Sequence (const byte *Cycle, byte Length, boolean Up, byte Transitions, unsigned long StepTime)
+{
+  byte i = 0;
+  for (int Step = 0; Step <= Transitions; Step++)
+  {
+    Hold (Cycle[i], StepTime);
+    if (Up)
+      i = (i + 1) % Length;
+    else
+      i = (i + Length - 1) % Length;
+  }
+}
+
+void TouchBarSimulator::LightSwipe (boolean Up, byte Transitions, unsigned long StepTime)
+{
+  Sequence (LightCycle, 6, Up, Transitions, StepTime);
+}
+
+void TouchBarSimulator::HardSwipe (boolean Up, byte Transitions, unsigned long StepTime)
+{
+  // The finger lands on the first pad and spreads over the second before it's pushed hard enough to cover 3.
+  if (Up)
+  {
+    Hold (1, StepTime);
+    Sequence (HardCycle, 6, true, Transitions, StepTime);
+  }
+  else
+  {
+    // Walking HardCycle backwards doesn't work here, the pad that is released in between has to be the trailing one, so it's HardCycle with A and C swapped.
+    static const byte HardCycleDown[6] = {6, 7, 3, 7, 5, 7};
+    Hold (4, StepTime);
+    Sequence (HardCycleDown, 6, true, Transitions, StepTime);
+  }
+}
+
+void TouchBarSimulator::SkipSwipe (boolean Up, byte Transitions, unsigned long StepTime)
+{
+  Sequence (SkipCycle, 3, Up, Transitions, StepTime);
+}
+
+void TouchBarSimulator::Twitch (byte HeldPads, char Pad, byte Count, unsigned long Period)
+{
+  byte Edge = 1 << (Pad - 'A');
+  for (byte i = 0; i < Count; i++)
+  {
+    Hold (HeldPads | Edge, Period / 2);
+    Hold (HeldPads & ~Edge, Period - Period / 2);
+  }
+}
+
+
+
+/* Playback */
+void TouchBarSimulator::Rewind ()
+{
+  Position = 0;
+  Elapsed = 0;
+}
+
+boolean TouchBarSimulator::Next (byte *Sample)
+{
+  while (Position < Script.size () && Elapsed >= Script[Position].Duration)
+  {
+    Elapsed -= Script[Position].Duration;
+    Position += 1;
+  }
+  if (Position >= Script.size ())
+    return false;
+
+  *Sample = Script[Position].Pads;
+  Elapsed += SamplePeriod;
+  AdvanceVirtualMicros (SamplePeriod);
+  return true;
+}
+
+unsigned long TouchBarSimulator::Samples ()
+{
+  unsigned long Total = 0;
+  unsigned long Carry = 0;
+  for (size_t i = 0; i < Script.size (); i++)
+  {
+    // Same stepping as Next(): a segment gets every sample that starts within it.
+    unsigned long Duration = Script[i].Duration;
+    if (Carry >= Duration)
+    {
+      Carry -= Duration;
+      continue;
+    }
+    unsigned long Count = (Duration - Carry + SamplePeriod - 1) / SamplePeriod;
+    Total += Count;
+    Carry = Carry + Count * SamplePeriod - Duration;
+  }
+  return Total;
+}
+
+unsigned long TouchBarSimulator::Run (TouchBar *TB)
+{
+  unsigned long Count = 0;
+  byte Sample;
+  while (Next (&Sample))
+  {
+    TB->Update (Sample);
+    Count += 1;
+  }
+  return Count;
+}
+
+#endif
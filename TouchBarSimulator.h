@@ -0,0 +1,51 @@
+#ifndef TouchBarSimulator_H
+#define TouchBarSimulator_H
+
+// Host only! Turns scripted finger motion into the 3 bit sample stream TouchBar::Update(byte) takes, so the engine can be profiled and regression tested without a board.
+// Each sample also advances the virtual clock by SamplePeriod, so micros()/millis() based timing sees the same time as the script.
+
+#ifndef ARDUINO
+
+#include "TouchBar.h"
+#include <vector>
+
+class TouchBarSimulator
+{
+  private:
+    struct Segment
+    {
+      byte Pads;
+      unsigned long Duration;
+    };
+    std::vector<Segment> Script;
+    size_t Position = 0;
+    unsigned long Elapsed = 0;
+
+    void Sequence (const byte *Cycle, byte Length, boolean Up, byte Transitions, unsigned long StepTime);
+
+  public:
+    unsigned long SamplePeriod; // us between 2 samples (how often Update() would be called on the board)
+
+    // Constructor
+    TouchBarSimulator (unsigned long SamplePeriodUs = 100);
+
+    // Script (all durations are in us)
+    void Clear ();
+    void Hold (byte Pads, unsigned long Duration); // Any pad combination. BiTB: 0(LSB) = PadA; 1 = PadB; 2 = PadC;
+    void Idle (unsigned long Duration); // Nothing touched.
+    void Tap (char Pad, unsigned long Duration); // 'A', 'B' or 'C' touched for Duration, then released.
+    void LightSwipe (boolean Up, byte Transitions, unsigned long StepTime); // Touching 1-2 pads at a time: A, AB, B, BC, C, CA, A...
+    void HardSwipe (boolean Up, byte Transitions, unsigned long StepTime); // Pushing hard, touching 2-3 pads at a time: AB, ABC, BC, ABC, AC, ABC...
+    void SkipSwipe (boolean Up, byte Transitions, unsigned long StepTime); // Swiping so fast that every other state is missed: A, B, C, A...
+    void Twitch (byte HeldPads, char Pad, byte Count, unsigned long Period); // Barely touching the edge of a pad: Pad flickers Count times on top of HeldPads.
+
+    // Playback
+    void Rewind ();
+    boolean Next (byte *Sample); // Returns false when the script is over.
+    unsigned long Samples (); // Total number of samples in the script.
+    unsigned long Run (TouchBar *TB); // Feeds the whole script to TB, returns the number of samples.
+}; // <<< ; at the end is important!!!
+
+#endif
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef ARDUINO
+
+#include "TouchBarSliced.h"
+
+TouchBarSliced::Rule TouchBarSliced::LightRules[24];
+TouchBarSliced::Rule TouchBarSliced::HardRules[24];
+byte TouchBarSliced::LightCount = 0;
+byte TouchBarSliced::HardCount = 0;
+
+// Mask of the bars whose 3 bit state in Planes equals Value.
+static inline uint64_t Equals (const uint64_t *Planes, byte Value)
+{
+  return (Value & 0x01 ? Planes[0] : ~Planes[0]) & (Value & 0x02 ? Planes[1] : ~Planes[1]) & (Value & 0x04 ? Planes[2] : ~Planes[2]);
+}
+
+
+
+/* General */
+TouchBarSliced::TouchBarSliced (TouchBarCommon *CommonPtr)
+{
+  Common = CommonPtr;
+  IncrementMask = 0;
+  Increment2Mask = 0;
+  DecrementMask = 0;
+  Decrement2Mask = 0;
+  if (LightCount == 0)
+    BuildRules ();
+}
+
+void TouchBarSliced::BuildRules ()
+{
+  // The rules are read from the same table TouchBar::GetDirection() uses, so they can't get out of step with it.
+  // If the direction of a current / previous state pair doesn't depend on the older history it's a light touch rule, otherwise every history with a direction is a hard touch rule.
+  for (int Pair = 0; Pair < 64; Pair++)
+  {
+    byte Direction = pgm_read_byte (&TouchBarDirectionTable[Pair]);
+    boolean Light = true;
+    for (int History = 1; History < 64; History++)
+      if (pgm_read_byte (&TouchBarDirectionTable[History << 6 | Pair]) != Direction)
+        Light = false;
+
+    for (int History = 0; History < 64; History++)
+    {
+      Direction = pgm_read_byte (&TouchBarDirectionTable[History << 6 | Pair]);
+      if (Direction == Static)
+        continue;
+      byte Slot = Direction == Decrement2 ? 0 : Direction == Decrement ? 1 : Direction == Increment ? 2 : 3;
+      Rule NewRule = {(byte) (Pair & 0x07), {(byte) (Pair >> 3), (byte) (History & 0x07), (byte) (History >> 3)}, Slot};
+      if (Light)
+      {
+        LightRules[LightCount++] = NewRule;
+        break;
+      }
+      HardRules[HardCount++] = NewRule;
+    }
+  }
+}
+
+void TouchBarSliced::SetFlip (uint64_t FlipMask)
+{
+  Flip = FlipMask;
+}
+
+
+
+/* Operation */
+void TouchBarSliced::Update (uint64_t A, uint64_t B, uint64_t C)
+{
+  uint64_t NewValue[3] = {A, B, C};
+  Shift ();
+  TwitchSuppression (NewValue);
+  GetDirection ();
+}
+
+void TouchBarSliced::Update (const byte *Samples, byte Count)
+{
+  uint64_t Planes[3] = {0, 0, 0};
+  for (byte Bar = 0; Bar < Count && Bar < 64; Bar++)
+  {
+    Planes[0] |= (uint64_t) (Samples[Bar] & 0x01) << Bar;
+    Planes[1] |= (uint64_t) (Samples[Bar] >> 1 & 0x01) << Bar;
+    Planes[2] |= (uint64_t) (Samples[Bar] >> 2 & 0x01) << Bar;
+  }
+  Update (Planes[0], Planes[1], Planes[2]);
+}
+
+void TouchBarSliced::Shift ()
+{
+  // Same as TouchBar::Shift(), only for the bars whose pads differ from the previous state.
+  uint64_t Changed = (ABCPads[0] ^ ABCPrevious[0][0]) | (ABCPads[1] ^ ABCPrevious[0][1]) | (ABCPads[2] ^ ABCPrevious[0][2]);
+  for (byte i = 0; i < 3; i++)
+  {
+    ABCPrevious[2][i] = (ABCPrevious[2][i] & ~Changed) | (ABCPrevious[1][i] & Changed);
+    ABCPrevious[1][i] = (ABCPrevious[1][i] & ~Changed) | (ABCPrevious[0][i] & Changed);
+    ABCPrevious[0][i] = (ABCPrevious[0][i] & ~Changed) | (ABCPads[i] & Changed);
+  }
+}
+
+void TouchBarSliced::TwitchSuppression (const uint64_t *NewValue)
+{
+  // Saturating increment of every counter that isn't at 255 yet, rippling the carry through the planes.
+  uint64_t Carry = ~(TSCounter[0] & TSCounter[1] & TSCounter[2] & TSCounter[3] & TSCounter[4] & TSCounter[5] & TSCounter[6] & TSCounter[7]);
+  for (byte k = 0; k < 8 && Carry != 0; k++)
+  {
+    uint64_t Next = TSCounter[k] & Carry;
+    TSCounter[k] ^= Carry;
+    Carry = Next;
+  }
+
+  uint64_t RawChanged = (NewValue[0] ^ Raw[0]) | (NewValue[1] ^ Raw[1]) | (NewValue[2] ^ Raw[2]);
+  uint64_t Settled = ~(uint64_t) 0;
+  for (byte k = 0; k < 8; k++)
+  {
+    TSCounter[k] &= ~RawChanged;
+    Settled &= bitRead (Common->TwitchSuppressionDelay, k) ? TSCounter[k] : ~TSCounter[k];
+  }
+
+  uint64_t Different = (NewValue[0] ^ ABCPads[0]) | (NewValue[1] ^ ABCPads[1]) | (NewValue[2] ^ ABCPads[2]);
+  uint64_t BothTouched = (NewValue[0] | NewValue[1] | NewValue[2]) & (ABCPads[0] | ABCPads[1] | ABCPads[2]);
+  uint64_t Take = Different & (BothTouched | Settled);
+  for (byte i = 0; i < 3; i++)
+  {
+    ABCPads[i] = (ABCPads[i] & ~Take) | (NewValue[i] & Take);
+    Raw[i] = NewValue[i];
+  }
+}
+
+void TouchBarSliced::GetDirection ()
+{
+  uint64_t Untouched = ~(ABCPads[0] | ABCPads[1] | ABCPads[2]);
+  uint64_t Pads[8];
+  uint64_t Previous[3][8];
+  for (byte Value = 0; Value < 8; Value++)
+  {
+    Pads[Value] = Equals (ABCPads, Value);
+    Previous[0][Value] = Equals (ABCPrevious[0], Value);
+    Previous[1][Value] = Equals (ABCPrevious[1], Value);
+    Previous[2][Value] = Equals (ABCPrevious[2], Value);
+  }
+
+  uint64_t Found[4] = {0, 0, 0, 0}; // Decrement2, Decrement, Increment, Increment2
+  for (byte i = 0; i < LightCount; i++)
+    Found[LightRules[i].Slot] |= Pads[LightRules[i].Pads] & Previous[0][LightRules[i].Previous[0]];
+  for (byte i = 0; i < HardCount; i++)
+    Found[HardRules[i].Slot] |= Pads[HardRules[i].Pads] & Previous[0][HardRules[i].Previous[0]] & Previous[1][HardRules[i].Previous[1]] & Previous[2][HardRules[i].Previous[2]];
+
+  // Flipped bars go the other way.
+  IncrementMask = (Found[2] & ~Flip) | (Found[1] & Flip);
+  Increment2Mask = (Found[3] & ~Flip) | (Found[0] & Flip);
+  DecrementMask = (Found[1] & ~Flip) | (Found[2] & Flip);
+  Decrement2Mask = (Found[0] & ~Flip) | (Found[3] & Flip);
+
+  // Same as TouchBar::GetDirection(), the older history is forgotten when the pads are left untouched.
+  for (byte i = 0; i < 3; i++)
+  {
+    ABCPrevious[1][i] &= ~Untouched;
+    ABCPrevious[2][i] &= ~Untouched;
+  }
+}
+
+byte TouchBarSliced::GetDirection (byte Bar)
+{
+  uint64_t Bit = (uint64_t) 1 << Bar;
+  if (IncrementMask & Bit)
+    return Increment;
+  if (Increment2Mask & Bit)
+    return Increment2;
+  if (DecrementMask & Bit)
+    return Decrement;
+  if (Decrement2Mask & Bit)
+    return Decrement2;
+  return Static;
+}
+
+byte TouchBarSliced::GetPads (byte Bar)
+{
+  return (ABCPads[0] >> Bar & 0x01) | (ABCPads[1] >> Bar & 0x01) << 1 | (ABCPads[2] >> Bar & 0x01) << 2;
+}
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef TouchBarSliced_H
+#define TouchBarSliced_H
+
+// Host only! Runs the Shift() / TwitchSuppression() / GetDirection() part of TouchBar for 64 bars at once, one bar per bit of a uint64_t (bit-slicing).
+// Pads A, B and C of all 64 bars come in as 3 separate words, and the directions come out as 4 masks, so a single pass of bitwise operations does the work of 64 Update() calls.
+// Meant for replaying recorded pad streams of many panels, the results match TouchBar bit for bit (extras/SlicedCheck checks that). Cycle counted TwitchSuppressionDelay only, wall-clock mode isn't supported.
+
+#ifndef ARDUINO
+
+#include "TouchBar.h"
+
+class TouchBarSliced
+{
+  private:
+    struct Rule
+    {
+      byte Pads;
+      byte Previous[3];
+      byte Slot; // 0 = Decrement2, 1 = Decrement, 2 = Increment, 3 = Increment2
+    };
+    static Rule LightRules[24]; // Directions that only depend on the current and the previous state (light touch)
+    static Rule HardRules[24]; // Directions that depend on the whole history (hard touch)
+    static byte LightCount;
+    static byte HardCount;
+    static void BuildRules ();
+
+    TouchBarCommon *Common;
+    uint64_t Flip = 0;
+    // Bit planes, [0] = pad A, [1] = pad B, [2] = pad C
+    uint64_t ABCPads[3] = {0, 0, 0};
+    uint64_t ABCPrevious[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+    uint64_t Raw[3] = {0, 0, 0};
+    uint64_t TSCounter[8] = {0, 0, 0, 0, 0, 0, 0, 0}; // Vertical counter, TSCounter[0] is the LSB of every bar's counter
+
+    void Shift ();
+    void TwitchSuppression (const uint64_t *NewValue);
+    void GetDirection ();
+
+  public:
+    // Direction masks after Update(), a bar with none of its bits set is Static.
+    uint64_t IncrementMask;
+    uint64_t Increment2Mask;
+    uint64_t DecrementMask;
+    uint64_t Decrement2Mask;
+
+    // Constructor
+    TouchBarSliced (TouchBarCommon *CommonPtr);
+
+    // Control Methods
+    void SetFlip (uint64_t FlipMask); // Bars with their bit set behave as if their TouchBarConfig had the Flip flag set.
+
+    // Operation
+    void Update (uint64_t A, uint64_t B, uint64_t C); // One sample for each of the 64 bars, as pad planes.
+    void Update (const byte *Samples, byte Count = 64); // One sample for each bar the way TouchBar::Update(byte) takes it, bars from Count up are left untouched.
+    byte GetDirection (byte Bar); // Returns Decrement2, Decrement, Static, Increment or Increment2 for a single bar, the same as TouchBar works it out.
+    byte GetPads (byte Bar); // Returns the debounced pad state of a single bar.
+}; // <<< ; at the end is important!!!
+
+#endif
+
+#endif
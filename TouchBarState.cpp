@@ -0,0 +1,181 @@
+#include "TouchBar.h"
+#ifdef ARDUINO
+  #include <EEPROM.h>
+#endif
+
+/*
+Warm restart
+Snapshot() packs what a TouchBar needs to carry on (position, target, ramp counter, direction, pad history) into a TouchBarSnapshot, Restore() puts it back after a reset.
+Keep the snapshot wherever survives your resets: RTC memory (ESP8266 system_rtc_mem_write()), a .noinit variable on AVR (survives the watchdog and brownout resets, not a power cycle), or EEPROM with SaveTouchBarState().
+In wall-clock mode the time doesn't survive the reset, so a ramp in progress starts over from where it was (with a RampProfile it eases in again), the position doesn't jump either way.
+No tap is reported for a pad that was held during the reset and released after it.
+*/
+
+static byte SnapshotCheck (const TouchBarSnapshot *State) // CRC-8 of the fields (not the padding, it's not the same on every board)
+{
+#ifdef TouchBarWide
+  byte Data[17] = {(byte)(State->Current >> 24), (byte)(State->Current >> 16), (byte)(State->Current >> 8), (byte)State->Current, (byte)(State->Target >> 24), (byte)(State->Target >> 16), (byte)(State->Target >> 8), (byte)State->Target,
+                   (byte)(State->RampCounter >> 8), (byte)State->RampCounter, State->Direction, State->ABCPads, State->ABCPrevious[0], State->ABCPrevious[1], State->ABCPrevious[2], State->TSCounter, State->Generation};
+#else
+  byte Data[13] = {(byte)(State->Current >> 8), (byte)State->Current, (byte)(State->Target >> 8), (byte)State->Target, (byte)(State->RampCounter >> 8), (byte)State->RampCounter,
+                   State->Direction, State->ABCPads, State->ABCPrevious[0], State->ABCPrevious[1], State->ABCPrevious[2], State->TSCounter, State->Generation};
+#endif
+  byte Crc = 0x5A;
+  for (byte i = 0; i < sizeof(Data); i++)
+  {
+    Crc ^= Data[i];
+    for (byte j = 0; j < 8; j++)
+      if (Crc & 0x80)
+        Crc = (Crc << 1) ^ 0x07;
+      else
+        Crc <<= 1;
+  }
+  return Crc;
+}
+
+
+
+/* TouchBar */
+void TouchBar::Snapshot (TouchBarSnapshot *State)
+{
+  State->Current = GetPositionInt (); // Where a RampProfile is right now
+  State->Target = Target;
+  if (Common->Clock == 0)
+    State->RampCounter = RampCounter;
+  else
+    State->RampCounter = 0; // Means something only along with the time it started.
+  State->Direction = Direction;
+  State->ABCPads = Steady << 7 | Raw << 3 | ABCPads; // The raw input goes along, so the twitch suppression carries on too.
+  State->TSCounter = TSCounter;
+  State->ABCPrevious[0] = ABCPrevious[0];
+  State->ABCPrevious[1] = ABCPrevious[1];
+  State->ABCPrevious[2] = ABCPrevious[2];
+  State->Generation += 1;
+  State->Check = SnapshotCheck (State);
+}
+
+boolean TouchBar::Restore (const TouchBarSnapshot *State)
+{
+  if (State->Check != SnapshotCheck (State) || State->Current > Config->Limit || State->Target > Config->Limit || (State->ABCPads & 0x40) != 0
+      || State->ABCPrevious[0] > 7 || State->ABCPrevious[1] > 7 || State->ABCPrevious[2] > 7)
+    return false;
+
+  Current = State->Current;
+  Previous = Current;
+  Target = State->Target;
+#ifdef TouchBarRampProfiles
+  RampTo = Target;
+  RampFrom = Current;
+#endif
+  RampCounter = 0;
+  if (Common->Clock == 0 && Config->RampDelay != 0)
+    RampCounter = State->RampCounter % Config->RampDelay;
+  Direction = State->Direction;
+  ABCPads = State->ABCPads & 0x07;
+  Raw = State->ABCPads >> 3 & 0x07;
+  TSCounter = State->TSCounter;
+#ifdef TouchBarDebouncer
+  for (byte k = 0; k < DebounceBits; k++)
+    DebounceCounter[k] = 0; // Not in the snapshot, the per-pad debouncer starts counting over.
+#endif
+  ABCPrevious[0] = State->ABCPrevious[0];
+  ABCPrevious[1] = State->ABCPrevious[1];
+  ABCPrevious[2] = State->ABCPrevious[2];
+  // A pad held since before the reset is not a tap.
+  if (Common->Clock == 0)
+    TapCounter = Common->TapTimeout;
+  else
+    TapCounter = 1;
+#ifdef TouchBarSwipeSpeed
+  FlingVelocity = 0;
+  Velocity = 0;
+#endif
+#ifdef TouchBarGestures
+  GestureState = 0; // Not in the snapshot either, a gesture half way through is dropped.
+  GesturePads = 0;
+  Gesture = NoGesture;
+#endif
+  Steady = State->ABCPads >> 7;
+  return true;
+}
+
+
+
+/* EEPROM */
+// Two copies of each bar's snapshot, Save writes over the older one, so a write cut short leaves the other one to load.
+static unsigned int SnapshotAddress (byte Copy, byte Bar, byte Count, unsigned int EEPROMAddress)
+{
+  return EEPROMAddress + (Copy * Count + Bar) * sizeof(TouchBarSnapshot);
+}
+
+static void ReadSnapshot (TouchBarSnapshot *State, unsigned int Address)
+{
+  byte *Data = (byte *)State;
+  for (byte i = 0; i < sizeof(TouchBarSnapshot); i++)
+    Data[i] = EEPROM.read (Address + i);
+}
+
+static signed char NewestSnapshot (TouchBarSnapshot *States) // Of 2, -1 if neither is good.
+{
+  boolean Good[2];
+  for (byte i = 0; i < 2; i++)
+    Good[i] = States[i].Check == SnapshotCheck (&States[i]);
+  if (Good[0] && Good[1])
+    return (signed char)(States[1].Generation - States[0].Generation) > 0 ? 1 : 0;
+  if (Good[0])
+    return 0;
+  if (Good[1])
+    return 1;
+  return -1;
+}
+
+boolean SaveTouchBarState (TouchBar *Bars, byte Count, unsigned int EEPROMAddress)
+{
+  boolean Written = false;
+  for (byte Bar = 0; Bar < Count; Bar++)
+  {
+    TouchBarSnapshot States[2];
+    ReadSnapshot (&States[0], SnapshotAddress (0, Bar, Count, EEPROMAddress));
+    ReadSnapshot (&States[1], SnapshotAddress (1, Bar, Count, EEPROMAddress));
+    signed char Newest = NewestSnapshot (States);
+
+    TouchBarSnapshot State = {0, 0, 0, Static, 0, {0, 0, 0}, 0, 0, 0};
+    if (Newest >= 0)
+      State = States[(byte)Newest];
+    Bars[Bar].Snapshot (&State);
+
+    if (Newest >= 0)
+    {
+      TouchBarSnapshot *Old = &States[(byte)Newest];
+      if (State.Current == Old->Current && State.Target == Old->Target && State.RampCounter == Old->RampCounter && State.Direction == Old->Direction && State.ABCPads == Old->ABCPads && State.TSCounter == Old->TSCounter
+          && State.ABCPrevious[0] == Old->ABCPrevious[0] && State.ABCPrevious[1] == Old->ABCPrevious[1] && State.ABCPrevious[2] == Old->ABCPrevious[2])
+        continue; // Nothing changed, nothing to write.
+    }
+
+    unsigned int Address = SnapshotAddress (Newest == 0 ? 1 : 0, Bar, Count, EEPROMAddress);
+    byte *Data = (byte *)&State;
+    for (byte i = 0; i < sizeof(TouchBarSnapshot); i++)
+      UpdateEEPROM (Address + i, Data[i]);
+    Written = true;
+  }
+#if defined(ESP8266) || defined(ESP32) || !defined(ARDUINO)
+  if (Written)
+    EEPROM.commit ();
+#endif
+  return Written;
+}
+
+byte LoadTouchBarState (TouchBar *Bars, byte Count, unsigned int EEPROMAddress)
+{
+  byte Restored = 0;
+  for (byte Bar = 0; Bar < Count; Bar++)
+  {
+    TouchBarSnapshot States[2];
+    ReadSnapshot (&States[0], SnapshotAddress (0, Bar, Count, EEPROMAddress));
+    ReadSnapshot (&States[1], SnapshotAddress (1, Bar, Count, EEPROMAddress));
+    signed char Newest = NewestSnapshot (States);
+    if (Newest >= 0 && Bars[Bar].Restore (&States[(byte)Newest]))
+      Restored += 1;
+  }
+  return Restored;
+}
@@ -0,0 +1,296 @@
+#include "TouchBar.h"
+#ifdef ARDUINO
+  #include <EEPROM.h>
+#endif
+
+/*
+Settings store
+Unlike SaveTouchBarConfig() / LoadTouchBarConfig() the layout doesn't depend on how the compiler lays out the objects, every field is written byte by byte (MSB first), and the record is checked before it's used:
+  Magic (1), Version (1), Sequence (2), ConfigCount (1),
+  Common: TapTimeout (2), TwitchSuppressionDelay (1), TapTime (4), TwitchSuppressionTime (4), DebounceDelay (2),
+  each Config: Default (2), Limit (2), Resolution (1), RampDelay (1), RampResolution (1), Flags (1), RampTime (4), RampProfile (1), AccelerationSpeed (2), AccelerationLimit (1), FlingTime (4), FlingSpeed (2), Gestures (1), MultiTapTime (4), LongPressTime (4),
+  CRC-16 (2) of everything before it.
+With TouchBarWide Default and Limit take 4 bytes, Resolution and RampResolution 2, and the Magic is 'W', so a record saved by the other build is never loaded.
+Every save goes to the next slot with the next sequence number, Load() picks the newest slot that checks out. A save cut short by a reset or power loss fails the CRC, so the one before it is loaded.
+Add a field? Add it to Record() and Load() and bump StoreVersion, records of the old version are then ignored (Load() returns false) rather then read wrong.
+On AVR each slot takes its share of the EEPROM wear. On ESP8266 every EEPROM.commit() erases the whole flash sector anyway, there the saving comes from writing only after the settings stopped changing, and not at all if nothing changed.
+*/
+
+#ifdef TouchBarWide
+  #define StoreMagic 0x57 // 'W'
+#else
+  #define StoreMagic 0x54 // 'T'
+#endif
+#define StoreVersion 3 // 2: DebounceDelay, 3: Gestures, MultiTapTime, LongPressTime
+#define StoreHeader 5
+#define StoreCommon 13
+#define StoreConfig (25 + 2 * TouchBarPositionBytes + 2 * TouchBarStepBytes)
+
+// The positions and steps in as many bytes as they take. (With a cast, TouchBarPosition is unsigned long on one board and unsigned int on another, and the Put() that takes it has to write the same bytes on both.)
+#ifdef TouchBarWide
+  #define PutPosition(Data) Put ((unsigned long)(Data))
+  #define GetPosition() GetLong ()
+  #define PutStep(Data) Put ((unsigned int)(Data))
+  #define GetStep() GetInt ()
+#else
+  #define PutPosition(Data) Put ((unsigned int)(Data))
+  #define GetPosition() GetInt ()
+  #define PutStep(Data) Put ((byte)(Data))
+  #define GetStep() GetByte ()
+#endif
+
+// Record() modes
+#define StoreWrite 0
+#define StoreCompare 1
+
+#if defined(ESP8266) || defined(ESP32) || !defined(ARDUINO)
+  #define StoreNeedsCommit // EEPROM is emulated in flash, changes only stick after EEPROM.commit().
+#endif
+
+static unsigned int StoreCrc (unsigned int Crc, byte Data) // CRC-16/CCITT, bit by bit (no table, it's not worth the flash for a few dozen bytes)
+{
+  Crc ^= (unsigned int)Data << 8;
+  for (byte i = 0; i < 8; i++)
+    if (Crc & 0x8000)
+      Crc = (Crc << 1) ^ 0x1021;
+    else
+      Crc <<= 1;
+  return Crc & 0xFFFF;
+}
+
+
+
+/* General */
+TouchBarStore::TouchBarStore (TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr, byte ConfigCount, unsigned int EEPROMAddress, byte SlotCount, unsigned long CommitDelay)
+{
+  Common = CommonPtr;
+  Configs = ConfigPtr;
+  Count = ConfigCount;
+  Address = EEPROMAddress;
+  Slots = SlotCount;
+  Delay = CommitDelay;
+}
+
+unsigned int TouchBarStore::SlotLength ()
+{
+  return StoreHeader + StoreCommon + StoreConfig * Count + 2;
+}
+
+unsigned int TouchBarStore::Length ()
+{
+  return Slots * SlotLength ();
+}
+
+
+
+/* Record */
+void TouchBarStore::Put (byte Data)
+{
+  Crc = StoreCrc (Crc, Data);
+  if (Mode == StoreWrite)
+    UpdateEEPROM (Cursor, Data);
+  else if (EEPROM.read (Cursor) != Data)
+    Different = true;
+  Cursor += 1;
+}
+
+void TouchBarStore::Put (unsigned int Data)
+{
+  Put ((byte)(Data >> 8));
+  Put ((byte)Data);
+}
+
+void TouchBarStore::Put (unsigned long Data)
+{
+  Put ((unsigned int)(Data >> 16));
+  Put ((unsigned int)Data);
+}
+
+byte TouchBarStore::GetByte ()
+{
+  byte Data = EEPROM.read (Cursor);
+  Cursor += 1;
+  return Data;
+}
+
+unsigned int TouchBarStore::GetInt ()
+{
+  unsigned int Data = GetByte () << 8;
+  return Data | GetByte ();
+}
+
+unsigned long TouchBarStore::GetLong ()
+{
+  unsigned long Data = (unsigned long)GetInt () << 16;
+  return Data | GetInt ();
+}
+
+void TouchBarStore::Record (unsigned int NewSequence) // Writes (or compares, see Mode) the whole record at Cursor.
+{
+  Crc = 0xFFFF;
+  Put ((byte)StoreMagic);
+  Put ((byte)StoreVersion);
+  Put (NewSequence);
+  Put (Count);
+
+  Put (Common->TapTimeout);
+  Put (Common->TwitchSuppressionDelay);
+  Put (Common->TapTime);
+  Put (Common->TwitchSuppressionTime);
+  Put (Common->DebounceDelay);
+
+  for (byte i = 0; i < Count; i++)
+  {
+    TouchBarConfig *Config = &Configs[i];
+    PutPosition (Config->Default);
+    PutPosition (Config->Limit);
+    PutStep (Config->Resolution);
+    Put (Config->RampDelay);
+    PutStep (Config->RampResolution);
+    byte Flags = 0;
+    bitWrite (Flags, 7, Config->GetRollOverFlag());
+    bitWrite (Flags, 6, Config->GetSpringBackFlag());
+    bitWrite (Flags, 5, Config->GetSnapFlag());
+    bitWrite (Flags, 4, Config->GetRampFlag());
+    bitWrite (Flags, 3, Config->GetFlipFlag());
+    Put (Flags);
+    Put (Config->RampTime);
+    Put (Config->RampProfile);
+    Put (Config->AccelerationSpeed);
+    Put (Config->AccelerationLimit);
+    Put (Config->FlingTime);
+    Put (Config->FlingSpeed);
+    Put (Config->Gestures);
+    Put (Config->MultiTapTime);
+    Put (Config->LongPressTime);
+  }
+
+  unsigned int Sum = Crc; // Put() keeps adding to it.
+  Put (Sum);
+}
+
+boolean TouchBarStore::Check (byte Index, unsigned int *RecordSequence) // Is there a good record in the slot?
+{
+  Cursor = Address + Index * SlotLength ();
+  unsigned int Start = Cursor;
+  if (GetByte () != StoreMagic || GetByte () != StoreVersion)
+    return false;
+  *RecordSequence = GetInt ();
+  if (GetByte () != Count)
+    return false;
+
+  unsigned int Sum = 0xFFFF;
+  for (Cursor = Start; Cursor < Start + SlotLength () - 2; )
+    Sum = StoreCrc (Sum, GetByte ());
+  return GetInt () == Sum;
+}
+
+boolean TouchBarStore::Find () // Finds the newest good record.
+{
+  Valid = false;
+  for (byte i = 0; i < Slots; i++)
+  {
+    unsigned int RecordSequence;
+    if (Check (i, &RecordSequence))
+      // Newer if it's less then half way round ahead, so the sequence number can roll over.
+      if (Valid == false || (unsigned int)((RecordSequence - Sequence) & 0xFFFF) - 1 < 0x7FFF)
+      {
+        Valid = true;
+        Slot = i;
+        Sequence = RecordSequence;
+      }
+  }
+  return Valid;
+}
+
+
+
+/* Operation */
+boolean TouchBarStore::Load ()
+{
+  if (Find () == false)
+    return false;
+
+  Cursor = Address + Slot * SlotLength () + StoreHeader;
+  Common->TapTimeout = GetInt ();
+  Common->TwitchSuppressionDelay = GetByte ();
+  Common->TapTime = GetLong ();
+  Common->TwitchSuppressionTime = GetLong ();
+  Common->DebounceDelay = GetInt ();
+
+  for (byte i = 0; i < Count; i++)
+  {
+    TouchBarConfig *Config = &Configs[i];
+    Config->Default = GetPosition ();
+    Config->Limit = GetPosition ();
+    Config->Resolution = GetStep ();
+    Config->RampDelay = GetByte ();
+    Config->RampResolution = GetStep ();
+    byte Flags = GetByte ();
+    if (bitRead(Flags, 7) == true)
+      Config->SetFlags(bitRead(Flags, 7), bitRead(Flags, 3));
+    else
+      Config->SetFlags(bitRead(Flags, 6), bitRead(Flags, 5), bitRead(Flags, 4), bitRead(Flags, 3));
+    Config->RampTime = GetLong ();
+    Config->RampProfile = GetByte ();
+    Config->AccelerationSpeed = GetInt ();
+    Config->AccelerationLimit = GetByte ();
+    Config->FlingTime = GetLong ();
+    Config->FlingSpeed = GetInt ();
+    Config->Gestures = GetByte ();
+    Config->MultiTapTime = GetLong ();
+    Config->LongPressTime = GetLong ();
+  }
+  Dirty = false;
+  return true;
+}
+
+void TouchBarStore::Save ()
+{
+  Dirty = true;
+  Changed = millis ();
+}
+
+boolean TouchBarStore::Service ()
+{
+  if (Dirty && millis () - Changed >= Delay)
+    return Commit ();
+  return false;
+}
+
+boolean TouchBarStore::Pending ()
+{
+  return Dirty;
+}
+
+boolean TouchBarStore::Commit ()
+{
+  Dirty = false;
+
+  if (Valid || Find ()) // Without Load() first it still has to know where the newest record is.
+  {
+    // Same as the newest record? Then there's nothing to write.
+    Mode = StoreCompare;
+    Different = false;
+    Cursor = Address + Slot * SlotLength ();
+    Record (Sequence);
+    if (Different == false)
+      return false;
+    Slot = (Slot + 1) % Slots;
+    Sequence = (Sequence + 1) & 0xFFFF;
+  }
+  else
+  {
+    Slot = 0;
+    Sequence = 0;
+  }
+
+  Mode = StoreWrite;
+  Cursor = Address + Slot * SlotLength ();
+  Record (Sequence);
+  Valid = true;
+#ifdef StoreNeedsCommit
+  EEPROM.commit ();
+#endif
+  return true;
+}
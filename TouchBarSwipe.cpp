@@ -0,0 +1,153 @@
+#include "TouchBar.h"
+
+/*
+Swipe speed, acceleration and fling
+The speed is measured in steps per second (Increment2 / Decrement2 count as 2 steps) from the time between steps, smoothed a bit, and starts from 0 on every touch and whenever the direction turns around.
+It's timed with the Clock when TouchBarCommon::Clock is set, with micros() otherwise, and only on the updates where something happens (touch, step, release, coasting).
+Acceleration (AccelerationSpeed != 0): swiping faster then AccelerationSpeed the step grows in proportion to the speed, up to AccelerationLimit times the Resolution.
+Fling (FlingTime != 0): lifting the finger faster then FlingSpeed it keeps going, slowing down evenly to a stop in FlingTime, so it goes Speed * FlingTime / 2 steps further. Touching any pad stops it.
+Integer math only, Q8 (256 = 1 step) for the distance. FlingTime is worked out in ms, so keep it under about 65 s.
+Only compiled with TouchBarSwipeSpeed defined (see the top of TouchBar.h), without it every step is Resolution and lifting the finger stops it.
+*/
+
+#ifdef TouchBarSwipeSpeed
+
+#define MaxSwipeSpeed 2000 // Steps per second, faster then this is counted as this (there's no telling apart two steps a few us apart anyway).
+
+unsigned long TouchBar::SwipeTime ()
+{
+  if (Common->Clock != 0)
+    return Now;
+  return micros();
+}
+
+TouchBarPosition TouchBar::StepSize (unsigned int Speed)
+{
+  if (Config->AccelerationSpeed == 0 || Speed <= Config->AccelerationSpeed)
+    return Config->Resolution;
+
+  unsigned long Factor = (unsigned long)Speed * 256 / Config->AccelerationSpeed; // Q8
+  if (Factor > (unsigned long)Config->AccelerationLimit * 256)
+    Factor = (unsigned long)Config->AccelerationLimit * 256;
+  TouchBarPosition Step = (unsigned long)Config->Resolution * Factor >> 8;
+
+  // Never more then half way round, otherwise AdjustOutput can't tell which way it went.
+  if (Step > Config->Limit / 2)
+    Step = Config->Limit / 2;
+  if (Step < Config->Resolution)
+    Step = Config->Resolution;
+  return Step;
+}
+
+TouchBarPosition TouchBar::Swipe () // Called after GetDirection(), returns the size of a step for AdjustOutput()
+{
+  if (ABCPads != 0)
+  {
+    FlingVelocity = 0; // Touching stops coasting.
+
+    if (ABCPrevious[0] == 0) // Just touched
+    {
+      LastStep = SwipeTime();
+      Velocity = 0;
+      return Config->Resolution;
+    }
+    if (Direction == Static)
+      return Config->Resolution;
+
+    unsigned long Time = SwipeTime();
+    unsigned long Elapsed = Time - LastStep;
+    LastStep = Time;
+
+    long Rate = MaxSwipeSpeed;
+    if (Elapsed > 0)
+      Rate = (Direction == Increment2 || Direction == Decrement2 ? 2000000UL : 1000000UL) / Elapsed;
+    if (Rate > MaxSwipeSpeed)
+      Rate = MaxSwipeSpeed;
+    if (Direction < Static)
+      Rate = -Rate;
+
+    // Half the new rate, half the old speed. If it turned around the old speed doesn't count.
+    if ((Rate > 0 && Velocity < 0) || (Rate < 0 && Velocity > 0))
+      Velocity = Rate;
+    else
+      Velocity = (Velocity + Rate) / 2;
+
+    return StepSize (Velocity < 0 ? -Velocity : Velocity);
+  }
+
+  if (ABCPrevious[0] != 0) // Just released
+  {
+    int Speed = VelocityAt (SwipeTime());
+    Velocity = 0;
+    if (Config->FlingTime != 0 && Config->GetSpringBackFlag() == false && Speed != 0 && (unsigned int)(Speed < 0 ? -Speed : Speed) >= Config->FlingSpeed)
+    {
+      FlingVelocity = Speed;
+      FlingStart = SwipeTime();
+      FlingDone = 0;
+    }
+  }
+
+  if (FlingVelocity == 0)
+    return Config->Resolution;
+
+  // Coasting, speed falls from FlingVelocity to 0 in FlingTime: Distance = V * t * (1 - t / (2 * FlingTime))
+  unsigned long Total = Config->FlingTime / 1000;
+  if (Total == 0)
+    Total = 1;
+  unsigned long Elapsed = (SwipeTime() - FlingStart) / 1000;
+  boolean Done = false;
+  if (Elapsed >= Total)
+  {
+    Elapsed = Total;
+    Done = true;
+  }
+  unsigned int Speed = FlingVelocity < 0 ? -FlingVelocity : FlingVelocity;
+  unsigned long Distance = (unsigned long)Speed * Elapsed / 125 * 32; // Q8 steps at full speed
+  Distance = (Distance >> 4) * (256 - Elapsed * 128 / Total) >> 4; // Slowing down
+  unsigned long Steps = 0;
+  if ((Distance >> 8) > FlingDone) // With the rounding it can go back a hair, that doesn't count.
+    Steps = (Distance >> 8) - FlingDone;
+  FlingDone += Steps;
+
+  boolean Up = FlingVelocity > 0;
+  if (Done)
+    FlingVelocity = 0;
+  if (Steps == 0)
+    return Config->Resolution;
+
+  Direction = Up ? Increment : Decrement;
+  TouchBarPosition Step = StepSize ((unsigned long)Speed * (Total - Elapsed) / Total); // The step shrinks back as it slows down.
+  if (Steps > Config->Limit / 2 / Step) // Same as Steps * Step > Limit / 2, without the multiply overflowing.
+    Steps = Config->Limit / 2 / Step;
+  if (Steps == 0)
+    Steps = 1;
+  return Steps * Step;
+}
+
+int TouchBar::GetVelocity ()
+{
+  if (ABCPads == 0 && FlingVelocity == 0)
+    return 0;
+  return VelocityAt (Common->Clock != 0 ? Common->Clock() : micros());
+}
+
+int TouchBar::VelocityAt (unsigned long Time)
+{
+  if (FlingVelocity != 0)
+  {
+    unsigned long Elapsed = Time - FlingStart;
+    if (Elapsed >= Config->FlingTime)
+      return 0;
+    return (long)FlingVelocity * (long)((Config->FlingTime - Elapsed) >> 8) / (long)(Config->FlingTime >> 8 | 1);
+  }
+
+  // No step for a while means it's slower then that, however fast the last steps were.
+  unsigned long Elapsed = Time - LastStep;
+  long Cap = Elapsed > 0 ? 1000000UL / Elapsed : MaxSwipeSpeed;
+  if (Velocity > Cap)
+    return Cap;
+  if (Velocity < -Cap)
+    return -Cap;
+  return Velocity;
+}
+#endif
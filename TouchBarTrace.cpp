@@ -0,0 +1,121 @@
+#ifndef ARDUINO
+
+#include "TouchBarTrace.h"
+
+
+
+/* General */
+TouchBarTraceReader::TouchBarTraceReader (const byte *DataPtr, size_t DataLength)
+{
+  Data = DataPtr;
+  Length = DataLength;
+}
+
+TouchBarTraceReader::TouchBarTraceReader (FILE *TraceFile)
+{
+  File = TraceFile;
+}
+
+
+
+/* Reading */
+int TouchBarTraceReader::Get ()
+{
+  if (File != 0)
+    return fgetc (File); // EOF is -1 too
+  if (Offset >= Length)
+    return -1;
+  return Data[Offset++];
+}
+
+boolean TouchBarTraceReader::GetVarint (unsigned long *Value)
+{
+  *Value = 0;
+  for (byte Shift = 0; Shift < 35; Shift += 7) // 5 bytes hold 32 bits, anything longer is broken
+  {
+    int Byte = Get ();
+    if (Byte < 0)
+      return false;
+    *Value |= (unsigned long)(Byte & 0x7F) << Shift;
+    if ((Byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+boolean TouchBarTraceReader::Next (byte *Pads, unsigned long *Count, unsigned long *Start)
+{
+  if (Broken)
+    return false;
+  if (Started == false)
+  {
+    if (Get () != 'T' || Get () != 'B' || Get () != 'T' || Get () != 1)
+    {
+      Broken = true;
+      return false;
+    }
+    Started = true;
+  }
+
+  int First = Get ();
+  if (First < 0)
+    return false; // The end, between 2 runs, as it should be.
+
+  unsigned long More = 0;
+  unsigned long Delta;
+  if (((First & 0x80) != 0 && GetVarint (&More) == false) || GetVarint (&Delta) == false)
+  {
+    Broken = true;
+    return false;
+  }
+  *Pads = First & 0x07;
+  *Count = More << 4 | (First >> 3 & 0x0F);
+  Time = (Time + Delta) & 0xFFFFFFFF; // micros() is 32 bits on the board
+  *Start = Time;
+  return *Count != 0;
+}
+
+boolean TouchBarTraceReader::Error ()
+{
+  return Broken;
+}
+
+
+
+/* Replay */
+unsigned long TouchBarTraceReader::Replay (TouchBar *TB, FILE *Timeline)
+{
+  // A run lasts until the next one starts, so it takes one run of lookahead to spread its samples over the right time.
+  // The last run has nothing after it, its samples get the period of the run before.
+  byte Pads, NextPads;
+  unsigned long Count, Start, NextCount, NextStart;
+  unsigned long Period = 0;
+  unsigned long Samples = 0;
+  if (Timeline != 0)
+    fprintf (Timeline, "Time,Pads,Position,Target,Tap\n");
+
+  boolean More = Next (&Pads, &Count, &Start);
+  while (More)
+  {
+    More = Next (&NextPads, &NextCount, &NextStart);
+    unsigned long Duration = More ? (NextStart - Start) & 0xFFFFFFFF : Period * Count;
+    for (unsigned long i = 0; i < Count; i++)
+    {
+      unsigned long Now = (Start + Duration * i / Count) & 0xFFFFFFFF;
+      SetVirtualMicros (Now);
+      TB->Update (Pads);
+      char Tap = TB->PadEvent ();
+      if (Timeline != 0 && (TB->Event () || Tap != 'Z'))
+        fprintf (Timeline, "%lu,%u,%u,%u,%c\n", Now, Pads, TB->GetPositionInt (), TB->GetTargetInt (), Tap == 'Z' ? '-' : Tap);
+    }
+    if (More)
+      Period = Duration / Count;
+    Samples += Count;
+    Pads = NextPads;
+    Count = NextCount;
+    Start = NextStart;
+  }
+  return Samples;
+}
+
+#endif
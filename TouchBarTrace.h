@@ -0,0 +1,41 @@
+#ifndef TouchBarTrace_H
+#define TouchBarTrace_H
+
+// Host only! Reads the traces TouchBarRecorder writes (see TouchBarRecorder.cpp for the format), and replays them through a TouchBar on the virtual clock.
+// Record a bar that misbehaves on the board, replay it on the PC as often as you like, with other settings, a debugger, or the instrumentation turned on.
+
+#ifndef ARDUINO
+
+#include "TouchBar.h"
+#include <stdio.h>
+
+class TouchBarTraceReader
+{
+  private:
+    const byte *Data = 0; // Memory (a file read in, or mmap()ed)...
+    size_t Length = 0;
+    size_t Offset = 0;
+    FILE *File = 0; // ...or a stream, read as it goes, so traces of any length work.
+    boolean Started = false;
+    boolean Broken = false;
+    unsigned long Time = 0;
+
+    int Get (); // -1 at the end
+    boolean GetVarint (unsigned long *Value);
+
+  public:
+    // Constructor
+    TouchBarTraceReader (const byte *DataPtr, size_t DataLength);
+    TouchBarTraceReader (FILE *TraceFile);
+
+    // Reading
+    boolean Next (byte *Pads, unsigned long *Count, unsigned long *Start); // Next run: Count samples of Pads from Start (micros() at the first one). Returns false at the end of the trace, or if it's broken.
+    boolean Error (); // Returns true if the header was wrong or the trace was cut in the middle of a run.
+
+    // Replay
+    unsigned long Replay (TouchBar *TB, FILE *Timeline = 0); // Feeds the whole trace to TB, returns the number of samples. Timeline (if not 0) gets a CSV line (Time,Pads,Position,Target,Tap) for every update with a change.
+}; // <<< ; at the end is important!!!
+
+#endif
+
+#endif
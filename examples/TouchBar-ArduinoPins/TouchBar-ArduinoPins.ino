@@ -37,6 +37,7 @@ DigitalTouch TInF(A3);
 // TouchBar objects
 // The Common object applies to every TouchBar object. These are tuning options, and should be left untouched unless your arduino runs on other then 16MHz, or your program is so long, it's getting slow...
 TouchBarCommon Common = {320, 60}; // unsigned int TapTimeout, byte TwitchSuppressionDelay
+//TouchBarCommon Common = {0, 0, micros, 150000, 3000}; // Wall-clock timing: unsigned long (*Clock)(), unsigned long TapTime, unsigned long TwitchSuppressionTime (in us, so it doesn't depend on clock speed or loop length. Set Config[x].RampTime as well!)
 /*
   Note:
   - TapTimeout - may not be obvious, if you rest your finger on the touch bar, but you change your mind and don't wanna ajust it, any you're only touching 1 of the pads, it may interpret it as a tap,
@@ -81,6 +82,7 @@ void setup()
   Config[0].Resolution = 100; // Valid range: Resolution > 0 && Resolution < Limit
   Config[0].RampDelay = 100; // This depends on execution speed as well. It's defined in cycles of executon not ms or us... Valid range: 0 to 255
   Config[0].RampResolution = 25; // Valid range: RampResolution > 0 && RampResolution < Limit
+  //Config[0].RampTime = 4000; // us between ramp steps, only used with wall-clock timing (see Common above)
   // Use only one of the following 2 lines! It is an overloaded method, one of them should be commented!
   Config[0].SetFlags(false, true, false, false); // It takes: SpringBackFlag, SnapFlag, RampFlag, FlipFlag; SpringBack overrides Snap and thus don't work together, every other combination should be fine.
   //Config[0].SetFlags (true, false); // it takes: RollOverFlag, FlipFlag; RollOver doesn't work with anything but flip, even worse with Ramp on it suddenly changes direction when you pass the limit...
@@ -108,7 +110,7 @@ void setup()
 
   // This is an easy way to save/load the settings to/from EEPROM (Optional, in v2.0 and newer it's no longger built into the touchbar class.)
   // Both take: TouchBarCommon*(pointer to Common object), TouchBarConfig(the entire Config object array), sizeof(Config)/sizeof(Config[0]), EEPROMAddress
-  // Requires: sizeof(Common) + sizeof(Config) bytes of EEPROM
+  // Requires: SavedConfigBytes(sizeof(Config)/sizeof(Config[0])) bytes of EEPROM
   // Without the use of EEPROM, it compiles to 550 bytes less.
   //SaveTouchBarConfig (&Common, Config, sizeof(Config)/sizeof(Config[0]), 0); // Can be left uncommented, it uses EEPROM.update()
   //LoadTouchBarConfig (&Common, Config, sizeof(Config)/sizeof(Config[0]), 0);
@@ -10,7 +10,6 @@ Hardware requirements:
 Libraries requirements:
 - TouchLib (Available among my github repositories: https://github.com/RPBCACUEAIIBH/TouchLib)
 - TouchBar (This one...)
-- Delinearizer (Available among my github repositories: https://github.com/RPBCACUEAIIBH/Delinearizer)
 - EEPROM (Required by TouchBar, Should be included with your IDE, you're not required to use the EEPROM, it's an option you can enable at setup().)
 
 
@@ -27,7 +26,6 @@ Note:
 
 #include <TouchLib.h>
 #include <TouchBar.h>
-#include <Delinearizer.h>
 
 DigitalTouch TInA(A0);
 DigitalTouch TInB(A1);
@@ -39,9 +37,38 @@ TouchBarCommon Common = {320, 60}; // unsigned int TapTimeout, byte TwitchSuppre
 TouchBarConfig Config[1];
 TouchBar TB (&Common, &Config[0]); // It takes: TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr
 
+// Output maps, position 0 - 10000 onto 0.00% - 100.00% (in hundredths) along each curve. Integer math only, no floating point is linked in. (Use 0, 255 for analogWrite(), 0, 127 for a MIDI CC, 0, 16383 for pitch bend...)
+TouchBarMap Linear (10000, 0, 10000); // It takes: InputLimit (Config[0].Limit), OutputMin, OutputMax, and optionally a curve
+TouchBarMap Log (10000, 0, 10000, TouchBarLogCurve);
+TouchBarMap Exp (10000, 0, 10000, TouchBarExpCurve);
+TouchBarMap S (10000, 0, 10000, TouchBarSCurve);
+
 // Variables
 unsigned int PreviousTarget;
 
+void PrintPercent (unsigned int Value) // Hundredths of a percent, printed as 12.34 without floats.
+{
+  Serial.print (Value / 100);
+  Serial.print ('.');
+  if (Value % 100 < 10)
+    Serial.print ('0');
+  Serial.print (Value % 100);
+}
+
+void PrintCurves ()
+{
+  unsigned int Position = TB.GetPositionInt();
+  Serial.print (F("CPos: "));
+  PrintPercent (Linear.Map(Position)); // Displaying current position in percentage.
+  Serial.print (F("   CPos-Log: "));
+  PrintPercent (Log.Map(Position)); // Displays the current position's Logarithmic equivalent in percentage.
+  Serial.print (F("   CPos-Exp: "));
+  PrintPercent (Exp.Map(Position)); // Displays the current position's Exponential (InverseLogarithmic) equivalent in percentage.
+  Serial.print (F("   CPos-S-Curve: "));
+  PrintPercent (S.Map(Position)); // Displays the current position's S-Curve equivalent in percentage.
+  Serial.println ();
+}
+
 void setup()
 {
   Serial.begin (115200);
@@ -79,7 +106,7 @@ void setup()
 
   // This is an easy way to save/load the settings to/from EEPROM (Optional, in v2.0 and newer it's no longger built into the touchbar class.)
   // Both take: TouchBarCommon*(pointer to Common object), TouchBarConfig(the entire Config object array), sizeof(Config)/sizeof(Config[0]), EEPROMAddress
-  // Requires: sizeof(Common) + sizeof(Config) bytes of EEPROM
+  // Requires: SavedConfigBytes(sizeof(Config)/sizeof(Config[0])) bytes of EEPROM
   // Without the use of EEPROM, it compiles to 550 bytes less.
   //SaveTouchBarConfig (&Common, Config, sizeof(Config)/sizeof(Config[0]), 0); // Can be left uncommented, it uses EEPROM.update()
   //LoadTouchBarConfig (&Common, Config, sizeof(Config)/sizeof(Config[0]), 0);
@@ -119,15 +146,7 @@ void setup()
   Serial.println ();
 
   // It starts at position 0 but only displays it if there's an event. There's no event for position 0, but this should print it regardless at start so it's not missing. (Just a nice touch...)
-  Serial.print (F("CPos: "));
-  Serial.print (TB.GetPositionFloat()); // Displaying current position in percentage.
-  Serial.print (F("   CPos-Log: "));
-  Serial.print (Logarithmic(TB.GetPositionFloat())); // Displays the current position's Logarithmic equivalent in percentage.
-  Serial.print (F("   CPos-InverseLog: "));
-  Serial.print (InverseLogarithmic(TB.GetPositionFloat())); // Displays the current position's InverseLogarithmic equivalent in percentage.
-  Serial.print (F("   CPos-S-Curve: "));
-  Serial.print (SCurve(TB.GetPositionFloat())); // Displays the current position's S-Curve equivalent in percentage.
-  Serial.println ();
+  PrintCurves ();
 }
 
 void loop()
@@ -139,15 +158,7 @@ void loop()
   // Get position.
   if (TB.Event() == true)
   {
-    Serial.print (F("CPos: "));
-    Serial.print (TB.GetPositionFloat()); // Displaying current position in percentage.
-    Serial.print (F("   CPos-Log: "));
-    Serial.print (Logarithmic(TB.GetPositionFloat())); // Displays the current position's Logarithmic equivalent in percentage.
-    Serial.print (F("   CPos-InverseLog: "));
-    Serial.print (InverseLogarithmic(TB.GetPositionFloat())); // Displays the current position's InverseLogarithmic equivalent in percentage.
-    Serial.print (F("   CPos-S-Curve: "));
-    Serial.print (SCurve(TB.GetPositionFloat())); // Displays the current position's S-Curve equivalent in percentage.
-    Serial.println ();
+    PrintCurves ();
     // In case you make a graph: Open serial monitor, clear the output, reset the arduino, and hit the top pad and it will print a list you can insert into an excel sheet.
   }
 }
@@ -180,7 +180,7 @@ void setup()
 
   // This is an easy way to save/load the settings to/from EEPROM (Optional, in v2.0 and newer it's no longger built into the touchbar class.)
   // Both take: TouchBarCommon*(pointer to Common object), TouchBarConfig(the entire Config object array), sizeof(Config)/sizeof(Config[0]), EEPROMAddress
-  // Requires: sizeof(Common) + sizeof(Config) bytes of EEPROM
+  // Requires: SavedConfigBytes(sizeof(Config)/sizeof(Config[0])) bytes of EEPROM
   // Without the use of EEPROM, it compiles to 550 bytes less.
   /*
   EEPROM.begin (1024); // ESP8266 doesn't actually have an EEPROM, in this case it allocates 1024 bytes of flash memory where settings will be saved.
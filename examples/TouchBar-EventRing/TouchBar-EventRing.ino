@@ -0,0 +1,105 @@
+/*
+Event ring example - the same touch bar as the TouchBar-ArduinoPins example, but the pads are read and Update() is called from a timer interrupt, 1000 times a second.
+That way decoding doesn't depend on how long loop() takes (put a delay() in it and see), and Update() pushes every tap, position and target change into a TouchBarEventRing, which loop() empties whenever it gets to it.
+Wall-clock timing is used, since the number of Update() calls a second no longer depends on loop().
+
+
+Hardware and library requirements: same as the TouchBar-ArduinoPins example. (The timer setup below is for AVR boards, Timer1, 16MHz.)
+*/
+
+#include <TouchLib.h>
+#include <TouchBar.h>
+
+// TouchLib objects
+DigitalTouch TInA(A0);
+DigitalTouch TInB(A1);
+DigitalTouch TInC(A2);
+
+// TouchBar objects
+TouchBarCommon Common = {0, 0, micros, 150000, 3000}; // unsigned long (*Clock)(), unsigned long TapTime, unsigned long TwitchSuppressionTime (in us)
+TouchBarConfig Config[1];
+TouchBar TB (&Common, &Config[0]);
+
+TouchBarEvent EventBuffer[16]; // 2, 4, 8, 16, 32, 64 or 128 events. 16 is plenty, unless loop() is away for more then a few ms while you swipe.
+TouchBarEventRing EventRing (EventBuffer, 16);
+
+// Variables
+unsigned int PreviousOverflows = 0;
+
+ISR (TIMER1_COMPA_vect) // The producer: the only place Update() is called from.
+{
+  TB.Update (TInA.ReadState(), TInB.ReadState(), TInC.ReadState());
+}
+
+void setup ()
+{
+  Serial.begin (115200);
+
+  /* TouchLib */
+  while (TInA.Calibrate())
+    Serial.println (F("Calibration for Touch Input A failed! Retrying..."));
+  while (TInB.Calibrate())
+    Serial.println (F("Calibration for Touch Input B failed! Retrying..."));
+  while (TInC.Calibrate())
+    Serial.println (F("Calibration for Touch Input C failed! Retrying..."));
+
+  /* TouchBar */
+  Config[0].Default = 5000;
+  Config[0].Limit = 10000;
+  Config[0].Resolution = 100;
+  Config[0].RampDelay = 100; // Not used with wall-clock timing, RampTime is.
+  Config[0].RampResolution = 25;
+  Config[0].RampTime = 4000; // us between ramp steps
+  Config[0].SetFlags(false, true, true, false); // SpringBackFlag, SnapFlag, RampFlag, FlipFlag
+  TB.SetPosition(Config[0].Default);
+  TB.SetEventRing(&EventRing); // Set it up before the interrupt starts calling Update().
+
+  /* Timer1: CTC mode, 16MHz / 64 / 250 = 1000 interrupts a second */
+  noInterrupts ();
+  TCCR1A = 0;
+  TCCR1B = (1 << WGM12) | (1 << CS11) | (1 << CS10);
+  OCR1A = 249;
+  TIMSK1 |= (1 << OCIE1A);
+  interrupts ();
+
+  Serial.println(F("Initialization done!"));
+}
+
+void loop () // The consumer: no need to disable interrupts around Pop(), the ring is lock-free.
+{
+  TouchBarEvent Event;
+  while (EventRing.Pop(&Event))
+  {
+    Serial.print (Event.Time);
+    Serial.print (F(" us: "));
+    switch (Event.Type)
+    {
+      case TapEvent:
+        Serial.print (F("Tapped the "));
+        Serial.print ((char) Event.Value);
+        Serial.println (F(" pad."));
+      break;;
+      case TargetEvent:
+        Serial.print (F("Target set to "));
+        Serial.println (Event.Value);
+      break;;
+      case PositionEvent:
+        Serial.print (F("CPos: "));
+        Serial.println (Event.Value);
+      break;;
+      default:
+        Serial.print (F("Event "));
+        Serial.println (Event.Type);
+      break;;
+    }
+  }
+
+  if (EventRing.GetOverflows() != PreviousOverflows)
+  {
+    PreviousOverflows = EventRing.GetOverflows();
+    Serial.print (PreviousOverflows);
+    Serial.println (F(" events dropped so far, loop() didn't keep up. Make the ring bigger, or loop() faster."));
+  }
+
+  delay (20); // Something slow in loop(), nothing is missed.
+}
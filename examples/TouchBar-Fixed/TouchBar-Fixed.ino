@@ -0,0 +1,98 @@
+/*
+TouchBarFixed example - the same touch bar as the TouchBar-MPR121-Arduino example (Config[0] there), with its settings fixed at compile time.
+
+
+When a bar never changes mode, TouchBarFixed<Settings> does the same job as TouchBar with less flash and less time per Update(), the compiler throws away the code for the modes you don't use.
+Comment out the UseFixed line below to build the very same sketch with an ordinary TouchBar, and compare:
+- Flash: the size the IDE reports after compiling.
+- Time: the sketch feeds 1000 samples of a swipe to the bar at startup and prints how long an Update() took on average.
+
+
+Hardware and library requirements: same as the TouchBar-MPR121-Arduino example.
+*/
+
+#include <Adafruit_MPR121.h>
+#include <TouchBar.h>
+#include <TouchBarFixed.h>
+
+#define UseFixed // <<< Comment this out to use an ordinary TouchBar
+
+// MPR121 Driver Object
+Adafruit_MPR121 TouchModule = Adafruit_MPR121();
+
+#ifdef UseFixed
+// Every setting is a constant, including the ones that would go to the Common object. Same valid ranges as TouchBarConfig, out of range values don't compile.
+struct Settings
+{
+  static const unsigned int Default = 5000;
+  static const unsigned int Limit = 10000;
+  static const byte Resolution = 100;
+  static const byte RampDelay = 100;
+  static const byte RampResolution = 25;
+  static const boolean RollOver = false; // RollOver overrides SpringBack, Snap and Ramp
+  static const boolean SpringBack = false;
+  static const boolean Snap = true;
+  static const boolean Ramp = false;
+  static const boolean Flip = false;
+  static const unsigned int TapTimeout = 140;
+  static const byte TwitchSuppressionDelay = 20;
+}; // <<< ; at the end is important!!!
+
+TouchBarFixed<Settings> TB; // Starts at Default, no need to initialize it.
+#else
+TouchBarCommon Common = {140, 20}; // unsigned int TapTimeout, byte TwitchSuppressionDelay
+TouchBarConfig Config;
+TouchBar TB (&Common, &Config);
+#endif
+
+void setup ()
+{
+  Serial.begin(115200);
+
+  if (!TouchModule.begin(0x5A))
+  {
+    Serial.println(F("MPR121 not found!"));
+    while (1);
+  }
+
+#ifndef UseFixed
+  Config.Default = 5000;
+  Config.Limit = 10000;
+  Config.Resolution = 100;
+  Config.RampDelay = 100;
+  Config.RampResolution = 25;
+  Config.SetFlags(false, true, false, false);
+  TB.SetPosition(Config.Default);
+#endif
+
+  // Timing: a light swipe up and down, each state held for 25 updates (so it gets through the twitch suppression).
+  static const byte Swipe[12] = {1, 3, 2, 6, 4, 5, 4, 6, 2, 3, 1, 0};
+  unsigned long Start = micros();
+  for (unsigned int i = 0; i < 1000; i++)
+    TB.Update (Swipe[i / 25 % 12]);
+  unsigned long Elapsed = micros() - Start;
+  TB.SetPosition(5000);
+
+  Serial.print (F("Update() takes "));
+  Serial.print (Elapsed / 1000.0);
+  Serial.println (F(" us on average."));
+  Serial.println(F("Initialization done!"));
+}
+
+void loop ()
+{
+  TB.Update (TouchModule.touched()); // Takes a byte, and uses the first 3 bits
+
+  if (TB.PadEvent() != 'Z')
+  {
+    Serial.print (F("Tapped the "));
+    Serial.print (TB.PadEvent());
+    Serial.println (F(" pad."));
+  }
+  if (TB.Event() == true)
+  {
+    Serial.print (F("CPos: "));
+    Serial.print (TB.GetPositionFloat());
+    Serial.println (F("%"));
+  }
+}
@@ -0,0 +1,71 @@
+/*
+Analog example - the same touch bar as the TouchBar-MPR121-Arduino example, fed with how much each pad is touched rather then touched or not.
+The MPR121 measures every electrode all the time, touched() only says which ones crossed its threshold. Baseline - filtered data is how much each one is touched,
+and from how the finger is shared between the pads the position follows it smoothly, rather then jumping a Resolution at a time when the finger crosses onto another pad.
+Taps, snap, springback and ramp work the same as before.
+
+
+Hardware and library requirements: same as the TouchBar-MPR121-Arduino example.
+*/
+
+#include <Adafruit_MPR121.h>
+#include <TouchBar.h>
+
+#ifndef TouchBarAnalog
+  #error Uncomment #define TouchBarAnalog at the top of TouchBar.h for this example. (A #define here doesn't reach the library files.)
+#endif
+
+// MPR121 Driver Object
+Adafruit_MPR121 TouchModule = Adafruit_MPR121();
+
+TouchBarCommon Common = {140, 20}; // unsigned int TapTimeout, byte TwitchSuppressionDelay
+TouchBarConfig Config;
+TouchBar TB (&Common, &Config);
+
+unsigned int Reading (byte Electrode) // How much the electrode is touched, 0 when it isn't.
+{
+  int Delta = (int)TouchModule.baselineData(Electrode) - (int)TouchModule.filteredData(Electrode);
+  if (Delta < 0)
+    return 0;
+  return Delta;
+}
+
+void setup ()
+{
+  Serial.begin(115200);
+
+  if (!TouchModule.begin(0x5A))
+  {
+    Serial.println(F("MPR121 not found!"));
+    while (1);
+  }
+
+  Config.Default = 5000;
+  Config.Limit = 10000;
+  Config.Resolution = 100; // Still the distance of a half pad, now it's covered in 128 little moves rather then one step.
+  Config.RampDelay = 100;
+  Config.RampResolution = 25;
+  Config.SetFlags(false, true, false, false);
+  TB.SetPosition(Config.Default);
+  TB.SetAnalog(12, 1); // Touched from 12 up (the default touch threshold of the Adafruit library), smoothed over about 2 readings. Watch the readings over Serial and adjust it to your bar.
+
+  Serial.println(F("Initialization done!"));
+}
+
+void loop ()
+{
+  TB.UpdateAnalog (Reading(0), Reading(1), Reading(2));
+
+  if (TB.PadEvent() != 'Z')
+  {
+    Serial.print (F("Tapped the "));
+    Serial.print (TB.PadEvent());
+    Serial.println (F(" pad."));
+  }
+  if (TB.Event() == true)
+  {
+    Serial.print (F("CPos: "));
+    Serial.print (TB.GetPositionFloat());
+    Serial.println (F("%"));
+  }
+}
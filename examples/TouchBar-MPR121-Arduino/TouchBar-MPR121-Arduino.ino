@@ -25,6 +25,7 @@ Note:
 - If you wonder what the touch bar should look like, there's a Ki-CAD folder included in the library, containing sybmols and footprints you can use to print one on a PCB.
 - If you find this useful, please consider donationg: http://osrc.rip/Support.html
 - If you wanna make the most out of this library please read the documentatuon!
+- More then one bar on the MPR121? Don't pick the bits out for each bar by hand, see the TouchBar-MPR121-Array example.
 */
 
 #include <Adafruit_MPR121.h>
@@ -101,7 +102,7 @@ void setup ()
 
   // This is an easy way to save/load the settings to/from EEPROM (Optional, in v2.0 and newer it's no longger built into the touchbar class.)
   // Both take: TouchBarCommon*(pointer to Common object), TouchBarConfig(the entire Config object array), sizeof(Config)/sizeof(Config[0]), EEPROMAddress
-  // Requires: sizeof(Common) + sizeof(Config) bytes of EEPROM
+  // Requires: SavedConfigBytes(sizeof(Config)/sizeof(Config[0])) bytes of EEPROM
   // Without the use of EEPROM, it compiles to 550 bytes less.
   //SaveTouchBarConfig (&Common, Config, sizeof(Config)/sizeof(Config[0]), 0); // Can be left uncommented, it uses EEPROM.update()
   //LoadTouchBarConfig (&Common, Config, sizeof(Config)/sizeof(Config[0]), 0);
@@ -0,0 +1,111 @@
+/*
+TouchBarArray example - 3 touch bars on one MPR121, each with a function pad of its own, updated from touched() in one go rather then picking out the bits for each bar by hand.
+Electrodes 0-2 are the first bar and 3 its function pad, 4-6 the second bar and 7 its function pad, 8-10 the third bar and 11 its function pad.
+Holding a function pad switches its bar to the special settings (like in the TouchBar-MPR121-Arduino example), the other bars carry on as they were.
+
+
+Hardware requirements:
+- Same as the TouchBar-MPR121-Arduino example, except there are 3 bars and 3 function pads on the MPR121, wired as above.
+
+
+Libraries requirements: same as the TouchBar-MPR121-Arduino example.
+
+
+Note:
+- Bars whose electrodes didn't change are skipped by ArrayObject.Update() as long as they're Idle(), so an untouched bar costs next to nothing. The bars still give exactly what they would if each got its own Update() every loop.
+- If your bars are on electrodes 0-2, 3-5, 6-8 and 9-11 leave the ElectrodeMap out: TouchBarArray Bars (TB, 4);
+*/
+
+#include <Adafruit_MPR121.h>
+#include <TouchBar.h>
+
+#define BarCount 3
+
+// MPR121 Driver Object
+Adafruit_MPR121 TouchModule = Adafruit_MPR121();
+
+TouchBarCommon Common = {140, 20}; // unsigned int TapTimeout, byte TwitchSuppressionDelay
+TouchBarConfig Config[2]; // Config[0] normal settings, Config[1] while the function pad is held
+
+TouchBar TB[BarCount] = {{&Common, &Config[0]}, {&Common, &Config[0]}, {&Common, &Config[0]}};
+const byte ElectrodeMap[BarCount * 3] = {0, 1, 2, 4, 5, 6, 8, 9, 10}; // Pad A, B and C of each bar
+const byte FunctionPad[BarCount] = {3, 7, 11};
+TouchBarArray Bars (TB, BarCount, ElectrodeMap); // It takes: TouchBar *BarsPtr, byte Count, const byte *ElectrodeMap
+
+// Variables
+boolean PreviousFunctionState[BarCount];
+unsigned int PreviousTarget[BarCount];
+
+void setup ()
+{
+  Serial.begin(115200);
+
+  if (!TouchModule.begin(0x5A))
+  {
+    Serial.println(F("MPR121 not found!"));
+    while (1);
+  }
+
+  Config[0].Default = 5000;
+  Config[0].Limit = 10000;
+  Config[0].Resolution = 100;
+  Config[0].RampDelay = 100;
+  Config[0].RampResolution = 25;
+  Config[0].SetFlags(false, true, false, false); // SpringBackFlag, SnapFlag, RampFlag, FlipFlag
+
+  Config[1].Default = 5000;
+  Config[1].Limit = 10000;
+  Config[1].Resolution = 350;
+  Config[1].RampDelay = 100;
+  Config[1].RampResolution = 25;
+  Config[1].SetFlags(false, true, true, false);
+
+  for (byte i = 0; i < BarCount; i++)
+    TB[i].SetPosition(Config[0].Default);
+
+  Serial.println(F("Initialization done!"));
+}
+
+void loop ()
+{
+  unsigned int Touched = TouchModule.touched(); // All 12 electrodes
+
+  for (byte i = 0; i < BarCount; i++)
+  {
+    boolean X = bitRead (Touched, FunctionPad[i]);
+    if (X != PreviousFunctionState[i])
+      TB[i].Reconfigure (X == HIGH ? &Config[1] : &Config[0]); // Keeps the position and target
+    PreviousFunctionState[i] = X;
+    PreviousTarget[i] = TB[i].GetTargetInt();
+  }
+
+  Bars.Update (Touched); // Instead of TB[i].Update() for each bar, the function pads are simply left out.
+
+  for (byte i = 0; i < BarCount; i++)
+  {
+    if (TB[i].PadEvent() != 'Z')
+    {
+      Serial.print (F("Bar "));
+      Serial.print (i);
+      Serial.print (F(": tapped the "));
+      Serial.print (TB[i].PadEvent());
+      Serial.println (F(" pad."));
+    }
+    if (TB[i].GetTargetInt() != PreviousTarget[i])
+    {
+      Serial.print (F("Bar "));
+      Serial.print (i);
+      Serial.print (F(": target set to "));
+      Serial.print (TB[i].GetTargetFloat());
+      Serial.println (F("%"));
+    }
+    if (TB[i].Event() == true)
+    {
+      Serial.print (F("Bar "));
+      Serial.print (i);
+      Serial.print (F(": CPos: "));
+      Serial.print (TB[i].GetPositionFloat());
+      Serial.println (F("%"));
+    }
+  }
+}
@@ -0,0 +1,79 @@
+/*
+TouchBarLinear example - a long bar of 12 electrodes side by side, on all 12 inputs of an MPR121, electrode 0 at one end, electrode 11 at the other.
+Rather then swiping up and down over and over, touch it where you want it: with absolute mode on, the position jumps to where the finger is and follows it.
+Hold the bar at either end for a second to switch between absolute and relative (swipe) mode.
+
+
+Hardware requirements:
+- Same as the TouchBar-MPR121-Arduino example, except the bar: 12 electrodes in a row (any 2 to 16 work, just change PadCount).
+
+
+Libraries requirements: same as the TouchBar-MPR121-Arduino example.
+*/
+
+#include <Adafruit_MPR121.h>
+#include <TouchBar.h>
+
+#define PadCount 12
+
+// MPR121 Driver Object
+Adafruit_MPR121 TouchModule = Adafruit_MPR121();
+
+TouchBarCommon Common = {140, 20}; // unsigned int TapTimeout, byte TwitchSuppressionDelay (same as for a TouchBar)
+TouchBarConfig Config;
+TouchBarLinear TB (&Common, &Config, PadCount); // It takes: TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr, byte PadCount
+
+boolean Absolute = true;
+unsigned int Held = 0;
+
+void setup ()
+{
+  Serial.begin(115200);
+
+  if (!TouchModule.begin(0x5A))
+  {
+    Serial.println(F("MPR121 not found!"));
+    while (1);
+  }
+
+  Config.Default = 5000;
+  Config.Limit = 10000;
+  Config.Resolution = 20; // Per half electrode when swiping, a swipe over the whole bar is 22 * 20 = 440.
+  Config.RampDelay = 2;
+  Config.RampResolution = 50;
+  Config.SetFlags(false, false, true, false); // SpringBackFlag, SnapFlag, RampFlag, FlipFlag; with Ramp on the jumps in absolute mode glide rather then jump.
+  TB.SetPosition(Config.Default);
+  TB.SetAbsolute(Absolute);
+
+  Serial.println(F("Initialization done!"));
+}
+
+void loop ()
+{
+  unsigned int Touched = TouchModule.touched();
+  TB.Update (Touched); // All 12 bits at once
+
+  // Holding pad 0 or the last pad alone for about a second switches modes.
+  if (TB.GetPads() == 1 || TB.GetPads() == 1 << (PadCount - 1))
+    Held += 1;
+  else
+    Held = 0;
+  if (Held == 1000)
+  {
+    Absolute = !Absolute;
+    TB.SetAbsolute(Absolute);
+    Serial.println(Absolute ? F("Absolute mode") : F("Relative mode"));
+  }
+
+  if (TB.PadEvent() != 'Z')
+  {
+    Serial.print (F("Tapped pad "));
+    Serial.println (TB.PadEvent() - 'A');
+  }
+  if (TB.Event() == true)
+  {
+    Serial.print (F("CPos: "));
+    Serial.print (TB.GetPositionFloat());
+    Serial.println (F("%"));
+  }
+}
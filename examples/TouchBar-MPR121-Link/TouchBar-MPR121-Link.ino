@@ -0,0 +1,70 @@
+/*
+Link example - the same touch bar as the TouchBar-MPR121-Arduino example, reporting over a TouchBarLink rather then a line of text per change.
+The position, target, taps and gestures go out as small binary frames (at most one every 20 ms, nothing while nothing changes), and the settings can be read and changed from the PC while it runs.
+On the PC: extras/LinkDecode turns what comes in into CSV, TouchBarLinkHost.h does the same in your own program and builds the commands.
+The Serial Monitor shows only garbage now, that's all right.
+
+
+Hardware and library requirements: same as the TouchBar-MPR121-Arduino example.
+*/
+
+#include <Adafruit_MPR121.h>
+#include <TouchBar.h>
+
+#ifndef TouchBarGestures
+  #error Uncomment #define TouchBarGestures at the top of TouchBar.h for this example. (A #define here doesn't reach the library files.)
+#endif
+
+// MPR121 Driver Object
+Adafruit_MPR121 TouchModule = Adafruit_MPR121();
+
+TouchBarCommon Common = {140, 20}; // unsigned int TapTimeout, byte TwitchSuppressionDelay
+TouchBarConfig Config[2];
+TouchBar TB (&Common, &Config[0]);
+boolean Fine = false;
+
+void SendByte (byte Data)
+{
+  Serial.write(Data);
+}
+
+int Room () // Bytes that fit the TX buffer without waiting
+{
+  return Serial.availableForWrite();
+}
+
+TouchBarLink Link (&TB, &Common, Config, 2, SendByte, Room); // Every 20000 us at most, Id 0
+
+void setup ()
+{
+  Serial.begin(115200);
+
+  if (!TouchModule.begin(0x5A))
+    while (1); // No text on a binary line, the PC would take it for frames. It just sends nothing.
+
+  Config[0].Default = 5000;
+  Config[0].Limit = 10000;
+  Config[0].Resolution = 100;
+  Config[0].RampDelay = 100;
+  Config[0].RampResolution = 25;
+  Config[0].SetFlags(false, true, false, false);
+  Config[0].Gestures = 1 << DoubleTapGesture | 1 << LongPressGesture;
+  Config[1] = Config[0];
+  Config[1].Resolution = 10; // A fine mode, write LinkResolution of config 1 from the PC to try others.
+  TB.SetPosition(Config[0].Default);
+}
+
+void loop ()
+{
+  TB.Update (TouchModule.touched());
+  Link.Service();
+
+  while (Serial.available())
+    Link.Receive(Serial.read());
+
+  if (TB.GetGesture() == LongPressGesture) // Switches between the two configs, the PC sees the gesture, the position goes on as usual.
+  {
+    Fine = !Fine;
+    TB.Reconfigure(&Config[Fine]);
+  }
+}
@@ -0,0 +1,340 @@
+/*
+AnalogCheck - host tool that checks UpdateAnalog() of TouchBar and TouchBarLinear, with a finger slid along the bar: each pad reads how much of the finger is over it (a triangle, wider or narrower then a pad, of random strength).
+
+TouchBar (the readings also thresholded into pads and given to Update() of a second bar, to compare):
+- A slide over a whole number of pads moves the position exactly as far as Update() does, 2 * Resolution per pad, at any speed and smoothing, from anywhere on a pad. Back the same way ends exactly where it started.
+- It's smooth: no move of more then a Resolution in one update, and many more moves then Update() makes.
+- The Flip flag turns it round, the Ramp flag moves the target instead (the position ramps there), RollOver goes round the Limit and SpringBack springs back, all ending where Update() does.
+- A tap is a tap (PadEvent()), readings under the Threshold are nothing at all, and a finger held still doesn't wander.
+TouchBarLinear (2 to 16 pads):
+- Relative: a slide from pad to pad moves 2 * Resolution per pad, and back ends exactly where it started.
+- Absolute: a finger held on pad k gives Limit * k / (PadCount - 1), and sliding it along never goes backwards.
+
+Build it from the library folder like so (TouchBarAnalog has to be defined, here or at the top of TouchBar.h):
+g++ -O2 -DTouchBarAnalog -I . *.cpp extras/AnalogCheck/AnalogCheck.cpp -o AnalogCheck
+
+Then:
+./AnalogCheck <<< Runs the check, returns non-zero on any failure.
+./AnalogCheck 1000 <<< Same, with the given number of random slides (300 by default).
+*/
+
+#include "TouchBar.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#ifndef TouchBarAnalog
+#error "AnalogCheck needs TouchBarAnalog, build it with -DTouchBarAnalog"
+#endif
+
+static long Errors = 0;
+
+static void Expect (boolean Condition, const char *What)
+{
+  if (!Condition)
+  {
+    printf ("FAILED: %s\n", What);
+    Errors++;
+  }
+}
+
+static double Random (double From, double To)
+{
+  return From + (To - From) * rand () / RAND_MAX;
+}
+
+struct Finger
+{
+  double Width; // Pads, from the middle to where it stops touching
+  unsigned int Peak; // Reading with the finger right on the pad
+  unsigned int Threshold;
+  double Noise; // Of the Peak, each reading
+}; // <<< ; at the end is important!!!
+
+static unsigned int Reading (const Finger *F, double At, double Pad) // How much of the finger (At, in pads) is over the pad (its middle at Pad)
+{
+  double Distance = fabs (At - Pad);
+  double Value = 0;
+  if (Distance < F->Width)
+    Value = F->Peak * (1 - Distance / F->Width);
+  if (F->Noise != 0 && Value > 0)
+    Value += F->Peak * Random (-F->Noise, F->Noise);
+  if (Value < 0)
+    return 0;
+  if (Value > 65535)
+    return 65535;
+  return Value;
+}
+
+
+
+static void RandomFinger (Finger *F) // Always on 1 or 2 pads: over the Threshold half way between 2 pads, under it a whole pad away.
+{
+  double Threshold = Random (0.2, 0.35);
+  F->Width = Random (0.55 / (1 - Threshold), 0.95 / (1 - Threshold));
+  F->Peak = 200 + rand () % 3000;
+  F->Threshold = F->Peak * Threshold;
+}
+
+
+
+/* TouchBar */
+struct Pair // The same slide into UpdateAnalog() and, thresholded, into Update()
+{
+  TouchBar *Analog;
+  TouchBar *Digital;
+  const Finger *F;
+  unsigned long Moves; // Position changes of each
+  unsigned long DigitalMoves;
+  TouchBarPosition Biggest; // Move in one update
+  TouchBarPosition Around; // The Limit with RollOver (going round isn't a big move), 0 without
+}; // <<< ; at the end is important!!!
+
+static void Touch (Pair *P, double At) // At < 0: let go
+{
+  unsigned int Readings[3] = {0, 0, 0};
+  byte Pads = 0;
+  if (At >= 0)
+    for (byte i = 0; i < 3; i++)
+    {
+      // The stripes repeat A, B, C along the bar, pad i is under i, i + 3, i + 6...
+      for (int k = 0; k < 40; k++)
+        Readings[i] += Reading (P->F, At, i + 3 * k);
+      if (Readings[i] >= P->F->Threshold)
+        Pads |= 1 << i;
+    }
+  TouchBarPosition Before = P->Analog->GetPositionInt (), DigitalBefore = P->Digital->GetPositionInt ();
+  P->Analog->UpdateAnalog (Readings[0], Readings[1], Readings[2]);
+  P->Digital->Update (Pads);
+  TouchBarPosition After = P->Analog->GetPositionInt ();
+  if (After != Before)
+    P->Moves += 1;
+  if (P->Digital->GetPositionInt () != DigitalBefore)
+    P->DigitalMoves += 1;
+  TouchBarPosition Move = After > Before ? After - Before : Before - After;
+  if (P->Around != 0 && Move > P->Around / 2)
+    Move = P->Around + 1 - Move;
+  if (Move > P->Biggest)
+    P->Biggest = Move;
+}
+
+static void Slide (Pair *P, double From, double To, double Speed) // Speed in pads per update
+{
+  int Updates = (int) ceil (fabs (To - From) / Speed);
+  for (int i = 0; i <= Updates; i++)
+    Touch (P, From + (To - From) * i / Updates);
+}
+
+static void Hold (Pair *P, double At, int Updates)
+{
+  for (int i = 0; i < Updates; i++)
+    Touch (P, At);
+}
+
+static void CheckSlide (long Run)
+{
+  char What[200];
+  Finger F;
+  RandomFinger (&F);
+  F.Noise = 0;
+  TouchBarCommon Common = {150, (byte)(rand () % 5)};
+  TouchBarConfig Config;
+  Config.Limit = 60000;
+  Config.Default = 30000;
+  Config.Resolution = 1 + rand () % 200;
+  Config.RampDelay = 1 + rand () % 5;
+  Config.RampResolution = 1 + rand () % 200;
+  byte Flags = rand () % 4; // Plain, Flip, Ramp, RollOver
+  if (Flags == 3)
+  {
+    Config.Limit = 1000 + rand () % 3000;
+    Config.Default = rand () % Config.Limit;
+    Config.SetFlags (true, false);
+  }
+  else
+    Config.SetFlags (false, false, Flags == 2, Flags == 1);
+  TouchBar Analog (&Common, &Config), Digital (&Common, &Config);
+  Analog.SetPosition (Config.Default);
+  Digital.SetPosition (Config.Default);
+  Analog.SetAnalog (F.Threshold, rand () % 5);
+  Pair P = {&Analog, &Digital, &F, 0, 0, 0, (TouchBarPosition)(Flags == 3 ? Config.Limit : 0)};
+
+  double Start = Random (9, 12), Speed = Random (0.002, 0.05);
+  int Pads = (1 + rand () % 8) * (rand () % 2 ? 1 : -1);
+  Hold (&P, Start, 50);
+  Slide (&P, Start, Start + Pads, Speed);
+  Hold (&P, Start + Pads, 200); // Long enough for the smoothing
+  long Moved = (long) (Flags == 2 ? Analog.GetTargetInt () : Analog.GetPositionInt ()) - Config.Default; // The ramp may take a while yet
+  long DigitalMoved = (long) (Flags == 2 ? Digital.GetTargetInt () : Digital.GetPositionInt ()) - Config.Default;
+  if (Flags == 3)
+    snprintf (What, sizeof (What), "run %ld, RollOver: %d pads ends where Update() does, %u and %u", Run, Pads, Analog.GetPositionInt (), Digital.GetPositionInt ());
+  else
+    snprintf (What, sizeof (What), "run %ld: %d pads, Resolution %u moves %ld (Update(): %ld), %ld expected", Run, Pads, (unsigned int) Config.Resolution, Moved, DigitalMoved, (Flags == 1 ? -2L : 2L) * Pads * Config.Resolution);
+  if (Flags != 3)
+    Expect (Moved == DigitalMoved && Moved == (Flags == 1 ? -2L : 2L) * Pads * Config.Resolution, What);
+  else
+    Expect (Analog.GetPositionInt () == Digital.GetPositionInt (), What);
+  snprintf (What, sizeof (What), "run %ld: smooth, at most a Resolution per update (%u) and more moves then Update() (%lu, %lu)", Run, (unsigned int) P.Biggest, P.Moves, P.DigitalMoves);
+  Expect (Flags == 2 || P.Biggest <= Config.Resolution && (P.Moves > P.DigitalMoves || Config.Resolution == 1), What); // The ramp moves the way it always does, and there's nothing finer then a Resolution of 1
+
+  Slide (&P, Start + Pads, Start, Speed);
+  Hold (&P, Start, 200);
+  for (long i = 0; i < 100000 && (Analog.GetPositionInt () != Analog.GetTargetInt () || Digital.GetPositionInt () != Digital.GetTargetInt ()); i++)
+    Touch (&P, Start); // Till the ramp gets there
+  snprintf (What, sizeof (What), "run %ld: back exactly where it started, %u (Update(): %u), %u expected", Run, Analog.GetPositionInt (), Digital.GetPositionInt (), Config.Default);
+  Expect (Analog.GetPositionInt () == Config.Default && Digital.GetPositionInt () == Config.Default, What);
+}
+
+static void CheckTouchBar ()
+{
+  Finger F = {1.0, 1000, 300, 0};
+  TouchBarCommon Common = {150, 3};
+  TouchBarConfig Config;
+  Config.Limit = 10000;
+  Config.Default = 5000;
+  Config.Resolution = 100;
+  Config.SetFlags (true, false, false, false);
+  TouchBar Analog (&Common, &Config), Digital (&Common, &Config);
+  Analog.SetPosition (5000);
+  Digital.SetPosition (5000);
+  Analog.SetAnalog (F.Threshold);
+  Pair P = {&Analog, &Digital, &F, 0, 0, 0, 0};
+
+  // The numbers in the documentation: 6 pads, Resolution 100
+  Hold (&P, 10, 50);
+  Slide (&P, 10, 16, 0.01);
+  Hold (&P, 16, 100);
+  printf ("6 pads, Resolution 100: UpdateAnalog() %d, Update() %d, in %lu and %lu moves\n", Analog.GetPositionInt () - 5000, Digital.GetPositionInt () - 5000, P.Moves, P.DigitalMoves);
+  Expect (Analog.GetPositionInt () == 6200 && Digital.GetPositionInt () == 6200, "6 pads, Resolution 100: 1200 both ways");
+
+  // SpringBack: back to Default when let go, same as Update()
+  Hold (&P, -1, 100);
+  Expect (Analog.GetPositionInt () == 5000 && Digital.GetPositionInt () == 5000, "SpringBack springs back");
+  Expect (Analog.Idle (), "Idle() once let go");
+
+  // A tap
+  char Tap = 'Z', DigitalTap = 'Z';
+  Hold (&P, 10, 1);
+  for (int i = 0; i < 60; i++)
+  {
+    Touch (&P, i < 30 ? 7 : -1); // Pad B is under 1, 4, 7...
+    if (Analog.PadEvent () != 'Z')
+      Tap = Analog.PadEvent ();
+    if (Digital.PadEvent () != 'Z')
+      DigitalTap = Digital.PadEvent ();
+  }
+  Expect (Tap == 'B' && DigitalTap == 'B', "a tap on B is a tap on B");
+
+  // Under the Threshold: nothing at all
+  Finger Light = {1.0, 250, 300, 0};
+  P.F = &Light;
+  Config.SetFlags (false, false, false, false);
+  Analog.SetPosition (5000);
+  Hold (&P, -1, 20);
+  Slide (&P, 10, 16, 0.01);
+  Expect (Analog.GetPositionInt () == 5000 && Analog.Idle () && Analog.Event () == false, "readings under the Threshold do nothing");
+
+  // Held still, with 5% noise on every reading: it may twitch, but not wander off
+  Finger Noisy = {1.2, 2000, 600, 0.05};
+  P.F = &Noisy;
+  TouchBarPosition Lowest = 5000, Highest = 5000;
+  Hold (&P, 10.3, 50);
+  for (int i = 0; i < 5000; i++)
+  {
+    Touch (&P, 10.3);
+    if (Analog.GetPositionInt () < Lowest)
+      Lowest = Analog.GetPositionInt ();
+    if (Analog.GetPositionInt () > Highest)
+      Highest = Analog.GetPositionInt ();
+  }
+  printf ("Held still with 5%% noise: %d to %d\n", Lowest - 5000, Highest - 5000);
+  Expect (Highest - Lowest <= Config.Resolution / 4, "held still with noise, within a quarter Resolution");
+}
+
+
+
+/* TouchBarLinear */
+static unsigned int LinearReadings[16];
+
+static void LinearTouch (TouchBarLinear *Bar, const Finger *F, byte Count, double At)
+{
+  for (byte i = 0; i < Count; i++)
+    LinearReadings[i] = At < 0 ? 0 : Reading (F, At, i);
+  Bar->UpdateAnalog (LinearReadings);
+}
+
+static void CheckLinear (long Run)
+{
+  char What[200];
+  Finger F;
+  RandomFinger (&F);
+  F.Noise = 0;
+  byte Count = 4 + rand () % 13;
+  TouchBarCommon Common = {150, (byte)(rand () % 5)};
+  TouchBarConfig Config;
+  Config.Limit = 60000;
+  Config.Default = 30000;
+  Config.Resolution = 1 + rand () % 200;
+  Config.SetFlags (false, false, false, false);
+  TouchBarLinear Bar (&Common, &Config, Count);
+  Bar.SetPosition (Config.Default);
+  Bar.SetAnalog (F.Threshold, rand () % 5);
+
+  // Relative, from pad to pad (not the end ones, the finger is only half on the bar there)
+  int From = 1 + rand () % (Count - 2), To = 1 + rand () % (Count - 2);
+  double Speed = Random (0.002, 0.05);
+  int Updates = (int) ceil (abs (To - From) / Speed);
+  for (int i = 0; i < 50; i++)
+    LinearTouch (&Bar, &F, Count, From);
+  for (int i = 0; i <= Updates; i++)
+    LinearTouch (&Bar, &F, Count, From + (double) (To - From) * i / (Updates ? Updates : 1));
+  for (int i = 0; i < 200; i++)
+    LinearTouch (&Bar, &F, Count, To);
+  long Moved = (long) Bar.GetPositionInt () - Config.Default;
+  snprintf (What, sizeof (What), "linear run %ld, %u pads: pad %d to %d moves %ld, %ld expected", Run, Count, From, To, Moved, 2L * (To - From) * Config.Resolution);
+  Expect (Moved == 2L * (To - From) * Config.Resolution, What);
+  for (int i = 0; i <= Updates; i++)
+    LinearTouch (&Bar, &F, Count, To + (double) (From - To) * i / (Updates ? Updates : 1));
+  for (int i = 0; i < 200; i++)
+    LinearTouch (&Bar, &F, Count, From);
+  snprintf (What, sizeof (What), "linear run %ld, %u pads: back exactly where it started, %u", Run, Count, Bar.GetPositionInt ());
+  Expect (Bar.GetPositionInt () == Config.Default, What);
+  for (int i = 0; i < 100; i++)
+    LinearTouch (&Bar, &F, Count, -1);
+
+  // Absolute: the pad held gives its place along the bar, and a slide never goes backwards.
+  Bar.SetAbsolute (true);
+  int Pad = 1 + rand () % (Count - 2);
+  for (int i = 0; i < 200; i++)
+    LinearTouch (&Bar, &F, Count, Pad);
+  TouchBarPosition Expected = (TouchBarPosition) ((unsigned long) Config.Limit * Pad / (Count - 1));
+  snprintf (What, sizeof (What), "linear run %ld, %u pads, absolute: pad %d gives %u, %u expected", Run, Count, Pad, Bar.GetPositionInt (), Expected);
+  Expect (abs ((long) Bar.GetPositionInt () - Expected) <= 1, What);
+  TouchBarPosition Previous = Bar.GetPositionInt ();
+  boolean Forwards = true;
+  for (double At = Pad; At <= Count - 2; At += 0.01)
+  {
+    LinearTouch (&Bar, &F, Count, At);
+    Forwards &= Bar.GetPositionInt () >= Previous;
+    Previous = Bar.GetPositionInt ();
+  }
+  snprintf (What, sizeof (What), "linear run %ld, %u pads, absolute: sliding up never goes backwards", Run, Count);
+  Expect (Forwards, What);
+}
+
+
+
+int main (int argc, char **argv)
+{
+  long Runs = 300;
+  if (argc > 1)
+    Runs = atol (argv[1]);
+  srand (1);
+  CheckTouchBar ();
+  for (long i = 0; i < Runs; i++)
+    CheckSlide (i);
+  for (long i = 0; i < Runs; i++)
+    CheckLinear (i);
+  printf ("%ld failures\n", Errors);
+  return Errors != 0;
+}
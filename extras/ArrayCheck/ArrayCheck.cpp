@@ -0,0 +1,207 @@
+/*
+ArrayCheck - host tool that checks TouchBarArray::Update() against the same bars demultiplexed by hand and updated on every sample, the way the MPR121 examples used to do it.
+
+- 1 to 10 bars on one touch word, each with its own random script (mostly idle, so skipping comes up a lot), sharing a few random Configs with Ramp, Snap, SpringBack, RollOver and Flip, counting Update() calls and with a Clock.
+- The default layout (bar N on bits 3N - 3N+2) and an ElectrodeMap scattering the pads over all 32 bits (2 MPR121s and more), in any order.
+- The electrodes no bar is on flicker at random, that mustn't wake anything up.
+- After every sample each bar gives the same PadEvent(), Event(), Idle(), position and target as its twin, and the same Snapshot() (RampCounter, pad history, twitch suppression...).
+- The callback reports the same events, with the same values and Time, in the same order.
+
+Build it from the library folder like so:
+g++ -O2 -I . *.cpp extras/ArrayCheck/ArrayCheck.cpp -o ArrayCheck
+
+Then:
+./ArrayCheck <<< Runs the check, returns non-zero on any failure.
+./ArrayCheck 1000 <<< Same, with the given number of runs (100 by default).
+*/
+
+#include "TouchBar.h"
+#include "TouchBarSimulator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static long Errors = 0;
+
+static void Expect (boolean Condition, const char *What)
+{
+  if (!Condition)
+  {
+    printf ("FAILED: %s\n", What);
+    Errors++;
+  }
+}
+
+static void Record (const TouchBarEvent *Event, void *Context)
+{
+  ((std::vector<TouchBarEvent> *) Context)->push_back (*Event);
+}
+
+static void RandomScript (TouchBarSimulator *Sim)
+{
+  Sim->Clear ();
+  Sim->Idle (rand () % 200000);
+  for (int i = 0; i < 15; i++)
+  {
+    unsigned long Step = 200 + rand () % 5000;
+    switch (rand () % 6)
+    {
+      case 0: Sim->Tap ('A' + rand () % 3, 500 + rand () % 40000);
+      break;;
+      case 1: Sim->LightSwipe (rand () % 2, 1 + rand () % 40, Step);
+      break;;
+      case 2: Sim->HardSwipe (rand () % 2, 1 + rand () % 40, Step);
+      break;;
+      case 3: Sim->SkipSwipe (rand () % 2, 1 + rand () % 40, Step);
+      break;;
+      case 4: Sim->Hold (rand () % 8, 500 + rand () % 100000);
+      break;;
+      case 5: Sim->Twitch (rand () % 2 ? 0 : 1 << rand () % 3, 'A' + rand () % 3, 1 + rand () % 5, 100 + rand () % 1000);
+      break;;
+    }
+    Sim->Idle (rand () % 300000); // Long pauses, the other bars carry on meanwhile.
+  }
+}
+
+static boolean SameSnapshot (const TouchBarSnapshot *A, const TouchBarSnapshot *B)
+{
+  return A->Current == B->Current && A->Target == B->Target && A->RampCounter == B->RampCounter && A->Direction == B->Direction && A->ABCPads == B->ABCPads
+         && A->ABCPrevious[0] == B->ABCPrevious[0] && A->ABCPrevious[1] == B->ABCPrevious[1] && A->ABCPrevious[2] == B->ABCPrevious[2] && A->TSCounter == B->TSCounter;
+}
+
+static unsigned long Samples = 0, Skipped = 0, Reported = 0;
+
+static void Run (boolean WallClock, boolean Mapped)
+{
+  byte Count = 1 + rand () % 10;
+  byte Map[30];
+  if (Mapped) // Any 3 * Count of the 32 electrodes, in any order
+  {
+    byte Electrodes[32];
+    for (byte i = 0; i < 32; i++)
+      Electrodes[i] = i;
+    for (byte i = 31; i > 0; i--)
+    {
+      byte j = rand () % (i + 1), Swap = Electrodes[i];
+      Electrodes[i] = Electrodes[j];
+      Electrodes[j] = Swap;
+    }
+    for (byte i = 0; i < 3 * Count; i++)
+      Map[i] = Electrodes[i];
+  }
+  else
+    for (byte i = 0; i < 3 * Count; i++)
+      Map[i] = i;
+  unsigned long Used = 0;
+  for (byte i = 0; i < 3 * Count; i++)
+    Used |= 1UL << Map[i];
+
+  TouchBarCommon Common = {(unsigned int)(20 + rand () % 300), (byte)(rand () % 10), WallClock ? micros : 0, (unsigned long)(20000 + rand () % 200000), (unsigned long)(rand () % 2000)};
+  TouchBarConfig Configs[3];
+  for (byte c = 0; c < 3; c++)
+  {
+    TouchBarConfig *Config = &Configs[c];
+    Config->Limit = 100 + rand () % (rand () % 2 ? 500 : 60000);
+    Config->Default = rand () % (Config->Limit + 1);
+    Config->Resolution = 1 + rand () % 100;
+    Config->RampDelay = 1 + rand () % 20;
+    Config->RampResolution = 1 + rand () % 100;
+    Config->RampTime = rand () % 3000;
+    if (rand () % 4 == 0)
+      Config->SetFlags ((boolean)true, (boolean)(rand () % 2));
+    else
+      Config->SetFlags ((boolean)(rand () % 2), (boolean)(rand () % 2), (boolean)(rand () % 3 != 0), (boolean)(rand () % 2)); // Ramp most of the time, for the RampCounter
+  }
+
+  std::vector<TouchBar> Bars, Twins; // Twins are demultiplexed by hand, and updated every sample.
+  std::vector<std::vector<TouchBarEvent> > Logs (Count), TwinLogs (Count);
+  std::vector<std::vector<byte> > Scripts (Count);
+  std::vector<TouchBarConfig *> Chosen;
+  unsigned long Period = 50 + rand () % 500, Length = 0;
+  for (byte i = 0; i < Count; i++)
+  {
+    TouchBarConfig *Config = &Configs[rand () % 3];
+    Chosen.push_back (Config);
+    Bars.push_back (TouchBar (&Common, Config));
+    Twins.push_back (TouchBar (&Common, Config));
+    TouchBarSimulator Sim (Period);
+    RandomScript (&Sim);
+    byte Sample;
+    while (Sim.Next (&Sample))
+      Scripts[i].push_back (Sample);
+    if (Scripts[i].size () > Length)
+      Length = Scripts[i].size ();
+  }
+  for (byte i = 0; i < Count; i++) // Not in the loop above, push_back() may have moved them.
+  {
+    Bars[i].SetPosition (Chosen[i]->Default);
+    Twins[i].SetPosition (Chosen[i]->Default);
+    Bars[i].SetCallback (Record, &Logs[i]);
+    Twins[i].SetCallback (Record, &TwinLogs[i]);
+  }
+  TouchBarArray Array (&Bars[0], Count, Mapped ? Map : 0);
+  Length += 1000000 / Period; // And a second with nothing touched at the end, for the ramps to finish.
+
+  SetVirtualMicros (rand ());
+  unsigned long Noise = 0;
+  std::vector<byte> Last (Count, 0);
+  for (unsigned long t = 0; t < Length; t++)
+  {
+    AdvanceVirtualMicros (Period);
+    if (rand () % 50 == 0)
+      Noise ^= 1UL << rand () % 32;
+    unsigned long Touched = Noise & ~Used;
+    for (byte i = 0; i < Count; i++)
+    {
+      byte Pads = t < Scripts[i].size () ? Scripts[i][t] : 0;
+      for (byte p = 0; p < 3; p++)
+        if (bitRead (Pads, p))
+          Touched |= 1UL << Map[3 * i + p];
+      Logs[i].clear ();
+      TwinLogs[i].clear ();
+    }
+
+    Array.Update (Touched);
+    for (byte i = 0; i < Count; i++)
+    {
+      byte Pads = bitRead (Touched, Map[3 * i]) | bitRead (Touched, Map[3 * i + 1]) << 1 | bitRead (Touched, Map[3 * i + 2]) << 2;
+      if (Twins[i].Idle () && Pads == Last[i])
+        Skipped++;
+      Last[i] = Pads;
+      Twins[i].Update (Pads);
+      Samples++;
+
+      TouchBar *Bar = &Bars[i], *Twin = &Twins[i];
+      Expect (Bar->PadEvent () == Twin->PadEvent (), "same PadEvent()");
+      Expect (Bar->Event () == Twin->Event (), "same Event()");
+      Expect (Bar->Idle () == Twin->Idle (), "same Idle()");
+      Expect (Bar->GetPositionInt () == Twin->GetPositionInt (), "same position");
+      Expect (Bar->GetTargetInt () == Twin->GetTargetInt (), "same target");
+      TouchBarSnapshot State = {}, TwinState = {};
+      Bar->Snapshot (&State);
+      Twin->Snapshot (&TwinState);
+      Expect (SameSnapshot (&State, &TwinState), "same Snapshot()");
+
+      boolean Same = Logs[i].size () == TwinLogs[i].size ();
+      for (size_t e = 0; Same && e < Logs[i].size (); e++)
+        Same = Logs[i][e].Type == TwinLogs[i][e].Type && Logs[i][e].Value == TwinLogs[i][e].Value && Logs[i][e].Time == TwinLogs[i][e].Time && Logs[i][e].Source == Bar;
+      Expect (Same, "same events, in the same order");
+      Reported += Logs[i].size ();
+    }
+  }
+}
+
+
+
+int main (int argc, char **argv)
+{
+  long Runs = 100;
+  if (argc > 1)
+    Runs = atol (argv[1]);
+  srand (1);
+  for (long i = 0; i < Runs; i++)
+    Run (i % 2, i % 4 < 2);
+  printf ("%lu bar updates (%lu skipped), %lu events reported, %ld failures\n", Samples, Skipped, Reported, Errors);
+  Expect (Skipped != 0 && Skipped != Samples, "some bars skipped, some not");
+  return Errors != 0;
+}
@@ -0,0 +1,218 @@
+/*
+Benchmark - host tool that times TouchBar::Update() over a fixed set of gesture workloads, for every flag combination SetFlags() takes and both Update() overloads.
+
+The workloads are rendered from TouchBarSimulator scripts once, up front, so only Update() itself is timed:
+  Idle            <<< Nothing touched (Update() returns straight away once the bar is Idle()).
+  LightSwipe      <<< Swiping up and down touching 1-2 pads at a time.
+  HardSwipe       <<< Same, pushing hard, 2-3 pads at a time.
+  SkipSwipe       <<< Swiping so fast every other pad state is missed (Increment2 / Decrement2).
+  TapStorm        <<< Taps on A, B and C, one after the other.
+  Twitch          <<< Barely touching the edge of a pad, it flickers on and off (the twitch suppression's work).
+  SpringBackRamp  <<< Short swipes, let go, and a long ramp back to Default (slow ramp, fine RampResolution).
+The settings are the same for all of them (RampDelay and RampResolution low, so the ramps are long), only the flags change:
+the 16 combinations of SetFlags(SpringBack, Snap, Ramp, Flip), and SetFlags(RollOver, Flip) with and without Flip.
+Each number is the best of a few rounds, so another process taking the CPU for a moment doesn't spoil it. It's host time, not board time, but the proportions carry over fairly well.
+The footprint part prints the RAM of each object here, for the flash (and RAM) of the library on a board (or a cross compiler) see Footprint.sh next to this file.
+
+Build it from the library folder like so:
+g++ -O2 -I . *.cpp extras/Benchmark/Benchmark.cpp -o Benchmark
+
+Then:
+./Benchmark <<< Prints ns per update and million updates per second for every workload, flag combination and Update() overload.
+./Benchmark 1000000 <<< Same, with (at least) the given number of samples per workload (200000 by default).
+./Benchmark 1000000 csv <<< Same, as CSV.
+*/
+
+#include "TouchBar.h"
+#include "TouchBarSimulator.h"
+#include "TouchBarFixed.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define Rounds 5
+
+struct Workload
+{
+  const char *Name;
+  std::vector<byte> Samples;
+};
+
+struct Flags
+{
+  const char *Name;
+  boolean RollOver, SpringBack, Snap, Ramp, Flip;
+};
+
+static volatile unsigned long Sink; // So the compiler can't drop the updates.
+
+static void Render (TouchBarSimulator *Sim, Workload *Load, unsigned long Count)
+{
+  // The script is repeated until there are enough samples.
+  byte Sample;
+  Load->Samples.clear ();
+  while (Load->Samples.size () < Count)
+  {
+    Sim->Rewind ();
+    while (Sim->Next (&Sample))
+      Load->Samples.push_back (Sample);
+  }
+}
+
+static void Workloads (std::vector<Workload> *Loads, unsigned long Count)
+{
+  TouchBarSimulator Sim (100);
+  Workload Load;
+
+  Load.Name = "Idle";
+  Sim.Clear ();
+  Sim.Idle (1000000);
+  Render (&Sim, &Load, Count);
+  Loads->push_back (Load);
+
+  Load.Name = "LightSwipe";
+  Sim.Clear ();
+  Sim.LightSwipe (true, 24, 3000);
+  Sim.LightSwipe (false, 24, 3000);
+  Render (&Sim, &Load, Count);
+  Loads->push_back (Load);
+
+  Load.Name = "HardSwipe";
+  Sim.Clear ();
+  Sim.HardSwipe (true, 24, 3000);
+  Sim.HardSwipe (false, 24, 3000);
+  Render (&Sim, &Load, Count);
+  Loads->push_back (Load);
+
+  Load.Name = "SkipSwipe";
+  Sim.Clear ();
+  Sim.SkipSwipe (true, 24, 3000);
+  Sim.SkipSwipe (false, 24, 3000);
+  Render (&Sim, &Load, Count);
+  Loads->push_back (Load);
+
+  Load.Name = "TapStorm";
+  Sim.Clear ();
+  for (char Pad = 'A'; Pad <= 'C'; Pad++)
+  {
+    Sim.Tap (Pad, 8000);
+    Sim.Idle (12000);
+  }
+  Render (&Sim, &Load, Count);
+  Loads->push_back (Load);
+
+  Load.Name = "Twitch";
+  Sim.Clear ();
+  Sim.Twitch (0, 'A', 20, 1500);
+  Sim.Twitch (2, 'C', 20, 1500);
+  Sim.Idle (5000);
+  Render (&Sim, &Load, Count);
+  Loads->push_back (Load);
+
+  Load.Name = "SpringBackRamp";
+  Sim.Clear ();
+  Sim.LightSwipe (true, 6, 3000);
+  Sim.Idle (200000);
+  Sim.LightSwipe (false, 6, 3000);
+  Sim.Idle (200000);
+  Render (&Sim, &Load, Count);
+  Loads->push_back (Load);
+}
+
+static double Time (TouchBarCommon *Common, TouchBarConfig *Config, const std::vector<byte> &Samples, boolean Pins)
+{
+  double Best = 1e30;
+  for (int Round = 0; Round < Rounds; Round++)
+  {
+    TouchBar TB (Common, Config); // A new one every round, so every round is the same.
+    unsigned long Start = HostNanos ();
+    if (Pins)
+      for (size_t i = 0; i < Samples.size (); i++)
+        TB.Update ((boolean)bitRead(Samples[i], 0), (boolean)bitRead(Samples[i], 1), (boolean)bitRead(Samples[i], 2)); // Like the digitalRead()s of 3 pins
+    else
+      for (size_t i = 0; i < Samples.size (); i++)
+        TB.Update (Samples[i]);
+    unsigned long Elapsed = HostNanos () - Start;
+    Sink += TB.GetPositionInt ();
+    if (Elapsed < Best)
+      Best = Elapsed;
+  }
+  return Best / Samples.size ();
+}
+
+struct Settings // For the size of a TouchBarFixed, any will do.
+{
+  static const unsigned int Default = 5000;
+  static const unsigned int Limit = 10000;
+  static const byte Resolution = 100;
+  static const byte RampDelay = 2;
+  static const byte RampResolution = 5;
+  static const boolean RollOver = false;
+  static const boolean SpringBack = false;
+  static const boolean Snap = false;
+  static const boolean Ramp = false;
+  static const boolean Flip = false;
+  static const unsigned int TapTimeout = 140;
+  static const byte TwitchSuppressionDelay = 4;
+}; // <<< ; at the end is important!!!
+
+int main (int argc, char **argv)
+{
+  unsigned long Count = argc > 1 ? atol (argv[1]) : 200000;
+  boolean Csv = argc > 2 && strcmp (argv[2], "csv") == 0;
+
+  static const Flags Combinations[18] = {
+    {"-", 0, 0, 0, 0, 0}, {"F", 0, 0, 0, 0, 1}, {"P", 0, 0, 0, 1, 0}, {"PF", 0, 0, 0, 1, 1},
+    {"N", 0, 0, 1, 0, 0}, {"NF", 0, 0, 1, 0, 1}, {"NP", 0, 0, 1, 1, 0}, {"NPF", 0, 0, 1, 1, 1},
+    {"S", 0, 1, 0, 0, 0}, {"SF", 0, 1, 0, 0, 1}, {"SP", 0, 1, 0, 1, 0}, {"SPF", 0, 1, 0, 1, 1},
+    {"SN", 0, 1, 1, 0, 0}, {"SNF", 0, 1, 1, 0, 1}, {"SNP", 0, 1, 1, 1, 0}, {"SNPF", 0, 1, 1, 1, 1},
+    {"R", 1, 0, 0, 0, 0}, {"RF", 1, 0, 0, 0, 1}};
+
+  std::vector<Workload> Loads;
+  Workloads (&Loads, Count);
+
+  TouchBarCommon Common = {140, 4};
+  TouchBarConfig Config;
+  Config.Default = 5000;
+  Config.Limit = 10000;
+  Config.Resolution = 100;
+  Config.RampDelay = 2;
+  Config.RampResolution = 5;
+
+  if (Csv)
+    printf ("Workload,Flags,ns/Update(byte),ns/Update(A,B,C),MUpdates/s(byte)\n");
+  else
+    printf ("Flags: R(ollOver), S(pringBack), N (Snap), P (Ramp), F(lip), - none. %lu+ samples per workload, best of %d rounds.\n\n%-16s %-5s %16s %16s %16s\n",
+            Count, Rounds, "Workload", "Flags", "ns/Update(byte)", "ns/Update(A,B,C)", "MUpdates/s(byte)");
+  for (size_t Load = 0; Load < Loads.size (); Load++)
+  {
+    double ByteSum = 0, BooleanSum = 0;
+    for (byte i = 0; i < 18; i++)
+    {
+      const Flags *F = &Combinations[i];
+      if (F->RollOver)
+        Config.SetFlags (F->RollOver, F->Flip);
+      else
+        Config.SetFlags (F->SpringBack, F->Snap, F->Ramp, F->Flip);
+      double Byte = Time (&Common, &Config, Loads[Load].Samples, false);
+      double Boolean = Time (&Common, &Config, Loads[Load].Samples, true);
+      ByteSum += Byte;
+      BooleanSum += Boolean;
+      if (Csv)
+        printf ("%s,%s,%.2f,%.2f,%.1f\n", Loads[Load].Name, F->Name, Byte, Boolean, 1000.0 / Byte);
+      else
+        printf ("%-16s %-5s %16.2f %16.2f %16.1f\n", Loads[Load].Name, F->Name, Byte, Boolean, 1000.0 / Byte);
+    }
+    if (Csv == false)
+      printf ("%-16s %-5s %16.2f %16.2f %16.1f\n\n", Loads[Load].Name, "avg", ByteSum / 18, BooleanSum / 18, 18000.0 / ByteSum);
+  }
+
+  if (Csv == false)
+  {
+    printf ("Footprint (RAM, this build): TouchBar %u bytes, TouchBarConfig %u, TouchBarCommon %u, TouchBarFixed %u. (Same for every flag combination, the flags are a byte of the config.)\n",
+            (unsigned)sizeof(TouchBar), (unsigned)sizeof(TouchBarConfig), (unsigned)sizeof(TouchBarCommon), (unsigned)sizeof(TouchBarFixed<Settings>));
+    printf ("Flash per flag combination: extras/Benchmark/Footprint.sh\n");
+  }
+  return 0;
+}
@@ -0,0 +1,29 @@
+// Compiled by Footprint.sh once per flag combination (the Footprint* macros), to see how much flash and RAM a TouchBarFixed with those flags takes.
+// One object, and the calls a sketch makes every loop (Update(), PadEvent(), Event(), GetPositionInt()).
+
+#include "TouchBar.h"
+#include "TouchBarFixed.h"
+
+struct Settings
+{
+  static const unsigned int Default = 5000;
+  static const unsigned int Limit = 10000;
+  static const byte Resolution = 100;
+  static const byte RampDelay = 2;
+  static const byte RampResolution = 5;
+  static const boolean RollOver = FootprintRollOver;
+  static const boolean SpringBack = FootprintSpringBack;
+  static const boolean Snap = FootprintSnap;
+  static const boolean Ramp = FootprintRamp;
+  static const boolean Flip = FootprintFlip;
+  static const unsigned int TapTimeout = 140;
+  static const byte TwitchSuppressionDelay = 4;
+}; // <<< ; at the end is important!!!
+
+TouchBarFixed<Settings> TB;
+
+unsigned int Footprint (byte Sample)
+{
+  TB.Update (Sample);
+  return TB.GetPositionInt () + TB.PadEvent () + TB.Event ();
+}
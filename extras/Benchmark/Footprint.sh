@@ -0,0 +1,53 @@
+#!/bin/sh
+# Footprint - flash and RAM of the library, of a TouchBarFixed for every flag combination SetFlags() takes, and of a TouchBar object with each optional feature.
+# The flags of an ordinary TouchBar are a byte of its config, they don't change its size, but a TouchBarFixed only keeps the code of the modes it uses.
+#
+# Run it from the library folder:
+# sh extras/Benchmark/Footprint.sh <<< Host compiler (g++ -Os), the proportions are about right, the bytes are not.
+# CXX=avr-g++ CXXFLAGS="-mmcu=atmega328p -DARDUINO=10819 -DF_CPU=16000000L -I path/to/arduino/cores/arduino -I path/to/arduino/variants/standard" sh extras/Benchmark/Footprint.sh <<< Real AVR numbers, the ones the "compiles to N bytes less" comments in the code are about.
+# (text = flash, data = flash and RAM, bss = RAM.)
+
+CXX=${CXX:-g++}
+SIZE=${SIZE:-size}
+case "$CXX" in
+  *avr-g++) SIZE=${SIZE_AVR:-avr-size} ;;
+esac
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+echo "Library, $CXX -Os (flash doesn't depend on the flags):"
+printf "%-28s %8s %8s %8s\n" File text data bss
+for File in TouchBar.cpp TouchBarRamp.cpp TouchBarSwipe.cpp TouchBarConfig.cpp TouchBarDirectionTable.cpp TouchBarEventRing.cpp TouchBarArray.cpp TouchBarLinear.cpp TouchBarAnalog.cpp TouchBarGesture.cpp TouchBarDeadline.cpp TouchBarMap.cpp TouchBarLink.cpp TouchBarState.cpp TouchBarStore.cpp TouchBarRecorder.cpp SaveToEERPOM.cpp; do
+  $CXX $CXXFLAGS -Os -std=gnu++11 -w -I . -c "$File" -o "$OUT/$File.o" || exit 1
+  $SIZE "$OUT/$File.o" | awk -v F="$File" 'NR == 2 {printf "%-28s %8d %8d %8d\n", F, $1, $2, $3}'
+done
+
+echo
+echo "TouchBarFixed (extras/Benchmark/Footprint.cpp) per flag combination: R(ollOver), S(pringBack), N (Snap), P (Ramp), F(lip), - none"
+printf "%-28s %8s %8s %8s\n" Flags text data bss
+for Flags in - F P PF N NF NP NPF S SF SP SPF SN SNF SNP SNPF R RF; do
+  Defines=""
+  for Flag in R:RollOver S:SpringBack N:Snap P:Ramp F:Flip; do
+    case "$Flags" in
+      *${Flag%%:*}*) Defines="$Defines -DFootprint${Flag#*:}=true" ;;
+      *) Defines="$Defines -DFootprint${Flag#*:}=false" ;;
+    esac
+  done
+  $CXX $CXXFLAGS -Os -std=gnu++11 -w -I . $Defines -c extras/Benchmark/Footprint.cpp -o "$OUT/Fixed$Flags.o" || exit 1
+  $SIZE "$OUT/Fixed$Flags.o" | awk -v F="$Flags" 'NR == 2 {printf "%-28s %8d %8d %8d\n", F, $1, $2, $3}'
+done
+
+echo
+echo "TouchBar object, $CXX (bss of one, the RAM every TouchBar object takes) per optional feature, see the top of TouchBar.h"
+printf "%-28s %8s\n" Features bss
+printf '#include "TouchBar.h"\nchar Object[sizeof (TouchBar)];\n' > "$OUT/Object.cpp"
+All="TouchBarRampProfiles TouchBarSwipeSpeed TouchBarDebouncer TouchBarAnalog TouchBarGestures"
+for Features in - $All all; do
+  case "$Features" in
+    -) Defines="" ;;
+    all) Defines=$(for Feature in $All; do printf " -D%s" $Feature; done) ;;
+    *) Defines="-D$Features" ;;
+  esac
+  $CXX $CXXFLAGS -Os -std=gnu++11 -w -I . $Defines -c "$OUT/Object.cpp" -o "$OUT/Object.o" || exit 1
+  $SIZE "$OUT/Object.o" | awk -v F="$Features" 'NR == 2 {printf "%-28s %8d\n", F, $3}'
+done
@@ -0,0 +1,222 @@
+/*
+CallbackCheck - host tool that checks TouchBar::SetCallback(): every event is reported exactly once, from the Update() it happened in, in the documented order, and matches what polling the bar says.
+
+- Random simulator scripts (taps, holds, light, hard and skipped swipes, twitches) with random settings and flags, counting Update() calls and with a Clock.
+- TapEvent when PadEvent() has a tap, with the same pad. TargetEvent and PositionEvent when GetTargetInt() / GetPositionInt() changed, with the new value. Event() is true just when there's a PositionEvent.
+- StepEvent with a direction. Without Ramp, RollOver, Snap and SpringBack the position moves by exactly that: Resolution for Increment / Decrement, twice for Increment2 / Decrement2, clamped at 0 and Limit.
+- LimitEvent only on the update the position gets to 0 or Limit (not again while it stays there, or pushes against it), and never with RollOver, even going round through 0.
+- Within an update the order is tap, gesture, step, target, position, limit, each at most once. Time is the Clock (or micros()), Source the bar, Context handed back as it was given.
+- Nothing is reported while the bar is Idle(), two bars sharing a function are told apart by Source, and SetCallback(0) stops it.
+
+Build it from the library folder like so:
+g++ -O2 -I . *.cpp extras/CallbackCheck/CallbackCheck.cpp -o CallbackCheck
+
+Then:
+./CallbackCheck <<< Runs the check, returns non-zero on any failure.
+./CallbackCheck 1000 <<< Same, with the given number of runs (200 by default).
+*/
+
+#include "TouchBar.h"
+#include "TouchBarSimulator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static long Errors = 0;
+
+static void Expect (boolean Condition, const char *What)
+{
+  if (!Condition)
+  {
+    printf ("FAILED: %s\n", What);
+    Errors++;
+  }
+}
+
+struct Log
+{
+  std::vector<TouchBarEvent> Events;
+  void *Context;
+}; // <<< ; at the end is important!!!
+
+static void Record (const TouchBarEvent *Event, void *Context)
+{
+  Log *L = (Log *) Context;
+  L->Events.push_back (*Event);
+  L->Context = Context;
+}
+
+static byte Rank (byte Type) // Order within an update: tap, gesture, step, target, position, limit
+{
+  switch (Type)
+  {
+    case TapEvent: return 0;
+    break;;
+    case GestureEvent: return 1;
+    break;;
+    case StepEvent: return 2;
+    break;;
+    case TargetEvent: return 3;
+    break;;
+    case PositionEvent: return 4;
+    break;;
+    case LimitEvent: return 5;
+    break;;
+  }
+  return 255;
+}
+
+static const TouchBarEvent *Find (Log *L, byte Type)
+{
+  for (size_t i = 0; i < L->Events.size (); i++)
+    if (L->Events[i].Type == Type)
+      return &L->Events[i];
+  return 0;
+}
+
+static void RandomScript (TouchBarSimulator *Sim)
+{
+  Sim->Clear ();
+  Sim->Idle (1000 + rand () % 10000);
+  for (int i = 0; i < 60; i++)
+  {
+    unsigned long Step = 200 + rand () % 5000;
+    switch (rand () % 6)
+    {
+      case 0: Sim->Tap ('A' + rand () % 3, 500 + rand () % 40000);
+      break;;
+      case 1: Sim->LightSwipe (rand () % 2, 1 + rand () % 60, Step);
+      break;;
+      case 2: Sim->HardSwipe (rand () % 2, 1 + rand () % 60, Step);
+      break;;
+      case 3: Sim->SkipSwipe (rand () % 2, 1 + rand () % 60, Step);
+      break;;
+      case 4: Sim->Hold (rand () % 8, 500 + rand () % 100000);
+      break;;
+      case 5: Sim->Twitch (rand () % 2 ? 0 : 1 << rand () % 3, 'A' + rand () % 3, 1 + rand () % 5, 100 + rand () % 1000);
+      break;;
+    }
+    Sim->Idle (rand () % 50000);
+  }
+  Sim->Idle (500000);
+}
+
+static unsigned long Counts[7];
+
+static void Run (boolean WallClock, boolean Plain)
+{
+  TouchBarCommon Common = {(unsigned int)(20 + rand () % 300), (byte)(rand () % 10), WallClock ? micros : 0, (unsigned long)(20000 + rand () % 200000), (unsigned long)(rand () % 2000)};
+  TouchBarConfig Config;
+  Config.Limit = 100 + rand () % (rand () % 2 ? 500 : 60000); // Small ones too, so the limits are hit often.
+  Config.Default = rand () % (Config.Limit + 1);
+  Config.Resolution = 1 + rand () % 100;
+  Config.RampDelay = 1 + rand () % 20;
+  Config.RampResolution = 1 + rand () % 100;
+  Config.RampTime = rand () % 3000;
+  if (Plain)
+    Config.SetFlags (false, false, false, (boolean)(rand () % 2));
+  else if (rand () % 3 == 0)
+    Config.SetFlags ((boolean)true, (boolean)(rand () % 2));
+  else
+    Config.SetFlags ((boolean)(rand () % 2), (boolean)(rand () % 2), (boolean)(rand () % 2), (boolean)(rand () % 2));
+
+  TouchBar Bar (&Common, &Config);
+  TouchBar Other (&Common, &Config); // Shares the function, gets the same pads.
+  Bar.SetPosition (Config.Default);
+  Other.SetPosition (Config.Default);
+  Log L, OtherLog;
+  Bar.SetCallback (Record, &L);
+  Other.SetCallback (Record, &OtherLog);
+
+  TouchBarSimulator Sim (50 + rand () % 500);
+  RandomScript (&Sim);
+  SetVirtualMicros (rand ());
+  byte Sample;
+  unsigned long Samples = 0;
+  unsigned long Stop = Sim.Samples () * 3 / 4; // SetCallback(0) from here on
+  while (Sim.Next (&Sample))
+  {
+    TouchBarPosition Position = Bar.GetPositionInt (), Target = Bar.GetTargetInt ();
+    boolean WasIdle = Bar.Idle ();
+    if (Samples == Stop)
+      Bar.SetCallback (0);
+    L.Events.clear ();
+    L.Context = 0;
+    OtherLog.Events.clear ();
+    Bar.Update (Sample);
+    Other.Update (Sample);
+    Samples++;
+
+    if (Samples > Stop)
+    {
+      Expect (L.Events.empty (), "nothing after SetCallback(0)");
+      continue;
+    }
+    if (WasIdle && Sample == 0)
+      Expect (L.Events.empty (), "nothing while Idle()");
+    if (!L.Events.empty ())
+      Expect (L.Context == &L, "Context handed back");
+    for (size_t i = 0; i < L.Events.size (); i++)
+    {
+      const TouchBarEvent *E = &L.Events[i];
+      Expect (E->Source == &Bar, "Source is the bar");
+      Expect (E->Time == micros (), "Time is the Clock (or micros()) of the update");
+      Expect (Rank (E->Type) != 255, "a known type");
+      if (i > 0)
+        Expect (Rank (L.Events[i - 1].Type) < Rank (E->Type), "tap, gesture, step, target, position, limit, each once");
+      Counts[E->Type] += 1;
+    }
+    for (size_t i = 0; i < OtherLog.Events.size (); i++)
+      Expect (OtherLog.Events[i].Source == &Other, "a shared function tells the bars apart by Source");
+
+    const TouchBarEvent *Tap = Find (&L, TapEvent);
+    char Pad = Bar.PadEvent ();
+    Expect ((Tap != 0) == (Pad != 'Z') && (Tap == 0 || Tap->Value == (TouchBarPosition) Pad), "TapEvent just when PadEvent() has a tap, with that pad");
+
+    const TouchBarEvent *Moved = Find (&L, TargetEvent);
+    Expect ((Moved != 0) == (Bar.GetTargetInt () != Target) && (Moved == 0 || Moved->Value == Bar.GetTargetInt ()), "TargetEvent just when the target changed, with the new one");
+
+    Moved = Find (&L, PositionEvent);
+    Expect ((Moved != 0) == (Bar.GetPositionInt () != Position) && (Moved == 0 || Moved->Value == Bar.GetPositionInt ()), "PositionEvent just when the position changed, with the new one");
+    Expect (Bar.Event () == (Moved != 0), "Event() just when there's a PositionEvent");
+
+    const TouchBarEvent *Limit = Find (&L, LimitEvent);
+    TouchBarPosition Now = Bar.GetPositionInt ();
+    boolean GotThere = Now != Position && (Now == 0 || Now == Config.Limit);
+    if (Config.GetRollOverFlag () == true)
+      Expect (Limit == 0, "no LimitEvent with RollOver");
+    else
+      Expect ((Limit != 0) == GotThere && (Limit == 0 || Limit->Value == Now), "LimitEvent just on the update the position gets to 0 or Limit");
+
+    const TouchBarEvent *Step = Find (&L, StepEvent);
+    if (Step != 0)
+      Expect (Step->Value == Increment || Step->Value == Increment2 || Step->Value == Decrement || Step->Value == Decrement2, "StepEvent with a direction");
+    if (Plain)
+    {
+      TouchBarPosition Expected = Position;
+      if (Step != 0)
+      {
+        boolean Up = Step->Value > Static;
+        byte Times = Step->Value == Increment2 || Step->Value == Decrement2 ? 2 : 1;
+        for (byte k = 0; k < Times; k++)
+          Expected = Up ? TouchBarUp (Expected, Config.Resolution, Config.Limit) : TouchBarDown (Expected, Config.Resolution);
+      }
+      Expect (Now == Expected, "the position moves by just the steps reported");
+    }
+  }
+}
+
+
+
+int main (int argc, char **argv)
+{
+  long Runs = 200;
+  if (argc > 1)
+    Runs = atol (argv[1]);
+  srand (1);
+  for (long i = 0; i < Runs; i++)
+    Run (i % 2, i % 4 < 2);
+  printf ("%lu taps, %lu steps, %lu targets, %lu positions, %lu limits reported, %ld failures\n", Counts[TapEvent], Counts[StepEvent], Counts[TargetEvent], Counts[PositionEvent], Counts[LimitEvent], Errors);
+  Expect (Counts[TapEvent] != 0 && Counts[StepEvent] != 0 && Counts[TargetEvent] != 0 && Counts[PositionEvent] != 0 && Counts[LimitEvent] != 0, "every event type came up");
+  return Errors != 0;
+}
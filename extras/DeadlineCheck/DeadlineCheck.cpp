@@ -0,0 +1,282 @@
+/*
+DeadlineCheck - host tool that checks TouchBar::NextDeadline(): a bar updated only when its pads change and when its deadline comes up has to do exactly what a bar updated all the time does.
+
+Two TouchBar objects (and two TouchBarLinear objects) share a Clock, both get the same random pads (taps, holds, swipes, twitches and long idle stretches), 10 us apart.
+One is updated on every sample, the other only when its pads change or NextDeadline() says it's due, as a sleeping board would. Every event (time, type, value) of the two has to match, and once the idle stretch at the end has settled the other one, the sleeper has to be at NoDeadline.
+Random settings every run: twitch suppression, ramp (stepped and every profile), acceleration, fling, gestures, and the flags. The times are whole multiples of the sample period, so the deadlines fall on a sample.
+
+Build it from the library folder like so (with the optional features the settings go to, see the top of TouchBar.h, it builds and passes without them too, it just checks less):
+g++ -O2 -DTouchBarRampProfiles -DTouchBarSwipeSpeed -DTouchBarDebouncer -DTouchBarGestures -I . *.cpp extras/DeadlineCheck/DeadlineCheck.cpp -o DeadlineCheck
+
+Then:
+./DeadlineCheck <<< Runs the check, returns non-zero on any mismatch.
+./DeadlineCheck 1000 <<< Same, with the given number of runs (200 by default).
+*/
+
+#include "TouchBar.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#define Period 10 // us between samples
+
+static unsigned long Clock = 0;
+
+static unsigned long GetClock ()
+{
+  return Clock;
+}
+
+struct Logged
+{
+  unsigned long Time;
+  byte Type;
+  TouchBarPosition Value;
+  bool operator != (const Logged &Other) const { return Time != Other.Time || Type != Other.Type || Value != Other.Value; }
+}; // <<< ; at the end is important!!!
+
+static void Log (const TouchBarEvent *Event, void *Context)
+{
+  Logged Entry = {Event->Time, Event->Type, Event->Value};
+  ((std::vector<Logged> *) Context)->push_back (Entry);
+}
+
+static unsigned long Random (unsigned long Max) // 0 to Max - 1
+{
+  return ((unsigned long) rand () << 16 ^ rand ()) % Max;
+}
+
+static unsigned long Multiple (unsigned long Max) // A whole number of sample periods
+{
+  return Random (Max / Period + 1) * Period;
+}
+
+// Pads, one sample per entry: touches, holds, swipes, twitches and idle stretches.
+static void Script (std::vector<unsigned int> *Samples, unsigned int Pads)
+{
+  static const byte Cycle[6] = {1, 3, 2, 6, 4, 5}; // A, AB, B, BC, C, CA
+  for (int Part = 0; Part < 60; Part++)
+  {
+    unsigned int Value = 0;
+    unsigned long Length = 0;
+    switch (rand () % 5)
+    {
+      case 0: // Idle
+        Length = 1 + Random (50000);
+      break;;
+      case 1: // Tap or hold
+        Value = 1 << rand () % Pads;
+        Length = 1 + Random (rand () % 2 ? 5000 : 100000);
+      break;;
+      case 2: // Swipe, fast or slow. TouchBar: round the A, B, C cycle. TouchBarLinear: along the bar, a pad, then 2 next to each other, then the next pad...
+      {
+        int Spot = rand () % 6;
+        int Half = rand () % (2 * Pads - 1);
+        boolean Up = rand () % 2;
+        unsigned long Speed = 1 + Random (rand () % 2 ? 100 : 3000);
+        int Steps = 1 + rand () % 20;
+        for (int Step = 0; Step < Steps; Step++)
+        {
+          unsigned int Touched;
+          if (Pads == 3)
+          {
+            Spot = (Spot + (Up ? 1 : 5)) % 6;
+            Touched = Cycle[Spot];
+          }
+          else
+          {
+            if (Up && Half < 2 * (int) Pads - 2)
+              Half += 1;
+            if (Up == false && Half > 0)
+              Half -= 1;
+            Touched = Half & 1 ? 3U << Half / 2 : 1U << Half / 2;
+          }
+          for (unsigned long i = 1 + Random (Speed); i > 0; i--)
+            Samples->push_back (Touched);
+        }
+      }
+      break;;
+      case 3: // Twitch
+        Value = Random (1 << Pads);
+        Length = 1 + Random (5);
+      break;;
+      case 4: // Chord
+        Value = Random (1 << Pads);
+        Length = 1 + Random (20000);
+      break;;
+    }
+    for (unsigned long i = 0; i < Length; i++)
+      Samples->push_back (Value);
+  }
+  for (unsigned long i = 0; i < 300000; i++) // Long enough for any ramp, fling or gesture to end.
+    Samples->push_back (0);
+}
+
+static void Randomize (TouchBarCommon *Common, TouchBarConfig *Config)
+{
+  Common->TapTime = Multiple (400000);
+  Common->TwitchSuppressionTime = rand () % 3 ? Multiple (5000) : 0;
+  Common->DebounceDelay = rand () % 5 == 0 ? 1 + rand () % 10 : 0;
+  Config->Limit = 1000 + Random (60000);
+  Config->Default = Random (Config->Limit);
+  Config->Resolution = 1 + rand () % 200;
+  Config->RampDelay = 1;
+  Config->RampResolution = 1 + rand () % 200;
+  Config->RampTime = rand () % 4 ? Multiple (20000) : 0;
+  Config->RampProfile = rand () % 4;
+  Config->AccelerationSpeed = rand () % 2 ? 20 + rand () % 200 : 0;
+  Config->AccelerationLimit = 1 + rand () % 8;
+  Config->FlingTime = rand () % 2 ? 1000 * Random (1500) : 0;
+  Config->FlingSpeed = rand () % 50;
+  Config->Gestures = rand () % 2 ? 0xFF : 0;
+  Config->MultiTapTime = Multiple (500000);
+  Config->LongPressTime = Multiple (1000000);
+  if (rand () % 4 == 0)
+    Config->SetFlags (true, rand () % 2);
+  else
+    Config->SetFlags (rand () % 2, rand () % 2, rand () % 2, rand () % 2);
+}
+
+// A TouchBar logs its own events (SetCallback()), a TouchBarLinear has none, its changes are logged after each update.
+static void SetLog (TouchBar *Object, std::vector<Logged> *Events)
+{
+  Object->SetCallback (Log, Events);
+}
+
+static void SetLog (TouchBarLinear *Object, std::vector<Logged> *Events)
+{
+}
+
+static void Record (TouchBar *Object, std::vector<Logged> *Events)
+{
+}
+
+static void Record (TouchBarLinear *Object, std::vector<Logged> *Events)
+{
+  Logged Entry = {Clock, PositionEvent, Object->GetPositionInt ()};
+  if (Object->Event ())
+    Events->push_back (Entry);
+  if (Object->PadEvent () != 'Z')
+  {
+    Entry.Type = TapEvent;
+    Entry.Value = Object->PadEvent ();
+    Events->push_back (Entry);
+  }
+}
+
+// Runs the samples through an always updated and a sleeping bar, returns the number of mismatches. Wakes: updates the sleeper took.
+template <class Bar> static long Compare (Bar *Awake, Bar *Sleeper, const std::vector<unsigned int> &Samples, long Run, unsigned long *Wakes)
+{
+  std::vector<Logged> AwakeEvents, SleeperEvents;
+  SetLog (Awake, &AwakeEvents);
+  SetLog (Sleeper, &SleeperEvents);
+  unsigned int Last = 0;
+  unsigned long Due = 0; // Next wake, Clock time
+  boolean Sleeping = false; // At NoDeadline
+  for (size_t i = 0; i < Samples.size (); i++)
+  {
+    Clock += Period;
+    Awake->Update (Samples[i]);
+    Record (Awake, &AwakeEvents);
+    if (Samples[i] != Last || Sleeping == false && Clock - Due < 0x80000000UL)
+    {
+      Sleeper->Update (Samples[i]);
+      Record (Sleeper, &SleeperEvents);
+      *Wakes += 1;
+      unsigned long Wait = Sleeper->NextDeadline (Clock);
+      Sleeping = Wait == NoDeadline;
+      Due = Clock + (Wait == 0 ? Period : Wait);
+    }
+    Last = Samples[i];
+  }
+
+  long Errors = 0;
+  size_t Count = AwakeEvents.size () < SleeperEvents.size () ? AwakeEvents.size () : SleeperEvents.size ();
+  for (size_t i = 0; i < Count && Errors == 0; i++)
+    if (AwakeEvents[i] != SleeperEvents[i])
+    {
+      printf ("Run %ld: event %lu differs: %lu %u %lu updated always, %lu %u %lu sleeping\n", Run, (unsigned long) i, AwakeEvents[i].Time, AwakeEvents[i].Type, (unsigned long) AwakeEvents[i].Value,
+              SleeperEvents[i].Time, SleeperEvents[i].Type, (unsigned long) SleeperEvents[i].Value);
+      Errors += 1;
+    }
+  if (Errors == 0 && AwakeEvents.size () != SleeperEvents.size ())
+  {
+    printf ("Run %ld: %lu events updated always, %lu sleeping\n", Run, (unsigned long) AwakeEvents.size (), (unsigned long) SleeperEvents.size ());
+    Errors += 1;
+  }
+  if (Awake->GetPositionInt () != Sleeper->GetPositionInt () || Awake->GetTargetInt () != Sleeper->GetTargetInt ())
+  {
+    printf ("Run %ld: ends at %lu / %lu updated always, %lu / %lu sleeping\n", Run, (unsigned long) Awake->GetPositionInt (), (unsigned long) Awake->GetTargetInt (), (unsigned long) Sleeper->GetPositionInt (), (unsigned long) Sleeper->GetTargetInt ());
+    Errors += 1;
+  }
+  if (Awake->Idle () && Sleeper->NextDeadline (Clock) != NoDeadline) // A slow ramp can outlast the idle stretch.
+  {
+    printf ("Run %ld: still due in %lu us after the idle stretch\n", Run, Sleeper->NextDeadline (Clock));
+    Errors += 1;
+  }
+  return Errors;
+}
+
+int main (int argc, char **argv)
+{
+  long Runs = argc > 1 ? atol (argv[1]) : 200;
+  long Errors = 0;
+  unsigned long Samples = 0;
+  unsigned long Wakes = 0;
+  srand (1);
+
+  for (long Run = 0; Run < Runs; Run++)
+  {
+    TouchBarCommon Common = {140, 20};
+    TouchBarConfig Config;
+    Common.Clock = GetClock;
+    Clock = Random (0xFFFFFFFF);
+    Randomize (&Common, &Config);
+
+    std::vector<unsigned int> Stream;
+    if (Run % 4 != 3)
+    {
+      Script (&Stream, 3);
+      TouchBar Awake (&Common, &Config);
+      TouchBar Sleeper (&Common, &Config);
+      Errors += Compare (&Awake, &Sleeper, Stream, Run, &Wakes);
+    }
+    else
+    {
+      Common.DebounceDelay = 0; // TouchBarLinear doesn't have one.
+      byte Pads = 2 + rand () % 11;
+      Script (&Stream, Pads);
+      TouchBarLinear Awake (&Common, &Config, Pads);
+      TouchBarLinear Sleeper (&Common, &Config, Pads);
+      Errors += Compare (&Awake, &Sleeper, Stream, Run, &Wakes);
+    }
+    Samples += Stream.size ();
+  }
+
+  // TouchBarArray: the soonest of its bars.
+  TouchBarCommon Common = {140, 20};
+  Common.Clock = GetClock;
+  Common.TwitchSuppressionTime = 1000;
+  TouchBarConfig Config;
+  Config.Default = 50;
+  Config.Limit = 100;
+  Config.Resolution = 1;
+  Config.RampDelay = 1;
+  Config.RampResolution = 1;
+  TouchBar Bars[2] = {TouchBar (&Common, &Config), TouchBar (&Common, &Config)};
+  TouchBarArray Array (Bars, 2);
+  Array.Update (0);
+  Array.Update (0);
+  if (Array.NextDeadline (Clock) != NoDeadline)
+    Errors += 1;
+  Clock += 300;
+  Array.Update (0x08); // Pad A of bar 1
+  if (Array.NextDeadline (Clock) != 1000 || Array.NextDeadline (Clock + 400) != 600 || Bars[0].NextDeadline (Clock) != NoDeadline)
+  {
+    printf ("TouchBarArray: due in %lu us, should be 1000\n", Array.NextDeadline (Clock));
+    Errors += 1;
+  }
+
+  printf ("%ld runs, %lu samples, the sleeping bars woke up for %lu of them (%.2f%%), %ld errors.\n", Runs, Samples, Wakes, 100.0 * Wakes / Samples, Errors);
+  return Errors != 0;
+}
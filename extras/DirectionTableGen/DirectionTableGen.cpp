@@ -0,0 +1,313 @@
+/*
+DirectionTableGen - host tool that builds TouchBarDirectionTable.cpp, the lookup table TouchBar::GetDirection() uses, and checks it.
+
+The table is generated from the original chain of conditions below (which is what GetDirection() used to run on every update), so if you ever need to change how directions are
+decoded, change it here and regenerate the table rather then editing 4096 numbers by hand.
+
+Build it from the library folder like so:
+g++ -O2 -I . *.cpp extras/DirectionTableGen/DirectionTableGen.cpp -o DirectionTableGen
+
+Then:
+./DirectionTableGen > TouchBarDirectionTable.cpp <<< Regenerates the table.
+./DirectionTableGen --check <<< Compares the table compiled into the library against the conditions below for all 4096 pad histories, flipped and not flipped.
+*/
+
+#include "TouchBar.h"
+#include <stdio.h>
+#include <string.h>
+
+// Pads is the current state of the ABC pads, Previous0-2 are the last 3 different states before it. Returns the direction. (Pads == 0 is handled by GetDirection() itself.)
+static byte Reference (byte Pads, byte Previous0, byte Previous1, byte Previous2)
+{
+  if (Pads == 0)
+    return Static;
+
+  byte Direction;
+  /*
+  Signals in comments (for humans):
+  - T - Touched (Rising edge)
+  - H - Held (High)
+  - R - Released (Falling edge)
+  - LU - Left Untouched (Low)
+  */
+  Direction = Static;
+  
+  // The following does the same as the commented section above, except it compiles to 76-94 bytes less (depending on which Update method is used.).
+  // Light touch scenario (only touching 1-2 pads at a time.)
+  // Update: The condition for skipping a state change was added as an afterthought, which sped up the input significantly, but it can't be optimized the way it was before.
+  // Increment case 1/6
+  if (Pads == 3)
+  {
+    if (Previous0 == 1) // Normal (A=H, B=T, C=LU)
+      Direction = Increment;
+    if (Previous0 == 5) // Skiping (A=H, B=T, C=R)
+      Direction = Increment2;
+  }
+  // Increment case 2/6
+  if (Pads == 2)
+  {
+    if (Previous0 == 3) // Normal (A=R, B=H, C=LU)
+      Direction = Increment;
+    if (Previous0 == 1) // Skiping (A=R, B=T, C=LU)
+      Direction = Increment2;
+  }
+  // Increment case 3/6
+  if (Pads == 6)
+  {
+    if (Previous0 == 2) // Normal (A=LU, B=H, C=T)
+      Direction = Increment;
+    if (Previous0 == 3) // Skiping (A=R, B=H, C=T)
+      Direction = Increment2;
+  }
+  // Increment case 4/6
+  if (Pads == 4)
+  {
+    if (Previous0 == 6) // Normal (A=LU, B=R, C=H)
+      Direction = Increment;
+    if (Previous0 == 2) // Skiping (A=LU, B=R, C=T)
+      Direction = Increment2;
+  }
+  // Increment case 5/6
+  if (Pads == 5)
+  {
+    if (Previous0 == 4) // Normal (A=T, B=LU, C=H)
+      Direction = Increment;
+    if (Previous0 == 6) // Skiping (A=T, B=R, C=H)
+      Direction = Increment2;
+  }
+  // Increment case 6/6
+  if (Pads == 1)
+  {
+    if (Previous0 == 5) // Normal (A=H, B=LU, C=R)
+      Direction = Increment;
+    if (Previous0 == 4) // Skiping (A=T, B=LU, C=R)
+      Direction = Increment2;
+  }
+
+  // Decrement case 1/6
+  if (Pads == 5)
+  {
+    if (Previous0 == 1) // Normal (A=H, B=LU, C=T)
+      Direction = Decrement;
+    if (Previous0 == 3) // Skiping (A=H, B=R, C=T)
+      Direction = Decrement2;
+  }
+  // Decrement case 2/6
+  if (Pads == 4)
+  {
+    if (Previous0 == 5) // Normal (A=R, B=LU, C=H)
+      Direction = Decrement;
+    if (Previous0 == 1) // Skiping (A=R, B=LU, C=T)
+      Direction = Decrement2;
+  }
+  // Decrement case 3/6
+  if (Pads == 6)
+  {
+    if (Previous0 == 4) // Normal (A=LU, B=T, C=H)
+      Direction = Decrement;
+    if (Previous0 == 5) // Skiping (A=R, B=T, C=H)
+      Direction = Decrement2;
+  }
+  // Decrement case 4/6
+  if (Pads == 2)
+  {
+    if (Previous0 == 6) // Normal (A=LU, B=H, C=R)
+      Direction = Decrement;
+    if (Previous0 == 4) // Skiping (A=LU, B=T, C=R)
+      Direction = Decrement2;
+  }
+  // Decrement case 5/6
+  if (Pads == 3)
+  {
+    if (Previous0 == 2) // Normal (A=T, B=H, C=LU)
+      Direction = Decrement;
+    if (Previous0 == 6) // Skiping (A=T, B=H, C=R)
+      Direction = Decrement2;
+  }
+  // Decrement case 6/6
+  if (Pads == 1)
+  {
+    if (Previous0 == 3) // Normal (A=H, B=R, C=LU)
+      Direction = Decrement;
+    if (Previous0 == 2) // Skiping (A=T, B=R, C=LU)
+      Direction = Decrement2;
+  }
+  
+  /*
+  // Update: The condition for skipping can only be implemented for light touch, as the twitch suppression would filter out fast change on the same pin anyway, so it would not make sense.
+  // (It is hard to drag your finger so fast that if would skipp state change when you're pushing it hard on the surface, so it has very limited usefulness anyway.)
+  
+  // This commented section works as the next optimized section, however it's kept cause it may be more understandable for beginners. ...and me. :P I don't wanna stare at it and wonder how the hack did I do it in some time... ;)
+  
+  // Hard touch scenario (touching 2-3 pads at a time.) Rrequires checking the 2nd and 3rd previous status(which together shows second previous event) to determine the direction.
+  // Previous event won't do cause the cases for forward and backward are all the same, only determined by the the previously active pad, and each pat is first released and then touched again while the other 2 are held, so we need to go back 1 event further with the checks.
+  // Case 1/6 (A=H, B=H, C=T)
+  if (Pads == 7 && Previous0 == 3)
+  {
+    if (Previous1 == 7 && Previous2 == 5 || Previous1 == 1 && Previous2 == 0) // Increment (2nd previous event B=T || B=LU)
+      Direction = Increment;
+    if (Previous1 == 7 && Previous2 == 6 || Previous1 == 2 && Previous2 == 0) // Decrement (2nd previous event A=T || A=LU)
+      Direction = Decrement;
+  }
+  // Case 2/6 (A=R, B=H, C=H)
+  if (Pads == 6 && Previous0 == 7)
+  {
+    if (Previous1 == 3 && Previous2 == 7 || Previous1 == 3 && Previous2 == 1) // Increment (2nd previous event B=T || B=LU)
+      Direction = Increment;
+    if (Previous1 == 5 && Previous2 == 7 || Previous1 == 5 && Previous2 == 1) // Decrement (2nd previous event A=T || A=LU)
+      Direction = Decrement;
+  }
+  // Case 3/6 (A=T, B=H, C=H)
+  if (Pads == 7 && Previous0 == 6)
+  {
+    if (Previous1 == 7 && Previous2 == 3 || Previous1 == 2 && Previous2 == 0) // Increment (2nd previous event B=T || B=LU)
+      Direction = Increment;
+    if (Previous1 == 7 && Previous2 == 5 || Previous1 == 4 && Previous2 == 0) // Decrement (2nd previous event A=T || A=LU)
+      Direction = Decrement;
+  }
+  // Case 4/6 (A=H, B=R, C=H)
+  if (Pads == 5 && Previous0 == 7)
+  {
+    if (Previous1 == 6 && Previous2 == 7 || Previous1 == 6 && Previous2 == 2) // Increment (2nd previous event B=T || B=LU)
+      Direction = Increment;
+    if (Previous1 == 3 && Previous2 == 7 || Previous1 == 3 && Previous2 == 2) // Decrement (2nd previous event A=T || A=LU)
+      Direction = Decrement;
+  }
+  // Case 5/6 (A=H, B=T, C=H)
+  if (Pads == 7 && Previous0 == 5)
+  {
+    if (Previous1 == 7 && Previous2 == 6 || Previous1 == 4 && Previous2 == 0) // Increment (2nd previous event B=T || B=LU)
+      Direction = Increment;
+    if (Previous1 == 7 && Previous2 == 3 || Previous1 == 1 && Previous2 == 0) // Decrement (2nd previous event A=T || A=LU)
+      Direction = Decrement;
+  }
+  // Case 6/6 (A=H, B=H, C=R)
+  if (Pads == 3 && Previous0 == 7)
+  {
+    if (Previous1 == 5 && Previous2 == 7 || Previous1 == 5 && Previous2 == 4) // Increment (2nd previous event B=T || B=LU)
+      Direction = Increment;
+    if (Previous1 == 6 && Previous2 == 7 || Previous1 == 6 && Previous2 == 4) // Decrement (2nd previous event A=T || A=LU)
+      Direction = Decrement;
+  }
+  */
+  
+  // Hard touch scenario (touching 2-3 pads at a time.) Rrequires checking the 2nd and 3rd previous status(which together shows second previous event) to determine the direction.
+  // Previous event won't do cause the cases for forward and backward are all the same, only determined by the the previously active pad, and each pat is first released and then touched again while the other 2 are held, so we need to go back 1 event further with the checks.
+  // Case 1/6 (A=H, B=H, C=T)
+  if (!(Pads ^ 7 | Previous0 ^ 3))
+  {
+    if (!(Previous1 ^ 7 | Previous2 ^ 5) || !(Previous1 ^ 1 | Previous2 ^ 0)) // Increment (2nd previous event B=T || B=LU)
+      Direction = Increment;
+    if (!(Previous1 ^ 7 | Previous2 ^ 6) || !(Previous1 ^ 2 | Previous2 ^ 0)) // Decrement (2nd previous event A=T || A=LU)
+      Direction = Decrement;
+  }
+  // Case 2/6 (A=R, B=H, C=H)
+  if (!(Pads ^ 6 | Previous0 ^ 7))
+  {
+    if (!(Previous1 ^ 3 | Previous2 ^ 7) || !(Previous1 ^ 3 | Previous2 ^ 1)) // Increment (2nd previous event B=T || B=LU)
+      Direction = Increment;
+    if (!(Previous1 ^ 5 | Previous2 ^ 7) || !(Previous1 ^ 5 | Previous2 ^ 1)) // Decrement (2nd previous event A=T || A=LU)
+      Direction = Decrement;
+  }
+  // Case 3/6 (A=T, B=H, C=H)
+  if (!(Pads ^ 7 | Previous0 ^ 6))
+  {
+    if (!(Previous1 ^ 7 | Previous2 ^ 3) || !(Previous1 ^ 2 | Previous2 ^ 0)) // Increment (2nd previous event B=T || B=LU)
+      Direction = Increment;
+    if (!(Previous1 ^ 7 | Previous2 ^ 5) || !(Previous1 ^ 4 | Previous2 ^ 0)) // Decrement (2nd previous event A=T || A=LU)
+      Direction = Decrement;
+  }
+  // Case 4/6 (A=H, B=R, C=H)
+  if (!(Pads ^ 5 | Previous0 ^ 7))
+  {
+    if (!(Previous1 ^ 6 | Previous2 ^ 7) || !(Previous1 ^ 6 | Previous2 ^ 2)) // Increment (2nd previous event B=T || B=LU)
+      Direction = Increment;
+    if (!(Previous1 ^ 3 | Previous2 ^ 7) || !(Previous1 ^ 3 | Previous2 ^ 2)) // Decrement (2nd previous event A=T || A=LU)
+      Direction = Decrement;
+  }
+  // Case 5/6 (A=H, B=T, C=H)
+  if (!(Pads ^ 7 | Previous0 ^ 5))
+  {
+    if (!(Previous1 ^ 7 | Previous2 ^ 6) || !(Previous1 ^ 4 | Previous2 ^ 0)) // Increment (2nd previous event B=T || B=LU)
+      Direction = Increment;
+    if (!(Previous1 ^ 7 | Previous2 ^ 3) || !(Previous1 ^ 1 | Previous2 ^ 0)) // Decrement (2nd previous event A=T || A=LU)
+      Direction = Decrement;
+  }
+  // Case 6/6 (A=H, B=H, C=R)
+  if (!(Pads ^ 3 | Previous0 ^ 7))
+  {
+    if (!(Previous1 ^ 5 | Previous2 ^ 7) || !(Previous1 ^ 5 | Previous2 ^ 4)) // Increment (2nd previous event B=T || B=LU)
+      Direction = Increment;
+    if (!(Previous1 ^ 6 | Previous2 ^ 7) || !(Previous1 ^ 6 | Previous2 ^ 4)) // Decrement (2nd previous event A=T || A=LU)
+      Direction = Decrement;
+  }
+  return Direction;
+}
+
+static byte Swap (byte Pads) // Swaps pads A and C, that's what the Flip flag does.
+{
+  return (Pads & 0x02) | (Pads & 0x01) << 2 | (Pads & 0x04) >> 2;
+}
+
+static byte Mirror (byte Direction) // How GetDirection() turns the direction around when the Flip flag is set.
+{
+  if (Direction != Static)
+    return ~Direction;
+  return Direction;
+}
+
+static void Generate ()
+{
+  printf ("#include \"TouchBar.h\"\n\n");
+  printf ("// Generated by extras/DirectionTableGen, don't edit it by hand!\n");
+  printf ("// Direction for every pad history, indexed by PreviousState2 << 9 | PreviousState1 << 6 | PreviousState0 << 3 | CurrentState (3 bits each, BiTB: 0(LSB) = PadA; 1 = PadB; 2 = PadC;)\n");
+  printf ("// Decrement2 = %d, Decrement = %d, Static = %d, Increment = %d, Increment2 = %d\n", Decrement2, Decrement, Static, Increment, Increment2);
+  printf ("const byte TouchBarDirectionTable[4096] PROGMEM =\n{\n");
+  for (int Line = 0; Line < 64; Line++)
+  {
+    printf ("  ");
+    for (int i = 0; i < 64; i++)
+    {
+      int Index = Line * 64 + i;
+      printf ("%d%s", Reference (Index & 0x07, Index >> 3 & 0x07, Index >> 6 & 0x07, Index >> 9 & 0x07), Index < 4095 ? "," : "");
+    }
+    printf (" // PreviousState2 = %d, PreviousState1 = %d\n", Line >> 3, Line & 0x07);
+  }
+  printf ("};\n");
+}
+
+static int Check ()
+{
+  int Errors = 0;
+  for (int Index = 0; Index < 4096; Index++)
+  {
+    byte Pads = Index & 0x07;
+    byte Previous0 = Index >> 3 & 0x07;
+    byte Previous1 = Index >> 6 & 0x07;
+    byte Previous2 = Index >> 9 & 0x07;
+    byte Expected = Reference (Pads, Previous0, Previous1, Previous2);
+    byte Actual = pgm_read_byte (&TouchBarDirectionTable[Index]);
+    if (Actual != Expected)
+    {
+      printf ("Mismatch at %d: table %d, expected %d\n", Index, Actual, Expected);
+      Errors += 1;
+    }
+    // With the Flip flag the pads used to be swapped before decoding, now the direction is mirrored after it. That only works if the 2 are the same for every history.
+    byte Flipped = Reference (Swap (Pads), Swap (Previous0), Swap (Previous1), Swap (Previous2));
+    if (Mirror (Actual) != Flipped)
+    {
+      printf ("Flip mismatch at %d: table %d mirrored, expected %d\n", Index, Actual, Flipped);
+      Errors += 1;
+    }
+  }
+  printf ("%d histories checked, %d errors.\n", 4096, Errors);
+  return Errors != 0;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1 && strcmp (argv[1], "--check") == 0)
+    return Check ();
+  Generate ();
+  return 0;
+}
@@ -0,0 +1,190 @@
+/*
+EventRingCheck - host tool that checks TouchBarEventRing.
+
+- Events come out in the order they went in, with every field intact.
+- Head and Tail are bytes that wrap at 256: thousands of events through every ring size, pushed and popped in random bursts, keep the order and Available() right.
+- A full ring refuses the event, counts it in GetOverflows() and leaves what's waiting alone.
+- A BufferSize that isn't 2, 4, 8, 16, 32, 64 or 128 is rounded down to one of these, and nothing is written past it.
+- A TouchBar pushing into the ring from Update() gives the same events as its callback.
+
+Build it from the library folder like so:
+g++ -O2 -I . *.cpp extras/EventRingCheck/EventRingCheck.cpp -o EventRingCheck
+
+Then:
+./EventRingCheck <<< Runs the check, returns non-zero on any failure.
+*/
+
+#include "TouchBar.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static long Errors = 0;
+
+static void Expect (boolean Condition, const char *What)
+{
+  if (!Condition)
+  {
+    printf ("FAILED: %s\n", What);
+    Errors++;
+  }
+}
+
+static TouchBar *const Tag = (TouchBar *) 0x1234; // Push() only stores the pointer, it doesn't have to point to anything.
+
+static boolean Same (const TouchBarEvent *Event, unsigned long Number)
+{
+  return Event->Source == Tag + (Number & 3) && Event->Time == Number * 7 && Event->Type == (byte) Number && Event->Value == (TouchBarPosition) (Number * 13);
+}
+
+static boolean PushNumber (TouchBarEventRing *Ring, unsigned long Number)
+{
+  return Ring->Push (Tag + (Number & 3), Number * 7, (byte) Number, (TouchBarPosition) (Number * 13));
+}
+
+static unsigned int Capacity (TouchBarEventRing *Ring) // Pushes until it's full, then empties it again.
+{
+  unsigned int Count = 0;
+  while (Count < 1000 && PushNumber (Ring, Count))
+    Count++;
+  TouchBarEvent Event;
+  while (Ring->Pop (&Event));
+  return Count;
+}
+
+static void CheckSize (byte Size)
+{
+  char What[100];
+  TouchBarEvent Buffer[130];
+  TouchBarEventRing Ring (Buffer, Size);
+  TouchBarEvent Event;
+
+  // FIFO, across the wrap of Head and Tail (10 times round 256).
+  unsigned long In = 0, Out = 0;
+  while (In < 2560)
+  {
+    int Pushes = rand () % (Size + 1);
+    for (int i = 0; i < Pushes; i++)
+      if (PushNumber (&Ring, In))
+        In++;
+    snprintf (What, sizeof (What), "size %u: Available() after pushing", Size);
+    Expect (Ring.Available () == In - Out, What);
+    int Pops = rand () % (Size + 1);
+    for (int i = 0; i < Pops && Ring.Pop (&Event); i++)
+    {
+      snprintf (What, sizeof (What), "size %u: event %lu out in order and intact", Size, Out);
+      Expect (Same (&Event, Out), What);
+      Out++;
+    }
+    snprintf (What, sizeof (What), "size %u: Available() after popping", Size);
+    Expect (Ring.Available () == In - Out, What);
+  }
+  while (Ring.Pop (&Event))
+  {
+    snprintf (What, sizeof (What), "size %u: event %lu out in order and intact", Size, Out);
+    Expect (Same (&Event, Out), What);
+    Out++;
+  }
+  snprintf (What, sizeof (What), "size %u: everything pushed came out, the ring went round 256 at least 10 times", Size);
+  Expect (Out == In && In >= 2560, What);
+  Expect (Ring.Pop (&Event) == false, "an empty ring pops nothing");
+
+  // Full: the next one is refused and counted, what's waiting stays.
+  unsigned int Before = Ring.GetOverflows ();
+  for (unsigned long i = 0; i < Size; i++)
+    Expect (PushNumber (&Ring, In + i), "pushing into a ring that isn't full");
+  for (unsigned long i = 0; i < 5; i++)
+  {
+    snprintf (What, sizeof (What), "size %u: a full ring refuses the event", Size);
+    Expect (PushNumber (&Ring, 1000000 + i) == false, What);
+  }
+  snprintf (What, sizeof (What), "size %u: Available() of a full ring", Size);
+  Expect (Ring.Available () == Size, What);
+  snprintf (What, sizeof (What), "size %u: GetOverflows() counts the refused ones", Size);
+  Expect (Ring.GetOverflows () == Before + 5, What);
+  for (unsigned long i = 0; i < Size; i++)
+  {
+    snprintf (What, sizeof (What), "size %u: a refused event doesn't overwrite a waiting one", Size);
+    Expect (Ring.Pop (&Event) && Same (&Event, In + i), What);
+  }
+  Expect (Ring.Pop (&Event) == false, "the refused events never come out");
+}
+
+
+
+int main ()
+{
+  srand (1);
+
+  // FIFO, wraparound and overflow for every size there is.
+  for (unsigned int Size = 2; Size <= 128; Size *= 2)
+    CheckSize (Size);
+
+  // Any other size is rounded down to a power of 2 (128 at most), and nothing past that is touched.
+  static const byte Sizes[][2] = {{0, 0}, {1, 1}, {3, 2}, {5, 4}, {10, 8}, {31, 16}, {33, 32}, {100, 64}, {129, 128}, {200, 128}, {255, 128}};
+  for (unsigned int i = 0; i < sizeof (Sizes) / sizeof (Sizes[0]); i++)
+  {
+    char What[100];
+    TouchBarEvent Buffer[256];
+    memset (Buffer, 0xA5, sizeof (Buffer));
+    TouchBarEventRing Ring (Buffer, Sizes[i][0]);
+    unsigned long Rounds = 0;
+    for (int Round = 0; Round < 300; Round++) // Round 256 as well
+    {
+      snprintf (What, sizeof (What), "BufferSize %u holds %u events", Sizes[i][0], Sizes[i][1]);
+      Expect (Capacity (&Ring) == Sizes[i][1], What);
+      Rounds++;
+    }
+    byte Untouched[sizeof (TouchBarEvent)];
+    memset (Untouched, 0xA5, sizeof (Untouched));
+    boolean Clean = true;
+    for (unsigned int j = Sizes[i][1]; j < 256; j++)
+      Clean &= memcmp (&Buffer[j], Untouched, sizeof (Untouched)) == 0;
+    snprintf (What, sizeof (What), "BufferSize %u writes nothing past event %u", Sizes[i][0], Sizes[i][1]);
+    Expect (Clean, What);
+    snprintf (What, sizeof (What), "BufferSize %u counts one overflow per fill", Sizes[i][0]);
+    Expect (Ring.GetOverflows () == Rounds, What);
+  }
+
+  // From Update(): the ring gets exactly what the callback gets.
+  TouchBarCommon Common = {320, 6};
+  TouchBarConfig Config;
+  Config.Default = 5000;
+  Config.Limit = 10000;
+  Config.Resolution = 100;
+  Config.RampDelay = 10;
+  Config.RampResolution = 25;
+  Config.SetFlags (false, true, true, false);
+  TouchBar TB (&Common, &Config);
+  TB.SetPosition (Config.Default);
+  TouchBarEvent Buffer[128];
+  TouchBarEventRing Ring (Buffer, 128);
+  std::vector<TouchBarEvent> Called;
+  TB.SetEventRing (&Ring);
+  TB.SetCallback ([] (const TouchBarEvent *Event, void *Context) { ((std::vector<TouchBarEvent> *) Context)->push_back (*Event); }, &Called);
+  unsigned long Popped = 0;
+  for (long Sample = 0; Sample < 200000; Sample++)
+  {
+    static const byte Cycle[6] = {1, 3, 2, 6, 4, 5};
+    static byte Pads = 0;
+    if (rand () % 200 == 0)
+      Pads = rand () % 3 ? Cycle[rand () % 6] : 0;
+    AdvanceVirtualMicros (10);
+    TB.Update (bitRead (Pads, 0), bitRead (Pads, 1), bitRead (Pads, 2));
+    if (rand () % 8 == 0) // loop() doesn't look after every Update()
+    {
+      TouchBarEvent Event;
+      while (Ring.Pop (&Event))
+      {
+        Expect (Popped < Called.size () && Event.Source == &TB && Event.Time == Called[Popped].Time && Event.Type == Called[Popped].Type && Event.Value == Called[Popped].Value, "the ring and the callback got the same event");
+        Popped++;
+      }
+    }
+  }
+  Expect (Ring.GetOverflows () == 0, "no overflow when loop() keeps up");
+  Expect (Popped + Ring.Available () == Called.size (), "the ring got every event the callback got");
+
+  printf ("%lu events from Update(), %ld failures\n", (unsigned long) Called.size (), Errors);
+  return Errors != 0;
+}
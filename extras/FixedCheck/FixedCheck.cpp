@@ -0,0 +1,214 @@
+/*
+FixedCheck - host tool that checks TouchBarFixed against an ordinary TouchBar with the same settings, and measures how much faster it is.
+
+For each of a handful of fixed configurations (every flag, big and small steps, steps over half the Limit, ramp on and off) both bars get the same random pad stream (touching, holding, swiping, twitching and tapping at random),
+and position, target, PadEvent(), Event() and Idle() have to match after every single update.
+
+Build it from the library folder like so:
+g++ -O2 -I . *.cpp extras/FixedCheck/FixedCheck.cpp -o FixedCheck
+
+Then:
+./FixedCheck <<< Runs the check, returns non-zero on any mismatch.
+./FixedCheck 1000000 <<< Same, with the given number of updates per configuration (200000 by default).
+*/
+
+#include "TouchBar.h"
+#include "TouchBarFixed.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct Plain
+{
+  static const unsigned int Default = 5000;
+  static const unsigned int Limit = 10000;
+  static const byte Resolution = 100;
+  static const byte RampDelay = 100;
+  static const byte RampResolution = 25;
+  static const boolean RollOver = false;
+  static const boolean SpringBack = false;
+  static const boolean Snap = false;
+  static const boolean Ramp = false;
+  static const boolean Flip = false;
+  static const unsigned int TapTimeout = 140;
+  static const byte TwitchSuppressionDelay = 20;
+}; // <<< ; at the end is important!!!
+
+struct SnapFlip : Plain
+{
+  static const byte Resolution = 7;
+  static const boolean Snap = true;
+  static const boolean Flip = true;
+  static const byte TwitchSuppressionDelay = 3;
+}; // <<< ; at the end is important!!!
+
+struct SnapRamp : Plain
+{
+  static const byte Resolution = 200;
+  static const byte RampDelay = 3;
+  static const byte RampResolution = 9;
+  static const boolean Snap = true;
+  static const boolean Ramp = true;
+}; // <<< ; at the end is important!!!
+
+struct SpringBackRamp : Plain
+{
+  static const unsigned int Default = 0;
+  static const unsigned int Limit = 255;
+  static const byte Resolution = 1;
+  static const byte RampDelay = 1;
+  static const byte RampResolution = 1;
+  static const boolean SpringBack = true;
+  static const boolean Ramp = true;
+  static const boolean Flip = true;
+  static const byte TwitchSuppressionDelay = 0;
+}; // <<< ; at the end is important!!!
+
+struct Wheel : Plain
+{
+  static const unsigned int Default = 3;
+  static const unsigned int Limit = 360;
+  static const byte Resolution = 150;
+  static const boolean RollOver = true;
+  static const boolean Snap = true; // Ignored with RollOver
+  static const byte TwitchSuppressionDelay = 5;
+}; // <<< ; at the end is important!!!
+
+struct Coarse : Plain // Limit < 2 * Resolution, a skip (Increment2 / Decrement2) is clamped half way.
+{
+  static const unsigned int Default = 50;
+  static const unsigned int Limit = 150;
+  static const boolean Snap = true;
+  static const byte TwitchSuppressionDelay = 2;
+}; // <<< ; at the end is important!!!
+
+struct CoarseRamp : Coarse
+{
+  static const byte RampDelay = 2;
+  static const byte RampResolution = 30;
+  static const boolean Ramp = true;
+}; // <<< ; at the end is important!!!
+
+struct CoarseWheel : Coarse
+{
+  static const unsigned int Limit = 65000; // Current + 2 * Resolution doesn't fit 16 bits near the top.
+  static const byte Resolution = 255;
+  static const boolean RollOver = true;
+}; // <<< ; at the end is important!!!
+
+struct ShortWheel : Coarse
+{
+  static const boolean RollOver = true;
+}; // <<< ; at the end is important!!!
+
+static double Seconds ()
+{
+  struct timespec Now;
+  clock_gettime (CLOCK_MONOTONIC, &Now);
+  return Now.tv_sec + Now.tv_nsec / 1e9;
+}
+
+static byte NextSample (byte Sample)
+{
+  static const byte Up[6] = {1, 3, 2, 6, 4, 5};
+  switch (rand () % 8)
+  {
+    case 0: return 0;
+    case 1: return rand () % 8;
+    case 2: case 3: // Swipe one way...
+      for (byte i = 0; i < 6; i++)
+        if (Up[i] == Sample)
+          return Up[(i + 1) % 6];
+      return Up[0];
+    case 4: // ...or the other
+      for (byte i = 0; i < 6; i++)
+        if (Up[i] == Sample)
+          return Up[(i + 5) % 6];
+      return Up[0];
+    default: return Sample; // Hold
+  }
+}
+
+template <class ConfigT>
+static long Check (const char *Name, long Updates)
+{
+  TouchBarCommon Common = {ConfigT::TapTimeout, ConfigT::TwitchSuppressionDelay};
+  TouchBarConfig Config;
+  Config.Default = ConfigT::Default;
+  Config.Limit = ConfigT::Limit;
+  Config.Resolution = ConfigT::Resolution;
+  Config.RampDelay = ConfigT::RampDelay;
+  Config.RampResolution = ConfigT::RampResolution;
+  if (ConfigT::RollOver)
+    Config.SetFlags ((boolean)true, ConfigT::Flip);
+  else
+    Config.SetFlags (ConfigT::SpringBack, ConfigT::Snap, ConfigT::Ramp, ConfigT::Flip);
+
+  TouchBar Runtime (&Common, &Config);
+  TouchBarFixed<ConfigT> Fixed;
+
+  byte *Samples = new byte[Updates];
+  byte Sample = 0;
+  for (long i = 0; i < Updates; i++)
+  {
+    if (rand () % 4 == 0) // Keep each state for a while, like a finger would.
+      Sample = NextSample (Sample);
+    Samples[i] = Sample;
+  }
+
+  long Errors = 0;
+  for (long i = 0; i < Updates; i++)
+  {
+    Runtime.Update (Samples[i]);
+    Fixed.Update (Samples[i]);
+    if (Runtime.GetPositionInt () != Fixed.GetPositionInt () || Runtime.GetTargetInt () != Fixed.GetTargetInt () || Runtime.PadEvent () != Fixed.PadEvent ()
+        || Runtime.Event () != Fixed.Event () || Runtime.Idle () != Fixed.Idle ())
+    {
+      if (Errors < 10)
+        printf ("%s: mismatch at update %ld: position %u / %u, target %u / %u, pad event %c / %c\n", Name, i, Runtime.GetPositionInt (), Fixed.GetPositionInt (),
+                Runtime.GetTargetInt (), Fixed.GetTargetInt (), Runtime.PadEvent (), Fixed.PadEvent ());
+      Errors++;
+    }
+  }
+
+  // Timing, the same samples again without the comparison.
+  unsigned long Sum = 0;
+  double Start = Seconds ();
+  for (long i = 0; i < Updates; i++)
+  {
+    Runtime.Update (Samples[i]);
+    Sum += Runtime.GetPositionInt ();
+  }
+  double RuntimeTime = Seconds () - Start;
+  Start = Seconds ();
+  for (long i = 0; i < Updates; i++)
+  {
+    Fixed.Update (Samples[i]);
+    Sum += Fixed.GetPositionInt ();
+  }
+  double FixedTime = Seconds () - Start;
+
+  printf ("%-16s %6.1f ns/update TouchBar, %6.1f ns/update TouchBarFixed, %ld errors (%lu)\n", Name, RuntimeTime / Updates * 1e9, FixedTime / Updates * 1e9, Errors, Sum & 1);
+  delete[] Samples;
+  return Errors;
+}
+
+int main (int argc, char **argv)
+{
+  long Updates = argc > 1 ? atol (argv[1]) : 200000;
+  long Errors = 0;
+  srand (1);
+
+  Errors += Check<Plain> ("Plain", Updates);
+  Errors += Check<SnapFlip> ("Snap, Flip", Updates);
+  Errors += Check<SnapRamp> ("Snap, Ramp", Updates);
+  Errors += Check<SpringBackRamp> ("SpringBack, Ramp", Updates);
+  Errors += Check<Wheel> ("RollOver", Updates);
+  Errors += Check<Coarse> ("Coarse, Snap", Updates);
+  Errors += Check<CoarseRamp> ("Coarse, Ramp", Updates);
+  Errors += Check<ShortWheel> ("Coarse, RollOver", Updates);
+  Errors += Check<CoarseWheel> ("Big RollOver", Updates);
+
+  printf ("%ld errors\n", Errors);
+  return Errors != 0;
+}
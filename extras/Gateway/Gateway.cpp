@@ -0,0 +1,519 @@
+/*
+Gateway - host service that runs the TouchBar objects of many panels centrally, from the raw pad samples they forward, on a TouchBarGateway (a few worker threads).
+
+The panels (or whatever collects from them) send records, numbers MSB first:
+  Bar (2), Time (4, us, of the first sample), Period (2, us between samples), Count (1), Samples (Count bytes, pads A, B, C in bits 0-2, same as TouchBar::Update(byte)).
+Every bar runs with the same settings (those of the examples, in wall-clock mode, see Settings()), the events of all bars come out on stdout as one CSV stream:
+  Bar,Time,Type,Value <<< Type and Value same as TouchBarEvent (TapEvent 1 with the pad in Value...). A bar's events are in order, the bars are interleaved.
+
+Build it from the library folder like so:
+g++ -O2 -pthread -I . *.cpp extras/Gateway/Gateway.cpp extras/Gateway/TouchBarGateway.cpp -o Gateway
+
+Then:
+./Gateway [-w Workers] [-b Bars] [File] <<< Reads the records from File (stdin if left out) until it ends. Workers: as many as the CPU has if left out. Bars: 4096 if left out.
+./Gateway [-w Workers] [-b Bars] -s /tmp/touchbar.sock <<< Listens on a UNIX socket instead, any number of panels (or collectors) can connect, until Ctrl+C.
+./Gateway --generate Bars Seconds > Load.bin <<< The load generator: a stream of records for Bars bars, every bar sends 50 ms of samples at 2 kHz at a time, swiping, tapping, twitching or doing nothing,
+  from the same gesture patterns as the Benchmark workloads (TouchBarSimulator). Some shards get much more of the swiping then others, the way real installations are uneven.
+  Feed it to a running gateway with socat - UNIX-CONNECT:/tmp/touchbar.sock < Load.bin, or straight to ./Gateway Load.bin.
+./Gateway --load [Bars] [Seconds] [Workers] <<< Runs the generated load from memory with 1, 2, 4... up to Workers workers (as many as the CPU has if left out), prints samples per second and the speedup over 1 worker.
+./Gateway --check <<< Runs a load with 1 to 8 workers and checks every bar's events against the same bars run on their own, one thread, sample by sample. Returns non-zero on any failure.
+*/
+
+#include "TouchBar.h"
+#include "TouchBarSimulator.h"
+#include "TouchBarGateway.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <vector>
+
+#define RecordHeader 9
+#define LoadPeriod 500 // us, 2 kHz per bar
+#define LoadWindow 100 // Samples per record, 50 ms
+
+static long Errors = 0;
+
+static void Expect (boolean Condition, const char *What)
+{
+  if (!Condition)
+  {
+    printf ("FAILED: %s\n", What);
+    Errors++;
+  }
+}
+
+static void Settings (TouchBarCommon *Common, TouchBarConfig *Config)
+{
+  Common->TapTimeout = 140;
+  Common->TwitchSuppressionDelay = 20;
+  Common->Clock = 0; // The gateway sets its own.
+  Common->TapTime = 200000;
+  Common->TwitchSuppressionTime = 2000;
+  Common->DebounceDelay = 0;
+  Config->Default = 5000;
+  Config->Limit = 10000;
+  Config->Resolution = 100;
+  Config->RampDelay = 100;
+  Config->RampResolution = 25;
+  Config->SetFlags (false, true, false, false);
+  Config->Gestures = 1 << DoubleTapGesture | 1 << LongPressGesture;
+}
+
+
+
+/* Records */
+struct Parser // Takes records apart as the bytes come in, in whatever pieces.
+{
+  std::vector<byte> Pending;
+  unsigned long Bad = 0; // Records for bars out of range
+
+  void Feed (TouchBarGateway *Gateway, const byte *Data, size_t Length)
+  {
+    const byte *From = Data;
+    size_t Left = Length;
+    if (Pending.size () != 0)
+    {
+      Pending.insert (Pending.end (), Data, Data + Length);
+      From = Pending.data ();
+      Left = Pending.size ();
+    }
+    size_t Used = Take (Gateway, From, Left);
+    if (Pending.size () != 0)
+      Pending.erase (Pending.begin (), Pending.begin () + Used);
+    else
+      Pending.assign (Data + Used, Data + Length);
+  }
+
+  size_t Take (TouchBarGateway *Gateway, const byte *Data, size_t Length) // Returns the bytes used, the rest is the start of a record.
+  {
+    size_t Used = 0;
+    while (Length - Used >= RecordHeader && Length - Used >= RecordHeader + (size_t)Data[Used + 8])
+    {
+      const byte *R = Data + Used;
+      TouchBarGatewayRun Run;
+      Run.Bar = R[0] << 8 | R[1];
+      Run.Time = (unsigned long)R[2] << 24 | (unsigned long)R[3] << 16 | (unsigned long)R[4] << 8 | R[5];
+      Run.Period = R[6] << 8 | R[7];
+      Run.Count = R[8];
+      Run.Samples = R + RecordHeader;
+      if (Gateway->Put (&Run) == false)
+        Bad += 1;
+      Used += RecordHeader + Run.Count;
+    }
+    return Used;
+  }
+}; // <<< ; at the end is important!!!
+
+static void PutRecord (std::vector<byte> *Out, unsigned int Bar, unsigned long Time, unsigned int Period, const byte *Samples, byte Count)
+{
+  byte Header[RecordHeader] = {(byte)(Bar >> 8), (byte)Bar, (byte)(Time >> 24), (byte)(Time >> 16), (byte)(Time >> 8), (byte)Time, (byte)(Period >> 8), (byte)Period, Count};
+  Out->insert (Out->end (), Header, Header + RecordHeader);
+  Out->insert (Out->end (), Samples, Samples + Count);
+}
+
+
+
+/* Load generator */
+struct Pattern
+{
+  const char *Name;
+  std::vector<byte> Samples;
+};
+
+static void Render (TouchBarSimulator *Sim, std::vector<Pattern> *Patterns, const char *Name)
+{
+  Pattern P;
+  P.Name = Name;
+  byte Sample;
+  Sim->Rewind ();
+  while (Sim->Next (&Sample))
+    P.Samples.push_back (Sample);
+  Patterns->push_back (P);
+  Sim->Clear ();
+}
+
+static void MakePatterns (std::vector<Pattern> *Patterns) // Same gestures as the Benchmark workloads, at the panels' sample rate.
+{
+  TouchBarSimulator Sim (LoadPeriod);
+  Sim.Idle (2000000);
+  Render (&Sim, Patterns, "Idle");
+  Sim.Tap ('A', 60000); Sim.Idle (400000); Sim.Tap ('B', 60000); Sim.Idle (150000); Sim.Tap ('B', 60000); Sim.Idle (800000); Sim.Tap ('C', 900000); Sim.Idle (600000);
+  Render (&Sim, Patterns, "Taps");
+  Sim.LightSwipe (true, 24, 6000); Sim.Idle (100000); Sim.LightSwipe (false, 24, 6000); Sim.Idle (300000);
+  Render (&Sim, Patterns, "LightSwipe");
+  Sim.HardSwipe (true, 24, 6000); Sim.Idle (100000); Sim.HardSwipe (false, 24, 6000); Sim.Idle (300000);
+  Render (&Sim, Patterns, "HardSwipe");
+  Sim.SkipSwipe (true, 12, 4000); Sim.SkipSwipe (false, 12, 4000); Sim.Idle (200000);
+  Render (&Sim, Patterns, "SkipSwipe");
+  Sim.Twitch (0x02, 'C', 40, 8000); Sim.Idle (500000);
+  Render (&Sim, Patterns, "Twitch");
+}
+
+static void Generate (std::vector<byte> *Out, unsigned long Bars, double Seconds)
+{
+  std::vector<Pattern> Patterns;
+  MakePatterns (&Patterns);
+  // Every bar plays one pattern over and over, from its own starting point. About 1 shard in 4 is busy (swiping, twitching), the rest mostly idle with a tap now and then.
+  std::vector<byte> Kind (Bars);
+  std::vector<size_t> Phase (Bars);
+  srand (7);
+  for (unsigned long Bar = 0; Bar < Bars; Bar++)
+  {
+    boolean Busy = ((Bar / GatewayShardBars) * 2654435761UL >> 8) % 4 == 0;
+    if (Busy)
+      Kind[Bar] = 2 + rand () % 4;
+    else
+      Kind[Bar] = rand () % 8 == 0 ? 1 : 0;
+    Phase[Bar] = rand () % Patterns[Kind[Bar]].Samples.size ();
+  }
+
+  unsigned long Windows = Seconds * 1000000 / (LoadPeriod * LoadWindow);
+  Out->clear ();
+  Out->reserve (Windows * Bars * (RecordHeader + LoadWindow));
+  byte Samples[LoadWindow];
+  for (unsigned long Window = 0; Window < Windows; Window++)
+    for (unsigned long Bar = 0; Bar < Bars; Bar++)
+    {
+      const std::vector<byte> *From = &Patterns[Kind[Bar]].Samples;
+      for (unsigned int i = 0; i < LoadWindow; i++)
+        Samples[i] = (*From)[(Phase[Bar] + Window * LoadWindow + i) % From->size ()];
+      PutRecord (Out, Bar, Window * LoadWindow * LoadPeriod, LoadPeriod, Samples, LoadWindow);
+    }
+}
+
+
+
+/* Load */
+struct Tally
+{
+  unsigned long Events = 0;
+  unsigned long Sum = 0; // Of every event, in any order, so runs with any number of workers can be compared.
+}; // <<< ; at the end is important!!!
+
+static void Count (const TouchBarGatewayEvent *Events, size_t Count, void *Context)
+{
+  Tally *T = (Tally *)Context;
+  for (size_t i = 0; i < Count; i++)
+    T->Sum += (Events[i].Bar * 2654435761UL) ^ (Events[i].Time * 40503UL + Events[i].Type * 257 + Events[i].Value);
+  T->Events += Count;
+}
+
+static void Feed (TouchBarGateway *Gateway, const std::vector<byte> *Stream, size_t Piece) // In pieces, the way reads from a socket come in.
+{
+  Parser P;
+  for (size_t At = 0; At < Stream->size (); At += Piece)
+  {
+    size_t Length = Stream->size () - At < Piece ? Stream->size () - At : Piece;
+    P.Feed (Gateway, Stream->data () + At, Length);
+    Gateway->Flush ();
+  }
+}
+
+static void Load (unsigned long Bars, double Seconds, unsigned int MaxWorkers)
+{
+  std::vector<byte> Stream;
+  Generate (&Stream, Bars, Seconds);
+  unsigned long Samples = Stream.size () / (RecordHeader + LoadWindow) * LoadWindow;
+  printf ("%lu bars, %.1f s of samples at %u Hz: %lu samples, %lu bytes of records, %u CPUs\n", Bars, Seconds, 1000000 / LoadPeriod, Samples, (unsigned long)Stream.size (), std::thread::hardware_concurrency ());
+  printf ("%8s %12s %10s %8s %10s %8s\n", "Workers", "ms", "Msamples/s", "Speedup", "Events", "Steals");
+
+  double Single = 0;
+  unsigned long Sum = 0;
+  for (unsigned int Workers = 1; Workers <= MaxWorkers; Workers = Workers * 2 > MaxWorkers && Workers < MaxWorkers ? MaxWorkers : Workers * 2)
+  {
+    TouchBarCommon Common;
+    TouchBarConfig Config;
+    Settings (&Common, &Config);
+    Tally T;
+    TouchBarGateway Gateway (&Common, &Config, Bars, Workers, Count, &T);
+    unsigned long Start = HostNanos ();
+    Gateway.Start ();
+    Feed (&Gateway, &Stream, 65536);
+    Gateway.Finish ();
+    double Ms = (HostNanos () - Start) / 1e6;
+    if (Workers == 1)
+    {
+      Single = Ms;
+      Sum = T.Sum;
+    }
+    Expect (Gateway.GetSamples () == Samples && T.Sum == Sum, "every worker count runs every sample and gives the same events");
+    printf ("%8u %12.1f %10.2f %8.2f %10lu %8lu\n", Workers, Ms, Samples / Ms / 1000, Single / Ms, T.Events, Gateway.GetSteals ());
+  }
+}
+
+
+
+/* Check */
+struct Reference
+{
+  std::vector<std::vector<TouchBarGatewayEvent> > Bars;
+}; // <<< ; at the end is important!!!
+
+static unsigned long ReferenceNow = 0;
+
+static unsigned long ReferenceClock ()
+{
+  return ReferenceNow;
+}
+
+static void Keep (const TouchBarGatewayEvent *Events, size_t Count, void *Context)
+{
+  Reference *R = (Reference *)Context;
+  for (size_t i = 0; i < Count; i++)
+    R->Bars[Events[i].Bar].push_back (Events[i]);
+}
+
+static void KeepOne (const TouchBarEvent *Event, void *Context)
+{
+  std::vector<TouchBarGatewayEvent> *Events = (std::vector<TouchBarGatewayEvent> *)Context;
+  TouchBarGatewayEvent E = {0, Event->Time, Event->Value, Event->Type};
+  Events->push_back (E);
+}
+
+static void Check ()
+{
+  unsigned long Bars = 300; // Not a whole number of shards
+  std::vector<byte> Stream;
+  Generate (&Stream, Bars, 4);
+
+  // The same bars, one by one, no gateway.
+  TouchBarCommon Common;
+  TouchBarConfig Config;
+  Settings (&Common, &Config);
+  Common.Clock = ReferenceClock;
+  std::vector<TouchBar> Single (Bars, TouchBar (&Common, &Config));
+  Reference Expected;
+  Expected.Bars.resize (Bars);
+  for (unsigned long Bar = 0; Bar < Bars; Bar++)
+    Single[Bar].SetCallback (KeepOne, &Expected.Bars[Bar]);
+  unsigned long Events = 0;
+  for (size_t At = 0; At < Stream.size (); At += RecordHeader + Stream[At + 8])
+  {
+    const byte *R = &Stream[At];
+    unsigned long Bar = R[0] << 8 | R[1];
+    unsigned long Time = (unsigned long)R[2] << 24 | (unsigned long)R[3] << 16 | (unsigned long)R[4] << 8 | R[5];
+    unsigned int Period = R[6] << 8 | R[7];
+    for (byte i = 0; i < R[8]; i++)
+    {
+      ReferenceNow = Time + (unsigned long)i * Period;
+      Single[Bar].Update (R[RecordHeader + i]);
+    }
+  }
+  for (unsigned long Bar = 0; Bar < Bars; Bar++)
+    Events += Expected.Bars[Bar].size ();
+  printf ("%lu bars, %lu bytes of records, %lu events\n", Bars, (unsigned long)Stream.size (), Events);
+  Expect (Events > 1000, "the load makes events");
+
+  for (unsigned int Workers = 1; Workers <= 8; Workers++)
+  {
+    TouchBarCommon GatewayCommon;
+    TouchBarConfig GatewayConfig;
+    Settings (&GatewayCommon, &GatewayConfig);
+    Reference Got;
+    Got.Bars.resize (Bars);
+    TouchBarGateway Gateway (&GatewayCommon, &GatewayConfig, Bars, Workers, Keep, &Got);
+    Gateway.Start ();
+    Feed (&Gateway, &Stream, 1000 + Workers * 777); // Records cut anywhere
+    Gateway.Finish ();
+
+    unsigned long Wrong = 0;
+    for (unsigned long Bar = 0; Bar < Bars; Bar++)
+    {
+      std::vector<TouchBarGatewayEvent> *A = &Expected.Bars[Bar];
+      std::vector<TouchBarGatewayEvent> *B = &Got.Bars[Bar];
+      boolean Same = A->size () == B->size ();
+      for (size_t i = 0; Same && i < A->size (); i++)
+        Same = (*A)[i].Time == (*B)[i].Time && (*A)[i].Type == (*B)[i].Type && (*A)[i].Value == (*B)[i].Value;
+      if (Same == false)
+        Wrong += 1;
+    }
+    printf ("%u workers: %lu samples, %lu events, %lu steals, %lu bars wrong\n", Workers, Gateway.GetSamples (), Gateway.GetEvents (), Gateway.GetSteals (), Wrong);
+    Expect (Wrong == 0 && Gateway.GetEvents () == Events, "every bar gets the same events as on its own");
+
+    // Start() again goes on where it was.
+    TouchBarGatewayRun Run = {Bars, 0, LoadPeriod, 0, 0};
+    Expect (Gateway.Put (&Run) == false, "a bar out of range is refused");
+    Expect (Gateway.GetBar (0)->GetPositionInt () == Single[0].GetPositionInt () && Gateway.GetBar (Bars - 1)->GetPositionInt () == Single[Bars - 1].GetPositionInt (), "the bars end up where they would on their own");
+  }
+  printf ("%ld failures\n", Errors);
+}
+
+
+
+/* Service */
+static TouchBarGateway *Service;
+static volatile sig_atomic_t Stop = 0;
+
+static void OnSignal (int)
+{
+  Stop = 1;
+}
+
+static char Output[1 << 16];
+static size_t OutputLength = 0;
+static unsigned long Flushed = 0;
+
+static void Print (const TouchBarGatewayEvent *Events, size_t Count, void *)
+{
+  for (size_t i = 0; i < Count; i++)
+  {
+    if (OutputLength > sizeof(Output) - 64)
+    {
+      fwrite (Output, 1, OutputLength, stdout);
+      OutputLength = 0;
+    }
+    OutputLength += snprintf (Output + OutputLength, 64, "%lu,%lu,%u,%u\n", Events[i].Bar, Events[i].Time, Events[i].Type, Events[i].Value);
+  }
+  if (OutputLength != 0 && HostNanos () - Flushed >= 50000000)
+  {
+    fwrite (Output, 1, OutputLength, stdout); // Don't keep a reader at the other end of a pipe waiting for a full buffer.
+    fflush (stdout);
+    OutputLength = 0;
+    Flushed = HostNanos ();
+  }
+}
+
+static int ServeFile (FILE *In)
+{
+  Parser P;
+  byte Buffer[65536];
+  size_t Length;
+  while ((Length = fread (Buffer, 1, sizeof(Buffer), In)) > 0 && Stop == 0)
+  {
+    P.Feed (Service, Buffer, Length);
+    Service->Flush ();
+  }
+  if (P.Bad != 0)
+    fprintf (stderr, "%lu records for bars out of range\n", P.Bad);
+  return 0;
+}
+
+static int ServeSocket (const char *Path)
+{
+  int Listener = socket (AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un Address = {};
+  Address.sun_family = AF_UNIX;
+  strncpy (Address.sun_path, Path, sizeof(Address.sun_path) - 1);
+  unlink (Path);
+  if (Listener < 0 || bind (Listener, (struct sockaddr *)&Address, sizeof(Address)) != 0 || listen (Listener, 16) != 0)
+  {
+    perror (Path);
+    return 1;
+  }
+  fprintf (stderr, "Listening on %s\n", Path);
+
+  std::vector<struct pollfd> Polls (1);
+  std::vector<Parser> Parsers (1); // Each connection has its own, a record may come in pieces.
+  Polls[0].fd = Listener;
+  Polls[0].events = POLLIN;
+  byte Buffer[65536];
+  while (Stop == 0)
+  {
+    if (poll (Polls.data (), Polls.size (), 100) <= 0)
+      continue;
+    for (size_t i = Polls.size () - 1; i > 0; i--)
+    {
+      if (Polls[i].revents == 0)
+        continue;
+      ssize_t Length = read (Polls[i].fd, Buffer, sizeof(Buffer));
+      if (Length > 0)
+        Parsers[i].Feed (Service, Buffer, Length);
+      else
+      {
+        close (Polls[i].fd);
+        Polls.erase (Polls.begin () + i);
+        Parsers.erase (Parsers.begin () + i);
+      }
+    }
+    Service->Flush ();
+    if (Polls[0].revents & POLLIN)
+    {
+      struct pollfd Client = {accept (Listener, 0, 0), POLLIN, 0};
+      if (Client.fd >= 0)
+      {
+        Polls.push_back (Client);
+        Parsers.push_back (Parser ());
+      }
+    }
+  }
+  for (size_t i = 0; i < Polls.size (); i++)
+    close (Polls[i].fd);
+  unlink (Path);
+  return 0;
+}
+
+int main (int argc, char **argv)
+{
+  unsigned int Cpus = std::thread::hardware_concurrency ();
+  if (Cpus < 1)
+    Cpus = 1;
+
+  if (argc >= 2 && strcmp (argv[1], "--check") == 0)
+  {
+    Check ();
+    return Errors == 0 ? 0 : 1;
+  }
+  if (argc >= 2 && strcmp (argv[1], "--load") == 0)
+  {
+    Load (argc >= 3 ? atol (argv[2]) : 4096, argc >= 4 ? atof (argv[3]) : 5, argc >= 5 ? atoi (argv[4]) : Cpus);
+    return Errors == 0 ? 0 : 1;
+  }
+  if (argc >= 4 && strcmp (argv[1], "--generate") == 0)
+  {
+    std::vector<byte> Stream;
+    Generate (&Stream, atol (argv[2]), atof (argv[3]));
+    fwrite (Stream.data (), 1, Stream.size (), stdout);
+    return 0;
+  }
+
+  unsigned int Workers = Cpus;
+  unsigned long Bars = 4096;
+  const char *Socket = 0;
+  const char *File = 0;
+  for (int i = 1; i < argc; i++)
+    if (strcmp (argv[i], "-w") == 0 && i + 1 < argc)
+      Workers = atoi (argv[++i]);
+    else if (strcmp (argv[i], "-b") == 0 && i + 1 < argc)
+      Bars = atol (argv[++i]);
+    else if (strcmp (argv[i], "-s") == 0 && i + 1 < argc)
+      Socket = argv[++i];
+    else if (strcmp (argv[i], "-") != 0)
+      File = argv[i];
+  if (Bars < 1 || Bars > 65536)
+  {
+    fprintf (stderr, "Bars: 1 to 65536\n");
+    return 1;
+  }
+
+  TouchBarCommon Common;
+  TouchBarConfig Config;
+  Settings (&Common, &Config);
+  TouchBarGateway Gateway (&Common, &Config, Bars, Workers, Print);
+  Service = &Gateway;
+  signal (SIGINT, OnSignal);
+  signal (SIGTERM, OnSignal);
+  Gateway.Start ();
+
+  int Result;
+  if (Socket != 0)
+    Result = ServeSocket (Socket);
+  else
+  {
+    FILE *In = File != 0 ? fopen (File, "rb") : stdin;
+    if (In == 0)
+    {
+      perror (File);
+      return 1;
+    }
+    Result = ServeFile (In);
+  }
+  Gateway.Finish ();
+  fwrite (Output, 1, OutputLength, stdout);
+  fprintf (stderr, "%lu samples, %lu events, %u workers, %lu steals\n", Gateway.GetSamples (), Gateway.GetEvents (), Workers, Gateway.GetSteals ());
+  return Result;
+}
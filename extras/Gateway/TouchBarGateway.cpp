@@ -0,0 +1,399 @@
+#ifndef ARDUINO
+
+#include "TouchBarGateway.h"
+#include <string.h>
+#include <chrono>
+
+/*
+Gateway
+The panels forward runs of raw pad samples (bar number, time, period, samples), the reader thread Put()s them, the workers run the bars, and the publisher hands the events to the Sink, all of them as one stream.
+  Shards: bars are split into shards of GatewayShardBars, each shard has its own queue of batches in and its own queue of events out. Both have one thread on each end (reader -> worker, worker -> publisher), so they're plain lock-free rings, an atomic head and tail each.
+  Running: a shard with batches waiting is queued to its home worker (shard number % workers), unless it already is. A worker runs a shard until it has no batches left (GatewaySlice at most, then it queues it again and lets the others have a turn).
+  Stealing: a worker with nothing queued takes a shard from the queue of another. It takes the whole shard, never part of one, and Scheduled makes sure only one worker has it at a time. So a bar's state is only ever touched by one thread at a time, its samples go in the order they came,
+  and it needs no locks: the handover goes through Scheduled and the queue, which order everything the last worker did before everything the next one does.
+  Publishing: the publisher goes round the shards and drains their events. A bar's events come out in order, the events of different bars are interleaved however the workers got to them (Time tells when they happened).
+Time: every sample is run at its own time (Time + i * Period) through Common->Clock, a thread local clock, so the bars don't touch the (shared) virtual micros(), and the timing doesn't depend on when the gateway gets to them.
+Backpressure: the reader waits when a shard's batches are all full, a worker waits when a shard's events are all full. Nothing is dropped, a slow Sink slows the reader down in the end.
+*/
+
+static thread_local unsigned long GatewayNow = 0; // Time of the sample being run, on this worker
+
+static unsigned long GatewayClock ()
+{
+  return GatewayNow;
+}
+
+static void Pause (unsigned int *Idle) // Waiting for another thread: spin a bit, then yield, then sleep.
+{
+  *Idle += 1;
+  if (*Idle < 64)
+    return;
+  if (*Idle < 256)
+    std::this_thread::yield ();
+  else
+    std::this_thread::sleep_for (std::chrono::microseconds (50));
+}
+
+
+
+/* Queue */
+TouchBarGatewayQueue::TouchBarGatewayQueue (size_t Size)
+{
+  size_t Cells2 = 2;
+  while (Cells2 < Size)
+    Cells2 <<= 1;
+  Cells = new Cell[Cells2];
+  Mask = Cells2 - 1;
+  for (size_t i = 0; i < Cells2; i++)
+    Cells[i].Sequence.store (i, std::memory_order_relaxed);
+  Tail.store (0, std::memory_order_relaxed);
+  Head.store (0, std::memory_order_relaxed);
+}
+
+TouchBarGatewayQueue::~TouchBarGatewayQueue ()
+{
+  delete[] Cells;
+}
+
+boolean TouchBarGatewayQueue::Push (unsigned int Value)
+{
+  size_t Position = Tail.load (std::memory_order_relaxed);
+  while (true)
+  {
+    Cell *C = &Cells[Position & Mask];
+    size_t Sequence = C->Sequence.load (std::memory_order_acquire);
+    long Difference = (long)Sequence - (long)Position;
+    if (Difference == 0)
+    {
+      if (Tail.compare_exchange_weak (Position, Position + 1, std::memory_order_relaxed))
+      {
+        C->Value = Value;
+        C->Sequence.store (Position + 1, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (Difference < 0)
+      return false; // Full
+    else
+      Position = Tail.load (std::memory_order_relaxed);
+  }
+}
+
+boolean TouchBarGatewayQueue::Pop (unsigned int *Value)
+{
+  size_t Position = Head.load (std::memory_order_relaxed);
+  while (true)
+  {
+    Cell *C = &Cells[Position & Mask];
+    size_t Sequence = C->Sequence.load (std::memory_order_acquire);
+    long Difference = (long)Sequence - (long)(Position + 1);
+    if (Difference == 0)
+    {
+      if (Head.compare_exchange_weak (Position, Position + 1, std::memory_order_relaxed))
+      {
+        *Value = C->Value;
+        C->Sequence.store (Position + Mask + 1, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (Difference < 0)
+      return false; // Empty
+    else
+      Position = Head.load (std::memory_order_relaxed);
+  }
+}
+
+
+
+/* General */
+TouchBarGateway::TouchBarGateway (TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr, unsigned long BarCount, unsigned int WorkerCount, TouchBarGatewaySink SinkFunction, void *Context)
+{
+  Common = CommonPtr;
+  Common->Clock = GatewayClock;
+  Count = BarCount;
+  Workers = WorkerCount < 1 ? 1 : WorkerCount;
+  Sink = SinkFunction;
+  SinkContext = Context;
+  Active.store (0);
+  Samples.store (0);
+  Events.store (0);
+  Steals.store (0);
+
+  for (unsigned long First = 0; First < Count; First += GatewayShardBars)
+  {
+    Shard *S = new Shard;
+    unsigned long Bars = Count - First < GatewayShardBars ? Count - First : GatewayShardBars;
+    S->Bars.reserve (Bars); // Never moves after this, the callbacks point into it.
+    for (unsigned long i = 0; i < Bars; i++)
+      S->Bars.push_back (TouchBar (Common, ConfigPtr));
+    for (unsigned long i = 0; i < Bars; i++)
+      S->Bars[i].SetCallback (Notify, S);
+    S->First = First;
+    S->Home = Shards.size () % Workers;
+    S->BatchTail.store (0);
+    S->BatchHead.store (0);
+    S->Open = false;
+    S->EventTail.store (0);
+    S->EventHead.store (0);
+    S->Scheduled.store (0);
+    Shards.push_back (S);
+  }
+  for (unsigned int i = 0; i < Workers; i++)
+    Queues.push_back (new TouchBarGatewayQueue (Shards.size () + 1)); // Every shard fits, so Push() never fails.
+}
+
+TouchBarGateway::~TouchBarGateway ()
+{
+  if (Running)
+    Finish ();
+  for (size_t i = 0; i < Shards.size (); i++)
+    delete Shards[i];
+  for (size_t i = 0; i < Queues.size (); i++)
+    delete Queues[i];
+}
+
+TouchBar *TouchBarGateway::GetBar (unsigned long Bar)
+{
+  if (Bar >= Count)
+    return 0;
+  return &Shards[Bar / GatewayShardBars]->Bars[Bar % GatewayShardBars];
+}
+
+unsigned long TouchBarGateway::GetSamples ()
+{
+  return Samples.load ();
+}
+
+unsigned long TouchBarGateway::GetEvents ()
+{
+  return Events.load ();
+}
+
+unsigned long TouchBarGateway::GetSteals ()
+{
+  return Steals.load ();
+}
+
+
+
+/* Reader */
+void TouchBarGateway::Start ()
+{
+  if (Running)
+    return;
+  Running = true;
+  Done.store (false);
+  WorkersDone.store (false);
+  for (unsigned int i = 0; i < Workers; i++)
+    Threads.push_back (std::thread (&TouchBarGateway::Work, this, i));
+  Publisher = std::thread (&TouchBarGateway::Publish, this);
+}
+
+boolean TouchBarGateway::Put (const TouchBarGatewayRun *Run)
+{
+  if (Run->Bar >= Count)
+    return false;
+  unsigned int Index = Run->Bar / GatewayShardBars;
+  Shard *S = Shards[Index];
+  unsigned int Tail = S->BatchTail.load (std::memory_order_relaxed);
+  Batch *B = &S->Batches[Tail % GatewayBatches];
+  if (S->Open && (B->Runs == GatewayBatchRuns || B->Bytes + Run->Count > GatewayBatchBytes))
+  {
+    Close (Index);
+    Tail += 1;
+    B = &S->Batches[Tail % GatewayBatches];
+  }
+  if (S->Open == false)
+  {
+    // The next batch, once the worker is done with it.
+    unsigned int Idle = 0;
+    while (Tail - S->BatchHead.load (std::memory_order_acquire) >= GatewayBatches)
+      Pause (&Idle);
+    B->Runs = 0;
+    B->Bytes = 0;
+    S->Open = true;
+    OpenShards.push_back (Index);
+  }
+
+  TouchBarGatewayRun *R = &B->Run[B->Runs++];
+  R->Bar = Run->Bar % GatewayShardBars;
+  R->Time = Run->Time;
+  R->Period = Run->Period;
+  R->Count = Run->Count;
+  R->Samples = B->Data + B->Bytes;
+  memcpy (B->Data + B->Bytes, Run->Samples, Run->Count);
+  B->Bytes += Run->Count;
+  return true;
+}
+
+void TouchBarGateway::Close (unsigned int Index) // The batch being filled goes to the worker.
+{
+  Shard *S = Shards[Index];
+  S->BatchTail.store (S->BatchTail.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+  S->Open = false;
+  Hand (Index);
+}
+
+void TouchBarGateway::Flush ()
+{
+  for (size_t i = 0; i < OpenShards.size (); i++)
+    if (Shards[OpenShards[i]]->Open)
+      Close (OpenShards[i]);
+  OpenShards.clear ();
+}
+
+void TouchBarGateway::Hand (unsigned int Index)
+{
+  Shard *S = Shards[Index];
+  // Store (BatchTail, by the caller) then load (Scheduled) here, and the other way round in Work(). Release/acquire alone lets each side see the other's old value (even on x86, the store waits in the store buffer),
+  // the reader would see Scheduled still 1 while the worker sees no new batch, and the batch would be stranded. The fences on both sides make sure at least one of them sees the other.
+  std::atomic_thread_fence (std::memory_order_seq_cst);
+  if (S->Scheduled.exchange (1, std::memory_order_acq_rel) == 0)
+  {
+    Active.fetch_add (1);
+    Queues[S->Home]->Push (Index);
+  }
+}
+
+void TouchBarGateway::Finish ()
+{
+  if (Running == false)
+    return;
+  Flush ();
+  Done.store (true);
+  for (size_t i = 0; i < Threads.size (); i++)
+    Threads[i].join ();
+  Threads.clear ();
+  WorkersDone.store (true);
+  Publisher.join ();
+  Running = false;
+}
+
+
+
+/* Workers */
+void TouchBarGateway::Work (unsigned int Worker)
+{
+  unsigned int Idle = 0;
+  while (true)
+  {
+    unsigned int Index;
+    boolean Found = Queues[Worker]->Pop (&Index);
+    for (unsigned int k = 1; k < Workers && Found == false; k++)
+      if (Queues[(Worker + k) % Workers]->Pop (&Index))
+      {
+        Found = true;
+        Steals.fetch_add (1, std::memory_order_relaxed);
+      }
+
+    if (Found == false)
+    {
+      if (Done.load () && Active.load () == 0)
+        return;
+      Pause (&Idle);
+      continue;
+    }
+    Idle = 0;
+
+    Samples.fetch_add (Run (Index), std::memory_order_relaxed);
+
+    Shard *S = Shards[Index];
+    if (S->BatchHead.load (std::memory_order_relaxed) != S->BatchTail.load (std::memory_order_acquire))
+    {
+      Queues[Worker]->Push (Index); // Used up its slice, still has work: back in the queue (this worker's, it's the one that has its bars in cache).
+      continue;
+    }
+    // Done with it for now. A batch that came in meanwhile may have found it still Scheduled, so look once more after letting go.
+    S->Scheduled.store (0, std::memory_order_release);
+    std::atomic_thread_fence (std::memory_order_seq_cst); // See Hand()
+    if (S->BatchHead.load (std::memory_order_relaxed) != S->BatchTail.load (std::memory_order_acquire) && S->Scheduled.exchange (1, std::memory_order_acq_rel) == 0)
+      Queues[Worker]->Push (Index);
+    else
+      Active.fetch_sub (1);
+  }
+}
+
+unsigned long TouchBarGateway::Run (unsigned int Index) // Up to GatewaySlice batches of the shard, returns the number of samples.
+{
+  Shard *S = Shards[Index];
+  unsigned long Ran = 0;
+  for (byte Slice = 0; Slice < GatewaySlice; Slice++)
+  {
+    unsigned int Head = S->BatchHead.load (std::memory_order_relaxed);
+    if (Head == S->BatchTail.load (std::memory_order_acquire))
+      break;
+    const Batch *B = &S->Batches[Head % GatewayBatches];
+    for (unsigned int r = 0; r < B->Runs; r++)
+    {
+      const TouchBarGatewayRun *R = &B->Run[r];
+      TouchBar *Bar = &S->Bars[R->Bar];
+      for (byte i = 0; i < R->Count; i++)
+      {
+        GatewayNow = R->Time + (unsigned long)i * R->Period;
+        Bar->Update (R->Samples[i]);
+      }
+      Ran += R->Count;
+    }
+    S->BatchHead.store (Head + 1, std::memory_order_release);
+  }
+  return Ran;
+}
+
+void TouchBarGateway::Notify (const TouchBarEvent *Event, void *Context) // From Update(), on the worker running the shard.
+{
+  Shard *S = (Shard *)Context;
+  unsigned int Tail = S->EventTail.load (std::memory_order_relaxed);
+  unsigned int Idle = 0;
+  while (Tail - S->EventHead.load (std::memory_order_acquire) >= GatewayEvents)
+    Pause (&Idle); // The publisher is behind.
+  TouchBarGatewayEvent *E = &S->Events[Tail % GatewayEvents];
+  E->Bar = S->First + (Event->Source - &S->Bars[0]);
+  E->Time = Event->Time;
+  E->Value = Event->Value;
+  E->Type = Event->Type;
+  S->EventTail.store (Tail + 1, std::memory_order_release);
+}
+
+
+
+/* Publisher */
+size_t TouchBarGateway::Drain (Shard *S)
+{
+  size_t Drained = 0;
+  while (true)
+  {
+    unsigned int Head = S->EventHead.load (std::memory_order_relaxed);
+    unsigned int Tail = S->EventTail.load (std::memory_order_acquire);
+    if (Head == Tail)
+      return Drained;
+    // As many as there are in one piece, up to the end of the ring.
+    unsigned int Length = Tail - Head;
+    unsigned int Start = Head % GatewayEvents;
+    if (Length > GatewayEvents - Start)
+      Length = GatewayEvents - Start;
+    Sink (&S->Events[Start], Length, SinkContext);
+    S->EventHead.store (Head + Length, std::memory_order_release);
+    Drained += Length;
+  }
+}
+
+void TouchBarGateway::Publish ()
+{
+  unsigned int Idle = 0;
+  while (true)
+  {
+    boolean Last = WorkersDone.load (); // Read before the round, so a round after the workers are done drains everything.
+    size_t Drained = 0;
+    for (size_t i = 0; i < Shards.size (); i++)
+      Drained += Drain (Shards[i]);
+    Events.fetch_add (Drained, std::memory_order_relaxed);
+    if (Last)
+      return;
+    if (Drained == 0)
+      Pause (&Idle);
+    else
+      Idle = 0;
+  }
+}
+
+#endif
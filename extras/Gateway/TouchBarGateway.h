@@ -0,0 +1,135 @@
+#ifndef TouchBarGateway_H
+#define TouchBarGateway_H
+
+// Host only! Runs thousands of TouchBar objects on a Linux box, from the pad samples the panels forward, on a few worker threads. See TouchBarGateway.cpp
+// It's in extras/Gateway rather then next to the library, so the other host builds don't need threads. Build with -pthread.
+
+#ifndef ARDUINO
+
+#include "TouchBar.h"
+#include <stddef.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define GatewayShardBars 64 // Bars per shard. A shard is what a worker takes on (and steals) as a whole.
+#define GatewayBatchRuns 64 // Runs per batch
+#define GatewayBatchBytes 4096 // Samples per batch
+#define GatewayBatches 8 // Batches queued per shard (power of 2), the reader waits when they're all full.
+#define GatewayEvents 1024 // Events queued per shard (power of 2), a worker waits when they're all full.
+#define GatewaySlice 4 // Batches a worker runs of a shard before it lets the others have a turn.
+
+struct TouchBarGatewayRun // Samples of one bar, as a panel sends them.
+{
+  unsigned long Bar;
+  unsigned long Time; // us, of the first sample
+  unsigned int Period; // us between samples
+  byte Count;
+  const byte *Samples; // BiTB: 0(LSB) = PadA; 1 = PadB; 2 = PadC; Same as TouchBar::Update(byte).
+}; // <<< ; at the end is important!!!
+
+struct TouchBarGatewayEvent
+{
+  unsigned long Bar;
+  unsigned long Time; // us, the time of the sample it came from
+  TouchBarPosition Value;
+  byte Type; // TapEvent, StepEvent... same as TouchBarEvent
+}; // <<< ; at the end is important!!!
+
+typedef void (*TouchBarGatewaySink) (const TouchBarGatewayEvent *Events, size_t Count, void *Context); // Gets the events of every bar, from one thread only (the publisher).
+
+class TouchBarGatewayQueue // Bounded, lock-free, any number of threads on either end (Dmitry Vyukov's MPMC queue). Shard numbers waiting for a worker.
+{
+  private:
+    struct Cell
+    {
+      std::atomic<size_t> Sequence;
+      unsigned int Value;
+    };
+    Cell *Cells;
+    size_t Mask;
+    alignas(64) std::atomic<size_t> Tail;
+    alignas(64) std::atomic<size_t> Head;
+
+  public:
+    TouchBarGatewayQueue (size_t Size); // Rounded up to a power of 2.
+    ~TouchBarGatewayQueue ();
+    boolean Push (unsigned int Value); // Returns false when full.
+    boolean Pop (unsigned int *Value); // Returns false when empty.
+}; // <<< ; at the end is important!!!
+
+class TouchBarGateway
+{
+  private:
+    struct Batch
+    {
+      unsigned int Runs;
+      unsigned int Bytes;
+      TouchBarGatewayRun Run[GatewayBatchRuns]; // Bar is the index in the shard here, Samples points into Data.
+      byte Data[GatewayBatchBytes];
+    };
+    struct Shard
+    {
+      std::vector<TouchBar> Bars;
+      unsigned long First; // Bar number of Bars[0]
+      unsigned int Home; // The worker it's queued to
+      // Batches, the reader fills them, the worker running the shard empties them.
+      Batch Batches[GatewayBatches];
+      alignas(64) std::atomic<unsigned int> BatchTail;
+      alignas(64) std::atomic<unsigned int> BatchHead;
+      boolean Open; // The reader has a batch started at BatchTail (reader only)
+      // Events, the worker running the shard fills them, the publisher empties them.
+      TouchBarGatewayEvent Events[GatewayEvents];
+      alignas(64) std::atomic<unsigned int> EventTail;
+      alignas(64) std::atomic<unsigned int> EventHead;
+      // Queued or running, so no other worker takes it on meanwhile.
+      alignas(64) std::atomic<byte> Scheduled;
+    };
+
+    TouchBarCommon *Common;
+    unsigned long Count;
+    unsigned int Workers;
+    TouchBarGatewaySink Sink;
+    void *SinkContext;
+    std::vector<Shard *> Shards;
+    std::vector<TouchBarGatewayQueue *> Queues; // One per worker
+    std::vector<unsigned int> OpenShards; // Reader only
+    std::vector<std::thread> Threads;
+    std::thread Publisher;
+    std::atomic<long> Active; // Shards queued or running
+    std::atomic<boolean> Done; // No more input
+    std::atomic<boolean> WorkersDone;
+    std::atomic<unsigned long> Samples;
+    std::atomic<unsigned long> Events;
+    std::atomic<unsigned long> Steals;
+    boolean Running = false;
+
+    static void Notify (const TouchBarEvent *Event, void *Context);
+    void Hand (unsigned int Index); // Queues a shard to its worker, if it isn't already.
+    void Close (unsigned int Index);
+    void Work (unsigned int Worker);
+    unsigned long Run (unsigned int Index);
+    void Publish ();
+    size_t Drain (Shard *S);
+
+  public:
+    // Constructor
+    TouchBarGateway (TouchBarCommon *CommonPtr, TouchBarConfig *ConfigPtr, unsigned long BarCount, unsigned int WorkerCount, TouchBarGatewaySink SinkFunction, void *Context = 0);
+    // All bars start with ConfigPtr, GetBar() them before Start() to give some another one. CommonPtr->Clock is set to the time of the sample being run, so TapTime, TwitchSuppressionTime and RampTime time the bars.
+    ~TouchBarGateway ();
+
+    // Operation
+    void Start (); // Starts the workers and the publisher.
+    boolean Put (const TouchBarGatewayRun *Run); // Call it from one thread only (the reader). Returns false if Bar is out of range. The run may wait in a batch until the next Flush().
+    void Flush (); // Hands over the batches started, call it after each read from the transport so nothing waits for more input.
+    void Finish (); // Flushes, waits until everything is run and published, and stops the threads. Start() again to go on.
+
+    TouchBar *GetBar (unsigned long Bar); // Only while stopped.
+    unsigned long GetSamples ();
+    unsigned long GetEvents ();
+    unsigned long GetSteals (); // Shards a worker took over from another's queue
+}; // <<< ; at the end is important!!!
+
+#endif
+
+#endif
@@ -0,0 +1,232 @@
+/*
+GestureCheck - host tool that checks the gesture recognizer (TouchBarGesture.cpp) with scripted touches, each with the exact gestures it should give.
+
+- Single, double and triple taps, on one pad and across pads, and taps too far apart to make a double.
+- Long press, press and swipe, a press let go too early (a tap then), and a second or third tap held too long (nothing).
+- Chords on AB, BC and AC (GetGesturePads() 3, 6 and 5), and chords that turn into something else, or step by letting go of one pad first.
+- Swipes (light, hard and skipped) and a pad touched while another one is held give nothing.
+- With the Flip flag pads A and C swap, in GetGesturePads() as in PadEvent().
+- Only the gestures set in TouchBarConfig::Gestures are reported, the rest are still recognized (a double tap turned off doesn't come out as 2 single ones).
+- When: a single or double tap MultiTapTime after it was let go, a triple tap and a long press when they're let go, a press and swipe when it starts moving.
+- GestureEvent (gesture << 8 | pads) is reported just when GetGesture() has one, and PadEvent() still reports every tap straight away.
+- The same with the Clock set and with micros().
+
+Build it from the library folder like so (TouchBarGestures has to be defined, here or at the top of TouchBar.h):
+g++ -O2 -DTouchBarGestures -I . *.cpp extras/GestureCheck/GestureCheck.cpp -o GestureCheck
+
+Then:
+./GestureCheck <<< Runs the check, returns non-zero on any failure.
+*/
+
+#include "TouchBar.h"
+#include "TouchBarSimulator.h"
+#include <stdio.h>
+#include <string>
+
+#ifndef TouchBarGestures
+#error "GestureCheck needs TouchBarGestures, build it with -DTouchBarGestures"
+#endif
+
+static long Errors = 0;
+
+static void Expect (boolean Condition, const char *What)
+{
+  if (!Condition)
+  {
+    printf ("FAILED: %s\n", What);
+    Errors++;
+  }
+}
+
+#define Sample 1000 // us between updates
+#define Suppression 3000 // TwitchSuppressionTime
+#define Gap 100000 // Between taps, well within MultiTapTime
+#define Later 1000000 // Long enough for anything to be reported
+
+struct Found
+{
+  std::string Gestures; // Each one as a letter and the pads: "D2" is a double tap on B
+  std::string Taps; // PadEvent()
+  unsigned long Time[8]; // Of each gesture, from the start of the script
+  unsigned long Last[8]; // The last pad change before it
+  byte Pads[8]; // Touched when it was reported
+  int Events; // GestureEvent reported right
+  int Count;
+}; // <<< ; at the end is important!!!
+
+static void Record (const TouchBarEvent *Event, void *Context)
+{
+  if (Event->Type != GestureEvent)
+    return;
+  TouchBar *Bar = Event->Source;
+  if (Event->Value == (TouchBarPosition) (Bar->GetGesture () << 8 | Bar->GetGesturePads ()))
+    ((Found *) Context)->Events += 1;
+}
+
+static Found Run (TouchBarSimulator *Sim, byte Gestures, boolean Flip, boolean WallClock)
+{
+  TouchBarCommon Common = {150, Suppression / Sample, WallClock ? micros : 0, 150000, Suppression}; // The same times in updates, for without the Clock
+  TouchBarConfig Config;
+  Config.Default = 5000;
+  Config.Limit = 10000;
+  Config.Resolution = 100;
+  Config.SetFlags (false, false, false, Flip);
+  Config.Gestures = Gestures;
+  Config.MultiTapTime = 300000;
+  Config.LongPressTime = 500000;
+  TouchBar Bar (&Common, &Config);
+  Bar.SetPosition (Config.Default);
+
+  Found F;
+  F.Events = 0;
+  F.Count = 0;
+  Bar.SetCallback (Record, &F);
+  SetVirtualMicros (12345);
+  Sim->Rewind ();
+  unsigned long Start = micros (), Change = 0;
+  byte Pads, Previous = 0;
+  while (Sim->Next (&Pads))
+  {
+    if (Pads != Previous)
+      Change = micros () - Start;
+    Previous = Pads;
+    Bar.Update (Pads);
+    char Pad = Bar.PadEvent ();
+    if (Pad != 'Z')
+      F.Taps += Pad;
+    if (Bar.GetGesture () != NoGesture)
+    {
+      F.Gestures += " SDTLPC"[Bar.GetGesture ()];
+      F.Gestures += '0' + Bar.GetGesturePads ();
+      if (F.Count < 8)
+      {
+        F.Time[F.Count] = micros () - Start;
+        F.Last[F.Count] = Change;
+        F.Pads[F.Count] = Pads;
+      }
+      F.Count += 1;
+    }
+  }
+  return F;
+}
+
+static void Check (const char *Name, TouchBarSimulator *Sim, const char *Gestures, const char *Taps = 0, byte Enabled = 0x7E, boolean Flip = false)
+{
+  char What[200];
+  for (int WallClock = 0; WallClock < 2; WallClock++)
+  {
+    Found F = Run (Sim, Enabled, Flip, WallClock);
+    snprintf (What, sizeof (What), "%s%s: gestures %s, got %s", Name, WallClock ? " (Clock)" : "", Gestures, F.Gestures.c_str ());
+    Expect (F.Gestures == Gestures, What);
+    snprintf (What, sizeof (What), "%s%s: GestureEvent for each gesture", Name, WallClock ? " (Clock)" : "");
+    Expect (F.Events == F.Count, What);
+    if (Taps != 0)
+    {
+      snprintf (What, sizeof (What), "%s%s: PadEvent() taps %s, got %s", Name, WallClock ? " (Clock)" : "", Taps, F.Taps.c_str ());
+      Expect (F.Taps == Taps, What);
+    }
+    // When: single and double taps wait MultiTapTime after being let go (unless another pad is touched before that), the rest come with the pad change that ends them. Plus the twitch suppression.
+    for (int i = 0; i < F.Count && i < 8; i++)
+    {
+      char Type = F.Gestures[2 * i];
+      unsigned long Delay = F.Time[i] - F.Last[i], Least = 0, Most = Suppression + 2 * Sample;
+      if ((Type == 'S' || Type == 'D') && F.Pads[i] == 0)
+      {
+        Least = 300000;
+        Most += 300000;
+      }
+      snprintf (What, sizeof (What), "%s%s: gesture %d reported %lu us after the last pad change", Name, WallClock ? " (Clock)" : "", i + 1, Delay);
+      Expect (Delay >= Least && Delay <= Most, What);
+    }
+  }
+}
+
+
+
+int main ()
+{
+  TouchBarSimulator Sim (Sample);
+
+  // Taps
+  Sim.Clear (); Sim.Idle (Gap); Sim.Tap ('B', 50000); Sim.Idle (Later);
+  Check ("single tap on B", &Sim, "S2", "B");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Tap ('B', 50000); Sim.Idle (Gap); Sim.Tap ('B', 50000); Sim.Idle (Later);
+  Check ("double tap on B", &Sim, "D2", "BB");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Tap ('C', 50000); Sim.Idle (Gap); Sim.Tap ('C', 50000); Sim.Idle (Gap); Sim.Tap ('C', 50000); Sim.Idle (Later);
+  Check ("triple tap on C", &Sim, "T4", "CCC");
+  Sim.Clear (); Sim.Idle (Gap); for (int i = 0; i < 4; i++) { Sim.Tap ('A', 50000); Sim.Idle (Gap); } Sim.Idle (Later);
+  Check ("4 taps on A: a triple tap, then a single one", &Sim, "T1S1", "AAAA");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Tap ('A', 50000); Sim.Idle (Gap); Sim.Tap ('A', 50000); Sim.Idle (Gap); Sim.Tap ('B', 50000); Sim.Idle (Later);
+  Check ("double tap on A, then a tap on B", &Sim, "D1S2", 0);
+  Sim.Clear (); Sim.Idle (Gap); Sim.Tap ('A', 50000); Sim.Idle (Gap); Sim.Tap ('C', 50000); Sim.Idle (Later);
+  Check ("tap on A, then on C", &Sim, "S1S4", 0);
+  Sim.Clear (); Sim.Idle (Gap); Sim.Tap ('B', 50000); Sim.Idle (400000); Sim.Tap ('B', 50000); Sim.Idle (Later);
+  Check ("2 taps on B further apart then MultiTapTime", &Sim, "S2S2", "BB");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Tap ('B', 50000); Sim.Idle (Gap); Sim.Hold (2, 800000); Sim.Idle (Later);
+  Check ("tap on B, then held past LongPressTime", &Sim, "");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Tap ('B', 50000); Sim.Idle (Gap); Sim.Tap ('B', 50000); Sim.Idle (Gap); Sim.Hold (2, 800000); Sim.Idle (Later);
+  Check ("2 taps on B, then held past LongPressTime", &Sim, "");
+
+  // Held
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (1, 800000); Sim.Idle (Later);
+  Check ("long press on A", &Sim, "L1", "");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (2, 300000); Sim.Idle (Later);
+  Check ("press on B let go before LongPressTime", &Sim, "S2", "");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (2, 700000); Sim.Hold (6, 20000); Sim.Hold (4, 20000); Sim.Hold (5, 20000); Sim.Idle (Later);
+  Check ("press and swipe from B", &Sim, "P2", "");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (1, 700000); Sim.Hold (4, 20000); Sim.Idle (Later);
+  Check ("held A, jumping to C", &Sim, "P1", "");
+
+  // Chords
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (3, 200000); Sim.Idle (Later);
+  Check ("chord AB", &Sim, "C3");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (6, 200000); Sim.Idle (Later);
+  Check ("chord BC", &Sim, "C6");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (5, 900000); Sim.Idle (Later);
+  Check ("chord AC, held past LongPressTime", &Sim, "C5");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (3, 200000); Sim.Hold (2, 20000); Sim.Idle (Later);
+  Check ("chord AB, let go of A first (AB, B is a step)", &Sim, "");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (3, 200000); Sim.Hold (1, 200000); Sim.Idle (Later);
+  Check ("chord AB, let go of B first and held (AB, A is a step)", &Sim, "");
+  Sim.Clear (); Sim.Idle (2 * Suppression); Sim.Hold (3, 3 * Suppression); Sim.Hold (2, 3 * Suppression); Sim.Idle (Later);
+  Check ("AB, then B, then let go, quickly", &Sim, "");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (3, 200000); Sim.Hold (6, 20000); Sim.Idle (Later);
+  Check ("chord AB turning into a swipe", &Sim, "");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (3, 200000); Sim.Hold (4, 20000); Sim.Idle (Later);
+  Check ("chord AB, then C alone", &Sim, "");
+
+  // Nothing
+  Sim.Clear (); Sim.Idle (Gap); Sim.LightSwipe (true, 12, 20000); Sim.Idle (Later);
+  Check ("light swipe", &Sim, "");
+  Sim.Clear (); Sim.Idle (Gap); Sim.HardSwipe (false, 12, 20000); Sim.Idle (Later);
+  Check ("hard swipe", &Sim, "");
+  Sim.Clear (); Sim.Idle (Gap); Sim.SkipSwipe (true, 12, 20000); Sim.Idle (Later);
+  Check ("skipped swipe", &Sim, "");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (1, 100000); Sim.Hold (5, 50000); Sim.Hold (1, 100000); Sim.Idle (Later);
+  Check ("C touched while A is held", &Sim, "");
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (7, 200000); Sim.Idle (Later);
+  Check ("all 3 pads", &Sim, "");
+
+  // Flip: A and C swap
+  Sim.Clear (); Sim.Idle (Gap); Sim.Tap ('A', 50000); Sim.Idle (Gap); Sim.Tap ('A', 50000); Sim.Idle (Later);
+  Check ("flipped double tap on A", &Sim, "D4", "CC", 0x7E, true);
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (4, 800000); Sim.Idle (Later);
+  Check ("flipped long press on C", &Sim, "L1", 0, 0x7E, true);
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (2, 800000); Sim.Idle (Later);
+  Check ("flipped long press on B", &Sim, "L2", 0, 0x7E, true);
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (3, 200000); Sim.Idle (Later);
+  Check ("flipped chord AB", &Sim, "C6", 0, 0x7E, true);
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (5, 200000); Sim.Idle (Later);
+  Check ("flipped chord AC", &Sim, "C5", 0, 0x7E, true);
+
+  // Only the ones turned on
+  Sim.Clear (); Sim.Idle (Gap); Sim.Tap ('B', 50000); Sim.Idle (Gap); Sim.Tap ('B', 50000); Sim.Idle (Gap); Sim.Tap ('A', 50000); Sim.Idle (Later);
+  Check ("double tap turned off", &Sim, "S1", "BBA", 1 << SingleTapGesture | 1 << LongPressGesture);
+  Check ("single tap turned off", &Sim, "D2", "BBA", 1 << DoubleTapGesture);
+  Check ("all turned off", &Sim, "", "BBA", 0);
+  Sim.Clear (); Sim.Idle (Gap); Sim.Hold (2, 700000); Sim.Hold (6, 20000); Sim.Idle (Later);
+  Check ("press and swipe turned off", &Sim, "", 0, 1 << LongPressGesture);
+
+  printf ("%ld failures\n", Errors);
+  return Errors != 0;
+}
@@ -0,0 +1,292 @@
+/*
+InstrumentationCheck - host tool that checks the TouchBarInstrumentation counters. It has to be built with TouchBarInstrumentation defined, the library along with it.
+
+- Scripted touches (a tap, a long hold, a tap with Flip and Snap, a light and a hard swipe, a skipped state, twitches, the per-pad debouncer, a snap ramp), with the counters they have to come out with, worked out by hand.
+- The Cost histogram, with HostCost pointed at a script of known costs: which bucket each one lands in, and that the buckets stop at 65535.
+- Random pads and settings, the counters against what the callback reported meanwhile (taps, steps, skips, snaps, ramp steps) and against the Update() calls that weren't skipped while Idle().
+
+Build it from the library folder like so (the per-pad debouncer case needs TouchBarDebouncer, it's left out without it):
+g++ -O2 -DTouchBarInstrumentation -DTouchBarDebouncer -I . *.cpp extras/InstrumentationCheck/InstrumentationCheck.cpp -o InstrumentationCheck
+
+Then:
+./InstrumentationCheck <<< Runs the check, returns non-zero on any failure.
+*/
+
+#include "TouchBar.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef TouchBarInstrumentation
+  #error Build it with -DTouchBarInstrumentation
+#endif
+
+static long Errors = 0;
+
+static void Expect (boolean Condition, const char *What)
+{
+  if (!Condition)
+  {
+    printf ("FAILED: %s\n", What);
+    Errors++;
+  }
+}
+
+struct Expected // The counters a script has to end with, Cost aside.
+{
+  unsigned long Updates, Rejected, TapA, TapB, TapC, TapsTimedOut, Skips, HardDecodes, LightDecodes, Snaps, RampSteps;
+}; // <<< ; at the end is important!!!
+
+static void Feed (TouchBar *Bar, byte Pads, int Count)
+{
+  for (int i = 0; i < Count; i++)
+    Bar->Update (Pads);
+}
+
+static void Compare (const char *Name, TouchBar *Bar, Expected Want)
+{
+  const TouchBarCounters *Got = Bar->GetCounters ();
+  unsigned long Costs = 0;
+  for (byte i = 0; i < 16; i++)
+    Costs += Got->Cost[i];
+  if (Got->Updates != Want.Updates || Got->Rejected != Want.Rejected || Got->Taps[0] != Want.TapA || Got->Taps[1] != Want.TapB || Got->Taps[2] != Want.TapC || Got->TapsTimedOut != Want.TapsTimedOut
+      || Got->Skips != Want.Skips || Got->HardDecodes != Want.HardDecodes || Got->LightDecodes != Want.LightDecodes || Got->Snaps != Want.Snaps || Got->RampSteps != Want.RampSteps || Costs != Got->Updates)
+  {
+    printf ("FAILED: %s: updates %lu (%lu), rejected %lu (%lu), taps %lu %lu %lu (%lu %lu %lu), timed out %lu (%lu), skips %lu (%lu), hard %lu (%lu), light %lu (%lu), snaps %lu (%lu), ramp steps %lu (%lu), costs %lu\n", Name,
+            Got->Updates, Want.Updates, Got->Rejected, Want.Rejected, Got->Taps[0], Got->Taps[1], Got->Taps[2], Want.TapA, Want.TapB, Want.TapC, Got->TapsTimedOut, Want.TapsTimedOut,
+            Got->Skips, Want.Skips, Got->HardDecodes, Want.HardDecodes, Got->LightDecodes, Want.LightDecodes, Got->Snaps, Want.Snaps, Got->RampSteps, Want.RampSteps, Costs);
+    Errors++;
+  }
+}
+
+// With TwitchSuppressionDelay 2 a touch (or release) from / to nothing is held back for 2 updates, and let through on the 3rd.
+// The first update with nothing touched leaves the bar Idle(), the ones after that aren't counted. Letting go takes 4 updates: 2 held back, the release, and one more to settle.
+static void Scripts ()
+{
+  TouchBarCommon Common = {50, 2};
+  TouchBarConfig Config;
+  Config.Default = 500;
+  Config.Limit = 1000;
+  Config.Resolution = 10;
+  Config.RampDelay = 1;
+  Config.RampResolution = 5;
+
+  Config.SetFlags (false, false, false, false);
+  TouchBar Tap (&Common, &Config);
+  Feed (&Tap, 0, 10);
+  Feed (&Tap, 2, 5);
+  Feed (&Tap, 0, 10);
+  Compare ("tap on B", &Tap, {1 + 5 + 4, 4, 0, 1, 0, 0, 0, 0, 0, 0, 0});
+
+  TouchBar Hold (&Common, &Config);
+  Feed (&Hold, 0, 10);
+  Feed (&Hold, 4, 100); // Longer then TapTimeout
+  Feed (&Hold, 0, 10);
+  Compare ("long hold on C", &Hold, {1 + 100 + 4, 4, 0, 0, 0, 1, 0, 0, 0, 0, 0});
+
+  TouchBar Swipe (&Common, &Config);
+  Feed (&Swipe, 0, 10);
+  static const byte Up[5] = {1, 3, 2, 6, 4};
+  for (byte i = 0; i < 5; i++)
+    Feed (&Swipe, Up[i], 5); // From one combination to the next passes straight away, 4 steps up.
+  Feed (&Swipe, 0, 10);
+  Compare ("light swipe", &Swipe, {1 + 25 + 4, 4, 0, 0, 0, 1, 0, 0, 4, 0, 0});
+  Expect (Swipe.GetPositionInt () == 540, "light swipe: 4 steps up");
+
+  TouchBar Hard (&Common, &Config);
+  Feed (&Hard, 0, 10);
+  static const byte Pressed[5] = {1, 3, 7, 6, 4}; // Pressing hard: into all 3 pads and out of them are hard decodes, the other 2 light.
+  for (byte i = 0; i < 5; i++)
+    Feed (&Hard, Pressed[i], 5);
+  Feed (&Hard, 0, 10);
+  Compare ("hard swipe", &Hard, {1 + 25 + 4, 4, 0, 0, 0, 1, 0, 2, 2, 0, 0});
+  Expect (Hard.GetPositionInt () == 540, "hard swipe: 4 steps up");
+
+  TouchBar Skip (&Common, &Config);
+  Feed (&Skip, 0, 10);
+  Feed (&Skip, 1, 5);
+  Feed (&Skip, 2, 5); // AB missed: Increment2. Still a single pad, let go in time: a tap on B.
+  Feed (&Skip, 0, 10);
+  Compare ("skip", &Skip, {1 + 10 + 4, 4, 0, 1, 0, 0, 1, 0, 1, 0, 0});
+  Expect (Skip.GetPositionInt () == 520, "skip: 2 steps up");
+
+  TouchBar Twitch (&Common, &Config);
+  Feed (&Twitch, 0, 10);
+  for (int i = 0; i < 3; i++)
+  {
+    Feed (&Twitch, 1, 1); // Held back, gone before it's let through: nothing but the update and the rejection.
+    Feed (&Twitch, 0, 5); // The first one settles, the rest are skipped.
+  }
+  Compare ("twitches", &Twitch, {1 + 3 * 2, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+
+  Config.SetFlags (false, true, false, true);
+  TouchBar Flip (&Common, &Config);
+  Feed (&Flip, 0, 10);
+  Feed (&Flip, 1, 5);
+  Feed (&Flip, 0, 10);
+  Compare ("tap on A with Flip and Snap", &Flip, {1 + 5 + 4, 4, 0, 0, 1, 0, 0, 0, 0, 1, 0});
+  Expect (Flip.GetPositionInt () == Config.Limit, "Flip: pad A snaps to the top");
+
+  Config.SetFlags (false, true, true, false);
+  TouchBar Ramp (&Common, &Config);
+  Feed (&Ramp, 0, 10);
+  Feed (&Ramp, 4, 5);
+  Feed (&Ramp, 0, 200); // Snaps the target to 1000, 100 steps of 5 from 500, one per update from the release on. One more to settle.
+  Compare ("snap ramp", &Ramp, {1 + 5 + 2 + 100 + 1, 4, 0, 0, 1, 0, 0, 0, 0, 1, 100});
+  Expect (Ramp.GetPositionInt () == 1000, "snap ramp: gets there");
+
+  Ramp.ResetCounters ();
+  const TouchBarCounters *Zero = Ramp.GetCounters ();
+  Expect (Zero->Updates == 0 && Zero->Rejected == 0 && Zero->Taps[0] == 0 && Zero->Cost[0] == 0, "ResetCounters()");
+
+#ifdef TouchBarDebouncer
+  // The per-pad debouncer: DebounceDelay 3 holds an edge back for 2 updates, a pad twitching doesn't hold back the others.
+  TouchBarCommon Debounced = {50, 0, 0, 0, 0, 3};
+  Config.SetFlags (false, false, false, false);
+  TouchBar Debounce (&Debounced, &Config);
+  Feed (&Debounce, 0, 10);
+  Feed (&Debounce, 1, 5);
+  Feed (&Debounce, 0, 10);
+  Feed (&Debounce, 2, 1); // A twitch: 1 held back
+  Feed (&Debounce, 0, 5);
+  Compare ("debounced tap and twitch", &Debounce, {1 + 5 + 4 + 2, 4 + 1, 1, 0, 0, 0, 0, 0, 0, 0, 0});
+#endif
+}
+
+// The Cost histogram: HostCost returns the start of each Update() on odd calls and the end on even ones, so every update costs exactly what the script says.
+static const unsigned long *CostScript;
+static unsigned long CostClock = 0;
+static boolean CostEnd = false;
+
+static unsigned long ScriptedCost ()
+{
+  if (CostEnd)
+    CostClock += *CostScript++;
+  CostEnd = !CostEnd;
+  return CostClock;
+}
+
+static void Costs ()
+{
+  TouchBarCommon Common = {50, 2};
+  TouchBarConfig Config;
+  Config.Default = 500;
+  Config.Limit = 1000;
+  Config.Resolution = 10;
+  Config.RampDelay = 1;
+  Config.RampResolution = 5;
+  Config.SetFlags (false, false, false, false);
+  TouchBar Bar (&Common, &Config);
+
+  // Cost[0]: 0, Cost[n]: 2^(n-1) to 2^n - 1, Cost[15]: 16384 and up.
+  static const unsigned long Script[10] = {0, 1, 2, 3, 4, 7, 8, 1000, 65535, 100000};
+  static const unsigned int Buckets[16] = {1, 1, 2, 2, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 2};
+  CostScript = Script;
+  HostCost = ScriptedCost;
+  Feed (&Bar, 1, 10);
+  boolean Same = memcmp (Bar.GetCounters ()->Cost, Buckets, sizeof(Buckets)) == 0;
+  Expect (Same && Bar.GetCounters ()->Updates == 10, "each cost in its bucket");
+
+  // Stops counting at 65535 (16 bits on AVR), Updates goes on.
+  static unsigned long Free[70000] = {};
+  CostScript = Free;
+  Bar.ResetCounters ();
+  Feed (&Bar, 1, 70000);
+  Expect (Bar.GetCounters ()->Cost[0] == 65535 && Bar.GetCounters ()->Updates == 70000, "the buckets stop at 65535");
+  HostCost = HostNanos;
+}
+
+// Random pads and settings, the counters against the callback.
+struct Reported
+{
+  unsigned long Taps[3], Steps, Skips, Positions;
+}; // <<< ; at the end is important!!!
+
+static void Report (const TouchBarEvent *Event, void *Context)
+{
+  Reported *R = (Reported *) Context;
+  if (Event->Type == TapEvent)
+    R->Taps[Event->Value - 'A'] += 1;
+  if (Event->Type == StepEvent)
+  {
+    R->Steps += 1;
+    if (Event->Value == Increment2 || Event->Value == Decrement2)
+      R->Skips += 1;
+  }
+  if (Event->Type == PositionEvent)
+    R->Positions += 1;
+}
+
+static void Random (long Runs)
+{
+  static const byte Cycle[6] = {1, 3, 2, 6, 4, 5};
+  for (long Run = 0; Run < Runs; Run++)
+  {
+    TouchBarCommon Common = {(unsigned int)(20 + rand () % 200), (byte)(rand () % 20)};
+    if (rand () % 4 == 0)
+      Common.DebounceDelay = 1 + rand () % 20;
+    TouchBarConfig Config;
+    Config.Limit = 100 + rand () % 60000;
+    Config.Default = rand () % Config.Limit;
+    Config.Resolution = 1 + rand () % 99;
+    Config.RampDelay = 1 + rand () % 20;
+    Config.RampResolution = 1 + rand () % 255;
+    if (rand () % 4 == 0)
+      Config.SetFlags ((boolean)true, (boolean)(rand () % 2));
+    else
+      Config.SetFlags ((boolean)(rand () % 2), (boolean)(rand () % 2), (boolean)(rand () % 2), (boolean)(rand () % 2));
+    TouchBar Bar (&Common, &Config);
+    Reported R = {};
+    Bar.SetCallback (Report, &R);
+
+    unsigned long Updates = 0;
+    byte Pads = 0;
+    int Spot = 0;
+    for (long i = 0; i < 20000; i++)
+    {
+      switch (rand () % 12)
+      {
+        case 0: Pads = 0;
+        break;;
+        case 1: Pads = rand () % 8;
+        break;;
+        case 2: case 3: Spot = (Spot + 1) % 6; Pads = Cycle[Spot];
+        break;;
+        case 4: Spot = (Spot + 5) % 6; Pads = Cycle[Spot];
+        break;;
+        case 5: Spot = (Spot + 2) % 6; Pads = Cycle[Spot]; // A skip
+        break;;
+      }
+      if (Bar.Idle () == false || Pads != 0)
+        Updates++;
+      Bar.Update (Pads);
+    }
+
+    const TouchBarCounters *Got = Bar.GetCounters ();
+    boolean Good = Got->Updates == Updates && Got->Taps[0] == R.Taps[0] && Got->Taps[1] == R.Taps[1] && Got->Taps[2] == R.Taps[2] && Got->Skips == R.Skips && Got->HardDecodes + Got->LightDecodes == R.Steps;
+    if (Config.GetSnapFlag () == true)
+      Good = Good && Got->Snaps == R.Taps[0] + R.Taps[1] + R.Taps[2];
+    else
+      Good = Good && Got->Snaps == 0;
+    if (Config.GetRampFlag () == true)
+      Good = Good && Got->RampSteps == R.Positions; // Only the ramp moves the position then, one step per update.
+    else
+      Good = Good && Got->RampSteps == 0;
+    if (Good == false)
+    {
+      printf ("FAILED: random run %ld: updates %lu (%lu), taps %lu %lu %lu (%lu %lu %lu), skips %lu (%lu), decodes %lu (%lu steps), snaps %lu, ramp steps %lu (%lu positions)\n", Run, Got->Updates, Updates,
+              Got->Taps[0], Got->Taps[1], Got->Taps[2], R.Taps[0], R.Taps[1], R.Taps[2], Got->Skips, R.Skips, Got->HardDecodes + Got->LightDecodes, R.Steps, Got->Snaps, Got->RampSteps, R.Positions);
+      Errors++;
+    }
+  }
+}
+
+int main ()
+{
+  srand (1);
+  Scripts ();
+  Costs ();
+  Random (200);
+  printf ("%ld failures\n", Errors);
+  return Errors != 0;
+}
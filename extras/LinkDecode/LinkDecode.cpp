@@ -0,0 +1,318 @@
+/*
+LinkDecode - host tool for TouchBarLink: decodes what comes off the serial port, and checks the board and the host end against each other.
+
+Build it from the library folder like so:
+g++ -O2 -I . *.cpp extras/LinkDecode/LinkDecode.cpp -o LinkDecode
+
+Then:
+./LinkDecode --check <<< Runs the check, returns non-zero on any failure:
+  - Random scripts from TouchBarSimulator at 10 kHz through a TouchBar and a TouchBarLink, over a 115200 baud line with a 64 byte TX buffer: the host ends up with the same position and target as the bar,
+    never gets frames closer then the Interval, and the link never waits for the line. Prints how many bytes that took, against a line of text per Event() like the examples print.
+  - The same with random bit errors on the line: bad frames are dropped and counted, and the host still ends up right.
+  - Every command, with good and bad values, fields and configs, and a command with a bad CRC.
+./LinkDecode [File] <<< Reads a capture (or the port itself: stty -F /dev/ttyUSB0 115200 raw; ./LinkDecode /dev/ttyUSB0), or stdin, prints a CSV line for every good frame:
+  S,Sequence,Id,Time,Fields,Position,Target,Tap,Gesture,GesturePads,Skipped,Broken
+  V,Sequence,Id,Config,Field,Value,CommandSequence
+  E,Sequence,Id,Config,Field,Error,CommandSequence
+  I,Sequence,Id,Version,ConfigCount,Interval
+  And at the end: # Frames, bad frames, lost frames.
+*/
+
+#include "TouchBar.h"
+#include "TouchBarSimulator.h"
+#include "TouchBarLinkHost.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static long Errors = 0;
+
+static void Expect (boolean Condition, const char *What)
+{
+  if (!Condition)
+  {
+    printf ("FAILED: %s\n", What);
+    Errors++;
+  }
+}
+
+// The line: 115200 baud (11.52 bytes per ms) out of a 64 byte TX buffer, like Serial on an AVR board.
+static std::vector<byte> Line;
+static double Buffered = 0;
+static unsigned long Drained = 0;
+
+static void Drain ()
+{
+  Buffered -= (micros () - Drained) * 0.01152;
+  if (Buffered < 0)
+    Buffered = 0;
+  Drained = micros ();
+}
+
+static void Output (byte Data)
+{
+  Drain ();
+  Expect (Buffered + 1 <= 64, "the link never waits for the line");
+  Buffered += 1;
+  Line.push_back (Data);
+}
+
+static void Capture (byte Data) // No line, for the commands
+{
+  Line.push_back (Data);
+}
+
+static int Room ()
+{
+  Drain ();
+  return 64 - (int)Buffered;
+}
+
+static void RandomScript (TouchBarSimulator *Sim)
+{
+  Sim->Clear ();
+  Sim->Idle (1000 + rand () % 100000);
+  for (int i = 0; i < 100; i++)
+  {
+    unsigned long Step = 500 + rand () % 20000;
+    switch (rand () % 5)
+    {
+      case 0: Sim->Tap ('A' + rand () % 3, 1000 + rand () % 60000); break;
+      case 1: Sim->LightSwipe (rand () % 2, 1 + rand () % 30, Step); break;
+      case 2: Sim->HardSwipe (rand () % 2, 1 + rand () % 30, Step); break;
+      case 3: Sim->SkipSwipe (rand () % 2, 1 + rand () % 30, Step); break;
+      case 4: Sim->Hold (rand () % 8, 1000 + rand () % 500000); break;
+    }
+    Sim->Idle (rand () % 300000);
+  }
+  Sim->Idle (2000000); // Ramps done, everything sent
+}
+
+static void Print (TouchBarLinkDecoder *Decoder, FILE *Out)
+{
+  const TouchBarLinkFrame *Frame = Decoder->GetFrame ();
+  TouchBarLinkState State;
+  byte Config, Field, Error, Sequence;
+  unsigned long Value;
+  if (Decoder->GetState (&State))
+    fprintf (Out, "S,%u,%u,%lu,%u,%lu,%lu,%c,%u,%u,%u,%u\n", Frame->Sequence, Frame->Id, State.Time, State.Fields, State.Position, State.Target, State.Tap ? State.Tap : '-', State.Gesture, State.GesturePads, State.Skipped, State.Broken);
+  else if (Decoder->GetValue (&Config, &Field, &Value, &Sequence))
+    fprintf (Out, "V,%u,%u,%u,%u,%lu,%u\n", Frame->Sequence, Frame->Id, Config, Field, Value, Sequence);
+  else if (Decoder->GetError (&Config, &Field, &Error, &Sequence))
+    fprintf (Out, "E,%u,%u,%u,%u,%u,%u\n", Frame->Sequence, Frame->Id, Config, Field, Error, Sequence);
+  else if (Frame->Type == LinkInfo && Frame->Length >= 6)
+    fprintf (Out, "I,%u,%u,%u,%u,%lu\n", Frame->Sequence, Frame->Id, Frame->Payload[0], Frame->Payload[1],
+             (unsigned long)Frame->Payload[2] << 24 | (unsigned long)Frame->Payload[3] << 16 | (unsigned long)Frame->Payload[4] << 8 | Frame->Payload[5]);
+}
+
+static void Telemetry (boolean Noise)
+{
+  unsigned long Samples = 0, TextBytes = 0, LineBytes = 0, Frames = 0, Bad = 0, Lost = 0, Flipped = 0;
+  srand (Noise ? 2 : 1);
+  for (int Run = 0; Run < 20; Run++)
+  {
+    TouchBarCommon Common = {(unsigned int)(100 + rand () % 500), (byte)(rand () % 30), micros, (unsigned long)(20000 + rand () % 300000), (unsigned long)(rand () % 5000)};
+    TouchBarConfig Config;
+    Config.Default = 5000;
+    Config.Limit = 10000;
+    Config.Resolution = 1 + rand () % 200;
+    Config.RampDelay = 1;
+    Config.RampResolution = 1 + rand () % 100;
+    Config.RampTime = rand () % 20000;
+    Config.RampProfile = rand () % 4;
+    Config.SetFlags ((boolean)(rand () % 2), (boolean)(rand () % 2), (boolean)(rand () % 2), (boolean)(rand () % 2));
+    Config.Gestures = 0x7E;
+
+    TouchBar Bar (&Common, &Config);
+    TouchBarLink Link (&Bar, &Common, &Config, 1, Output, Room, 20000, Run);
+    TouchBarLinkDecoder Decoder;
+    TouchBarLinkState State = {};
+    TouchBarSimulator Sim (100);
+    RandomScript (&Sim);
+    SetVirtualMicros (rand ());
+    Line.clear ();
+    Buffered = 0;
+    Drained = micros ();
+
+    byte Sample;
+    size_t Fed = 0;
+    unsigned long LastTime = 0;
+    boolean First = true;
+    unsigned long LastFlip = 0, PositionChanged = 1, TargetChanged = 1; // Samples
+    while (Sim.Next (&Sample))
+    {
+      TouchBarPosition Position = Bar.GetPositionInt (), Target = Bar.GetTargetInt ();
+      Bar.Update (Sample);
+      if (Bar.GetPositionInt () != Position)
+        PositionChanged = Samples + 1;
+      if (Bar.GetTargetInt () != Target)
+        TargetChanged = Samples + 1;
+      Link.Service ();
+      Samples += 1;
+      if (Bar.Event ())
+      {
+        char Text[32];
+        TextBytes += snprintf (Text, sizeof(Text), "CPos: %u.%02u\r\n", Bar.GetPositionInt () / 100, Bar.GetPositionInt () % 100);
+      }
+      if (Bar.PadEvent () != 'Z')
+        TextBytes += 16; // "Tapped pad A\r\n" and the like
+
+      for (; Fed < Line.size (); Fed++)
+      {
+        byte Data = Line[Fed];
+        if (Noise && Sim.Samples () - Samples > 30000 && rand () % 2000 == 0) // Not in the last 3 s, so the end comes through clean.
+        {
+          Data ^= 1 << rand () % 8;
+          Flipped += 1;
+          LastFlip = Samples;
+        }
+        if (Decoder.Feed (Data) && Decoder.GetState (&State))
+        {
+          if (First == false && State.Time - LastTime < 20000 && (State.Fields & LinkCounters) == 0)
+            Expect (false, "frames no closer then the Interval");
+          First = false;
+          LastTime = State.Time;
+          if (Noise == false && (State.Fields & LinkPosition))
+            Expect (State.Position == (Bar.GetPositionInt () & 0xFFFF), "the position sent is the latest"); // 16 bits on the line, as on the board
+        }
+      }
+    }
+    Link.Flush ();
+    for (; Fed < Line.size (); Fed++)
+      if (Decoder.Feed (Line[Fed]))
+        Decoder.GetState (&State);
+
+    // Nothing is sent again, so a frame hit by noise is made up for only by the next change. Whatever last changed after the last bit flipped has to come through.
+    if (LastFlip < PositionChanged)
+      Expect (State.Position == (Bar.GetPositionInt () & 0xFFFF), "the host ends up with the position of the bar");
+    if (LastFlip < TargetChanged)
+      Expect (State.Target == (Bar.GetTargetInt () & 0xFFFF), "the host ends up with the target of the bar");
+    if (Noise == false)
+      Expect (Decoder.GetBadFrames () == 0 && Decoder.GetLost () == 0, "no bad or lost frames on a clean line");
+    LineBytes += Line.size ();
+    Frames += Decoder.GetFrames ();
+    Bad += Decoder.GetBadFrames ();
+    Lost += Decoder.GetLost ();
+  }
+  if (Noise)
+  {
+    printf ("With noise: %lu bits flipped, %lu frames good, %lu bad, %lu lost\n", Flipped, Frames, Bad, Lost);
+    Expect (Bad > 0 && Lost > 0, "bad frames are noticed");
+  }
+  else
+  {
+    double Seconds = Samples / 10000.0;
+    printf ("%lu updates (%.0f s at 10 kHz): %lu frames, %lu bytes (%.0f bytes/s) on the link, %lu bytes (%.0f bytes/s) as text, the line carries 11520 bytes/s\n",
+            Samples, Seconds, Frames, LineBytes, LineBytes / Seconds, TextBytes, TextBytes / Seconds);
+  }
+}
+
+static boolean Answer (TouchBarLink *Link, TouchBarLinkDecoder *Decoder, const byte *Command, size_t Length)
+{
+  Line.clear ();
+  for (size_t i = 0; i < Length; i++)
+    Link->Receive (Command[i]);
+  boolean Got = false;
+  for (size_t i = 0; i < Line.size (); i++)
+    if (Decoder->Feed (Line[i]))
+      Got = true;
+  return Got;
+}
+
+static void Commands ()
+{
+  TouchBarCommon Common = {140, 20};
+  TouchBarConfig Config[2];
+  for (byte i = 0; i < 2; i++)
+  {
+    Config[i].Default = 5000;
+    Config[i].Limit = 10000;
+    Config[i].Resolution = 100;
+    Config[i].RampDelay = 100;
+    Config[i].RampResolution = 25;
+    Config[i].SetFlags (false, true, false, false);
+  }
+  TouchBar Bar (&Common, &Config[0]);
+  TouchBarLink Link (&Bar, &Common, Config, 2, Capture, 0, 20000, 3);
+  TouchBarLinkDecoder Decoder;
+  byte Command[LinkMaxPayload + 7];
+  byte ConfigNumber, Field, Error, Sequence;
+  unsigned long Value;
+
+  Expect (Answer (&Link, &Decoder, Command, TouchBarLinkDecoder::Hello (Command, 3, 1)) && Decoder.GetFrame ()->Type == LinkInfo && Decoder.GetFrame ()->Payload[1] == 2, "hello is answered with the number of configs");
+  Expect (Answer (&Link, &Decoder, Command, TouchBarLinkDecoder::Read (Command, LinkCommon, 2, 1, LinkLimit)) && Decoder.GetValue (&ConfigNumber, &Field, &Value, &Sequence)
+          && ConfigNumber == 1 && Field == LinkLimit && Value == 10000 && Sequence == 2, "read over the id all links answer to");
+  Expect (Answer (&Link, &Decoder, Command, TouchBarLinkDecoder::Read (Command, 4, 3, 1, LinkLimit)) == false, "another link's id is not answered");
+  Expect (Answer (&Link, &Decoder, Command, TouchBarLinkDecoder::Write (Command, 3, 4, 0, LinkResolution, 50)) && Decoder.GetValue (&ConfigNumber, &Field, &Value, &Sequence)
+          && Value == 50 && Config[0].Resolution == 50, "write");
+  Expect (Answer (&Link, &Decoder, Command, TouchBarLinkDecoder::Write (Command, 3, 5, LinkCommon, LinkTapTime, 123456)) && Decoder.GetValue (&ConfigNumber, &Field, &Value, &Sequence)
+          && Value == 123456 && Common.TapTime == 123456, "write a Common field");
+  Expect (Answer (&Link, &Decoder, Command, TouchBarLinkDecoder::Write (Command, 3, 6, 1, LinkFlags, 0xB0)) && Decoder.GetValue (&ConfigNumber, &Field, &Value, &Sequence)
+          && Value == 0x80 && Config[1].GetRollOverFlag () && Config[1].GetRampFlag () == false, "flags, RollOver overrides the rest");
+  Expect (Answer (&Link, &Decoder, Command, TouchBarLinkDecoder::Write (Command, 3, 7, 0, LinkLimit, 2)) && Decoder.GetError (&ConfigNumber, &Field, &Error, &Sequence)
+          && Error == LinkOutOfRange && Sequence == 7 && Config[0].Limit == 10000, "a bad value is refused");
+  Expect (Answer (&Link, &Decoder, Command, TouchBarLinkDecoder::Write (Command, 3, 8, 0, LinkDefault, 10001)) && Decoder.GetError (&ConfigNumber, &Field, &Error, &Sequence)
+          && Error == LinkOutOfRange && Config[0].Default == 5000, "Default over Limit is refused");
+  Expect (Answer (&Link, &Decoder, Command, TouchBarLinkDecoder::Read (Command, 3, 9, 2, LinkLimit)) && Decoder.GetError (&ConfigNumber, &Field, &Error, &Sequence)
+          && Error == LinkNoConfig, "no such config");
+  Expect (Answer (&Link, &Decoder, Command, TouchBarLinkDecoder::Read (Command, 3, 10, 0, 99)) && Decoder.GetError (&ConfigNumber, &Field, &Error, &Sequence)
+          && Error == LinkNoField, "no such field");
+  size_t Length = TouchBarLinkDecoder::Hello (Command, 3, 11);
+  Command[3] = 'X';
+  Command[Length - 1] ^= 0xFF; // (CRC of the changed frame below)
+  unsigned int Sum = 0xFFFF;
+  for (size_t i = 1; i < Length - 2; i++)
+    Sum = TouchBarLinkCrc (Sum, Command[i]);
+  Command[Length - 2] = Sum >> 8;
+  Command[Length - 1] = Sum;
+  Expect (Answer (&Link, &Decoder, Command, Length) && Decoder.GetError (&ConfigNumber, &Field, &Error, &Sequence) && Error == LinkNoCommand, "unknown command");
+
+  Length = TouchBarLinkDecoder::Write (Command, 3, 12, 0, LinkResolution, 70);
+  Command[8] ^= 0x10;
+  Expect (Answer (&Link, &Decoder, Command, Length) == false && Config[0].Resolution == 50 && Link.GetBroken () == 1, "a command with a bad CRC is dropped and counted");
+  // Garbage, then a good command: still answered.
+  byte Garbage[] = {LinkSync, 3, LinkSync, 0x72, 0x34}; // 0x72: longer then any payload, whatever the width
+  for (byte Data : Garbage)
+    Link.Receive (Data);
+  Expect (Answer (&Link, &Decoder, Command, TouchBarLinkDecoder::Read (Command, 3, 13, 0, LinkResolution)) && Decoder.GetValue (&ConfigNumber, &Field, &Value, &Sequence) && Value == 50, "answered after garbage");
+  Line.clear ();
+  Link.Service ();
+  TouchBarLinkState State;
+  boolean Got = false;
+  for (byte Data : Line)
+    if (Decoder.Feed (Data) && Decoder.GetState (&State))
+      Got = true;
+  Expect (Got && (State.Fields & LinkCounters) && State.Broken >= 1, "the counters go out with the next state frame");
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1 && strcmp (argv[1], "--check") == 0)
+  {
+    Telemetry (false);
+    Telemetry (true);
+    Commands ();
+    printf ("%ld failures\n", Errors);
+    return Errors != 0;
+  }
+
+  FILE *In = stdin;
+  if (argc > 1)
+    In = fopen (argv[1], "rb");
+  if (In == 0)
+  {
+    perror (argv[1]);
+    return 1;
+  }
+  TouchBarLinkDecoder Decoder;
+  int Data;
+  while ((Data = fgetc (In)) != EOF)
+    if (Decoder.Feed (Data))
+    {
+      Print (&Decoder, stdout);
+      fflush (stdout);
+    }
+  printf ("# %lu frames, %lu bad, %lu lost\n", Decoder.GetFrames (), Decoder.GetBadFrames (), Decoder.GetLost ());
+  return 0;
+}
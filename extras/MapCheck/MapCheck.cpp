@@ -0,0 +1,207 @@
+/*
+MapCheck - host tool that checks TouchBarMap against the same mapping done in double precision.
+
+- End points exact: 0 gives OutputMin, Limit gives OutputMax, and anything over Limit counts as Limit. 0 - 65535 and other full ranges too.
+- Reverse ranges (OutputMax under OutputMin) go the other way, just as exact.
+- Straight: every position (up to Limit 70000, 70000 spread out above) within half an output step, plus the position scaled to 16 bits (2 / 65536 of the range).
+- Curves: the same along each TouchBar*Curve, interpolated between its points (times the slope of the curve), and along a curve that goes down as well as up, or has just 2 points. Less then 2 points is a straight line.
+- The curve tables: each point is 65535 * f(x) of the formula it's generated from, and 33 points follow it within 0.3% (see TouchBarMap.cpp).
+- Never backwards: along a curve that only goes up (all the ones here) or a straight line, the output doesn't go down as the position goes up (or up, reversed).
+- SetLimit() gives the same as a new TouchBarMap. With TouchBarWide, Limits up to 2^32 - 1, odd ones over 65535 too.
+
+Build it from the library folder like so:
+g++ -O2 -I . *.cpp extras/MapCheck/MapCheck.cpp -o MapCheck
+And with -DTouchBarWide for the 32 bit Limits.
+
+Then:
+./MapCheck <<< Runs the check, returns non-zero on any failure.
+./MapCheck 1000 <<< Same, with the given number of random maps (300 by default).
+*/
+
+#include "TouchBar.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+static long Errors = 0;
+
+static void Expect (boolean Condition, const char *What)
+{
+  if (!Condition)
+  {
+    printf ("FAILED: %s\n", What);
+    Errors++;
+  }
+}
+
+static const uint16_t UpAndDown[5] = {0, 65535, 20000, 40000, 0}; // Not monotonic, to check it goes down between points as well
+static const uint16_t TwoPoints[2] = {65535, 0};
+
+struct Curve
+{
+  const char *Name;
+  const uint16_t *Points;
+  byte Count;
+  boolean Rising;
+  double (*Formula) (double X);
+}; // <<< ; at the end is important!!!
+
+static double Log (double X) { return 1 - (pow (100, 1 - X) - 1) / 99; }
+static double Exp (double X) { return (pow (100, X) - 1) / 99; }
+static double Gamma (double X) { return pow (X, 2.2); }
+static double S (double X) { return 3 * X * X - 2 * X * X * X; }
+
+static const Curve Curves[] =
+{
+  {"straight", 0, TouchBarCurvePoints, true, 0},
+  {"log", TouchBarLogCurve, TouchBarCurvePoints, true, Log},
+  {"exp", TouchBarExpCurve, TouchBarCurvePoints, true, Exp},
+  {"gamma", TouchBarGammaCurve, TouchBarCurvePoints, true, Gamma},
+  {"S", TouchBarSCurve, TouchBarCurvePoints, true, S},
+  {"up and down", UpAndDown, 5, false, 0},
+  {"2 points, down", TwoPoints, 2, false, 0},
+  {"1 point (a straight line)", UpAndDown, 1, true, 0}
+};
+
+static double Along (const Curve *C, double X) // 0 to 1, interpolated between the points like Map() does
+{
+  if (C->Points == 0 || C->Count < 2)
+    return X;
+  double Point = X * (C->Count - 1);
+  int Index = (int) Point;
+  if (Index >= C->Count - 1)
+    return C->Points[C->Count - 1] / 65535.0;
+  double From = C->Points[Index], To = C->Points[Index + 1];
+  return (From + (To - From) * (Point - Index)) / 65535.0;
+}
+
+static double Slope (const Curve *C) // Steepest part of the curve, 1 for a straight line
+{
+  double Most = 1;
+  if (C->Points != 0 && C->Count >= 2)
+    for (int i = 0; i + 1 < C->Count; i++)
+      Most = fmax (Most, fabs ((double) C->Points[i + 1] - C->Points[i]) * (C->Count - 1) / 65535);
+  return Most;
+}
+
+static void ExpectMap (boolean Condition, const char *What, const Curve *C, TouchBarPosition Limit, unsigned int Min, unsigned int Max, TouchBarPosition Position) // Expect(), with the map and the position in the message
+{
+  if (Condition)
+    return;
+  char Line[200];
+  snprintf (Line, sizeof (Line), "%s, Limit %lu, %u - %u, position %lu: %s", C->Name, (unsigned long) Limit, Min, Max, (unsigned long) Position, What);
+  Expect (false, Line);
+}
+
+static double Worst = 0; // In output steps
+
+static void CheckMap (const Curve *C, TouchBarPosition Limit, unsigned int Min, unsigned int Max)
+{
+  TouchBarMap Map (Limit, Min, Max, C->Points, C->Count);
+  TouchBarMap Moved (Limit / 2 + 1, Min, Max, C->Points, C->Count);
+  Moved.SetLimit (Limit);
+  double Span = (double) Max - Min;
+
+  ExpectMap (Map.Map (0) == (unsigned int) lround (Min + Span * Along (C, 0)), "0 gives OutputMin (or the first point)", C, Limit, Min, Max, 0);
+  ExpectMap (Map.Map (Limit) == (unsigned int) lround (Min + Span * Along (C, 1)), "Limit gives OutputMax (or the last point)", C, Limit, Min, Max, Limit);
+  TouchBarPosition Over[3] = {(TouchBarPosition)(Limit + 1), (TouchBarPosition)(Limit + 1000), (TouchBarPosition) -1};
+  for (int i = 0; i < 3; i++)
+    if (Over[i] > Limit)
+      ExpectMap (Map.Map (Over[i]) == Map.Map (Limit), "over Limit counts as Limit", C, Limit, Min, Max, Over[i]);
+
+  // Every position for the smaller Limits, spread out for the rest.
+  // Half a step for the rounding of the output, and 2 / 65536 of the range for the position scaled to 16 bits (Scale rounded down, then rounded), times the slope of the curve.
+  // With TouchBarWide and a Limit over 65535 the position is shifted down to 16 bits first, up to 2 / 65536 more.
+  double Scaled = 2;
+  if (Limit > 65535)
+    Scaled += 2;
+  double Tolerance = 0.5 + fabs (Span) * (Scaled * Slope (C) + 1) / 65536 + 1e-9;
+  unsigned long Count = Limit <= 70000 ? Limit + 1 : 70000;
+  unsigned int Previous = Map.Map (0);
+  for (unsigned long i = 0; i < Count; i++)
+  {
+    TouchBarPosition Position = i;
+    if (Limit > 70000) // Spread out, and the last few before Limit (where the TouchBarWide shift rounds Position and Limit the same)
+      Position = i >= Count - 4 ? Limit - (Count - 1 - i) : (TouchBarPosition)((unsigned long long) Limit * i / (Count - 1));
+    unsigned int Out = Map.Map (Position);
+    double Error = fabs (Out - (Min + Span * Along (C, (double) Position / Limit)));
+    if (Error > Worst)
+      Worst = Error;
+    ExpectMap (Error <= Tolerance, "within the tolerance of the double precision one", C, Limit, Min, Max, Position);
+    if (C->Rising)
+      ExpectMap (Max >= Min ? Out >= Previous : Out <= Previous, "never backwards", C, Limit, Min, Max, Position);
+    ExpectMap (Moved.Map (Position) == Out, "SetLimit() the same as a new one", C, Limit, Min, Max, Position);
+    Previous = Out;
+  }
+}
+
+static TouchBarPosition RandomLimit ()
+{
+#ifdef TouchBarWide
+  switch (rand () % 4)
+  {
+    case 0: return 1 + rand () % 1000;
+    break;;
+    case 1: return 1 + rand () % 65535;
+    break;;
+    case 2: return 65536 + rand () % 1000000;
+    break;;
+  }
+  return 65536 + ((unsigned long) rand () << 1 ^ rand ()) % (0xFFFFFFFFUL - 65535);
+#else
+  if (rand () % 2)
+    return 1 + rand () % 1000;
+  return 1 + rand () % 65535;
+#endif
+}
+
+
+
+int main (int argc, char **argv)
+{
+  long Runs = 300;
+  if (argc > 1)
+    Runs = atol (argv[1]);
+  srand (1);
+  char What[200];
+
+  // The tables against their formulas
+  for (unsigned int c = 1; c < sizeof (Curves) / sizeof (Curves[0]); c++)
+  {
+    const Curve *C = &Curves[c];
+    if (C->Formula == 0)
+      continue;
+    double Off = 0;
+    for (int i = 0; i <= 100000; i++)
+    {
+      double X = i / 100000.0;
+      Off = fmax (Off, fabs (Along (C, X) - C->Formula (X)));
+    }
+    snprintf (What, sizeof (What), "%s curve follows its formula within 0.3%% (%.2f%% off)", C->Name, Off * 100);
+    Expect (Off <= 0.003, What);
+    for (int i = 0; i < C->Count; i++)
+    {
+      snprintf (What, sizeof (What), "%s curve point %d is 65535 * f(%d / 32)", C->Name, i, i);
+      Expect (fabs (C->Points[i] - 65535 * C->Formula (i / 32.0)) <= 0.5 + 1e-6, What);
+    }
+  }
+
+  // The usual ones, and the full ranges
+  static const unsigned int Ranges[][2] = {{0, 255}, {0, 127}, {0, 16383}, {0, 65535}, {65535, 0}, {255, 0}, {1000, 2000}, {0, 0}, {7, 7}, {0, 1}, {1, 0}};
+#ifdef TouchBarWide
+  static const TouchBarPosition Limits[] = {1, 2, 3, 100, 10000, 65535, 65536, 65537, 100001, 0x7FFFFFFFUL, 0xFFFFFFFEUL, 0xFFFFFFFFUL};
+#else
+  static const TouchBarPosition Limits[] = {1, 2, 3, 100, 10000, 65534, 65535};
+#endif
+  for (unsigned int c = 0; c < sizeof (Curves) / sizeof (Curves[0]); c++)
+    for (unsigned int l = 0; l < sizeof (Limits) / sizeof (Limits[0]); l++)
+      for (unsigned int r = 0; r < sizeof (Ranges) / sizeof (Ranges[0]); r++)
+        CheckMap (&Curves[c], Limits[l], Ranges[r][0], Ranges[r][1]);
+
+  // And random ones
+  for (long i = 0; i < Runs; i++)
+    CheckMap (&Curves[rand () % (sizeof (Curves) / sizeof (Curves[0]))], RandomLimit (), rand () % 65536, rand () % 65536);
+
+  printf ("%.3f output steps off at worst, %ld failures\n", Worst, Errors);
+  return Errors != 0;
+}
@@ -0,0 +1,110 @@
+/*
+SlicedCheck - host tool that checks TouchBarSliced against 64 ordinary TouchBar objects, and measures how much faster it is.
+
+Every bar gets its own random pad stream (touching, holding, swiping and twitching at random), the same samples go through a TouchBar and through one lane of TouchBarSliced,
+and the directions have to match on every single update. Half of the bars have the Flip flag set, the TwitchSuppressionDelay is varied between runs.
+The scalar direction is read back from the position: Resolution = 1, no Ramp, no Snap, and the position is put back to the middle before each update, so it moves by +1, +2, -1 or -2.
+
+Build it from the library folder like so:
+g++ -O2 -I . *.cpp extras/SlicedCheck/SlicedCheck.cpp -o SlicedCheck
+
+Then:
+./SlicedCheck <<< Runs the check, returns non-zero on any mismatch.
+./SlicedCheck 1000000 <<< Same, with the given number of updates per run (100000 by default).
+*/
+
+#include "TouchBar.h"
+#include "TouchBarSliced.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static const unsigned int Centre = 30000;
+
+static byte ScalarDirection (TouchBar *TB)
+{
+  switch ((int) TB->GetPositionInt() - (int) Centre)
+  {
+    case 1: return Increment;
+    case 2: return Increment2;
+    case -1: return Decrement;
+    case -2: return Decrement2;
+    default: return Static;
+  }
+}
+
+static double Seconds ()
+{
+  struct timespec Now;
+  clock_gettime (CLOCK_MONOTONIC, &Now);
+  return Now.tv_sec + Now.tv_nsec / 1e9;
+}
+
+int main (int argc, char **argv)
+{
+  long Updates = argc > 1 ? atol (argv[1]) : 100000;
+  long Errors = 0;
+  srand (1);
+
+  static const byte Delays[4] = {0, 1, 20, 255};
+  for (byte Run = 0; Run < 4; Run++)
+  {
+    TouchBarCommon Common = {300, Delays[Run]};
+    TouchBarConfig Config[2];
+    for (byte i = 0; i < 2; i++)
+    {
+      Config[i].Default = Centre;
+      Config[i].Limit = 60000;
+      Config[i].Resolution = 1;
+      Config[i].RampDelay = 1;
+      Config[i].RampResolution = 1;
+      Config[i].SetFlags (false, false, false, i == 1);
+    }
+
+    TouchBar *Bars[64];
+    for (byte Bar = 0; Bar < 64; Bar++)
+      Bars[Bar] = new TouchBar (&Common, &Config[Bar & 0x01]);
+    TouchBarSliced Sliced (&Common);
+    Sliced.SetFlip (0xAAAAAAAAAAAAAAAAULL);
+
+    // Random streams, but with runs of the same sample so the twitch suppression actually lets something through.
+    byte Samples[64] = {0};
+    byte *Stream = (byte *) malloc (Updates * 64);
+    for (long i = 0; i < Updates; i++)
+      for (byte Bar = 0; Bar < 64; Bar++)
+      {
+        if (rand () % (1 + Delays[Run] / 4 + rand () % 8) == 0)
+          Samples[Bar] = rand () % 8;
+        Stream[i * 64 + Bar] = Samples[Bar];
+      }
+
+    for (long i = 0; i < Updates; i++)
+    {
+      Sliced.Update (&Stream[i * 64]);
+      for (byte Bar = 0; Bar < 64; Bar++)
+      {
+        Bars[Bar]->SetPosition (Centre);
+        Bars[Bar]->Update (Stream[i * 64 + Bar]);
+        if (ScalarDirection (Bars[Bar]) != Sliced.GetDirection (Bar) && Errors++ < 10)
+          printf ("Mismatch: delay %d, update %ld, bar %d: TouchBar %d, TouchBarSliced %d\n", Delays[Run], i, Bar, ScalarDirection (Bars[Bar]), Sliced.GetDirection (Bar));
+      }
+    }
+
+    // Timing, without the comparison
+    double Start = Seconds ();
+    for (long i = 0; i < Updates; i++)
+      for (byte Bar = 0; Bar < 64; Bar++)
+        Bars[Bar]->Update (Stream[i * 64 + Bar]);
+    double Middle = Seconds ();
+    for (long i = 0; i < Updates; i++)
+      Sliced.Update (&Stream[i * 64]);
+    double End = Seconds ();
+    printf ("TwitchSuppressionDelay %3d: %ld x 64 updates, TouchBar %.2f ns/bar, TouchBarSliced %.2f ns/bar (including packing the samples)\n", Delays[Run], Updates, (Middle - Start) * 1e9 / Updates / 64, (End - Middle) * 1e9 / Updates / 64);
+
+    free (Stream);
+    for (byte Bar = 0; Bar < 64; Bar++)
+      delete Bars[Bar];
+  }
+  printf ("%ld errors.\n", Errors);
+  return Errors != 0;
+}
@@ -0,0 +1,330 @@
+/*
+StateCheck - host tool that checks the warm restart: TouchBar::Snapshot() / Restore() and SaveTouchBarState() / LoadTouchBarState() on the emulated EEPROM.
+
+- A bar restored from a snapshot taken at a random point carries on exactly like the original (position, target, PadEvent(), Event() and Idle() after every update), random settings and pads every run.
+  Only a tap across the restart is lost (documented: a pad held during the reset isn't a tap), a run that has one ends there, and they're counted.
+- A flipped bit anywhere in the fields fails the CRC, Restore() returns false and leaves the bar alone.
+- A snapshot with a good CRC that doesn't fit (position or target over the Limit of the config, pad bits out of range) is turned down too.
+- Of the 2 EEPROM copies the newer one loads, through enough saves for the Generation to roll over. A save cut short at every byte loads the copy before it (or the new one, once it's complete), blank EEPROM loads nothing.
+Counting Update() calls only (no Clock): in wall-clock mode the ramp and the timing start over after a restore, on purpose.
+
+Build it from the library folder like so:
+g++ -O2 -I . *.cpp extras/StateCheck/StateCheck.cpp -o StateCheck
+
+Then:
+./StateCheck <<< Runs the check, returns non-zero on any failure.
+./StateCheck 10000 <<< Same, with the given number of restarts (2000 by default).
+*/
+
+#include "TouchBar.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static long Errors = 0;
+
+static void Expect (boolean Condition, const char *What)
+{
+  if (!Condition)
+  {
+    printf ("FAILED: %s\n", What);
+    Errors++;
+  }
+}
+
+static byte NextSample (byte Sample) // Same as FixedCheck: touching, holding, swiping and twitching at random.
+{
+  static const byte Up[6] = {1, 3, 2, 6, 4, 5};
+  switch (rand () % 8)
+  {
+    case 0: return 0;
+    case 1: return rand () % 8;
+    case 2: case 3:
+      for (byte i = 0; i < 6; i++)
+        if (Up[i] == Sample)
+          return Up[(i + 1) % 6];
+      return Up[0];
+    case 4:
+      for (byte i = 0; i < 6; i++)
+        if (Up[i] == Sample)
+          return Up[(i + 5) % 6];
+      return Up[0];
+    default: return Sample;
+  }
+}
+
+static byte Stream (byte Sample) // Keeps each state for a while, like a finger would.
+{
+  if (rand () % 4 == 0)
+    return NextSample (Sample);
+  return Sample;
+}
+
+static void Randomize (TouchBarCommon *Common, TouchBarConfig *Config)
+{
+  Common->TapTimeout = 20 + rand () % 300;
+  Common->TwitchSuppressionDelay = rand () % 30;
+  Config->Limit = 4 + rand () % 60000;
+  Config->Default = rand () % Config->Limit;
+  Config->Resolution = 1 + rand () % 255;
+  Config->RampDelay = 1 + rand () % 50;
+  Config->RampResolution = 1 + rand () % 255;
+  if (rand () % 4 == 0)
+    Config->SetFlags ((boolean)true, (boolean)(rand () % 2));
+  else
+    Config->SetFlags ((boolean)(rand () % 2), (boolean)(rand () % 2), (boolean)(rand () % 2), (boolean)(rand () % 2));
+}
+
+static byte Crc8 (const byte *Data, byte Length) // The snapshot's check, the same CRC-8 as TouchBarState.cpp (to make snapshots with a good CRC and bad contents).
+{
+  byte Crc = 0x5A;
+  for (byte i = 0; i < Length; i++)
+  {
+    Crc ^= Data[i];
+    for (byte j = 0; j < 8; j++)
+      if (Crc & 0x80)
+        Crc = (Crc << 1) ^ 0x07;
+      else
+        Crc <<= 1;
+  }
+  return Crc;
+}
+
+static void Seal (TouchBarSnapshot *State)
+{
+  byte Data[2 * TouchBarPositionBytes + 9];
+  byte Length = 0;
+  for (byte i = TouchBarPositionBytes; i > 0; i--)
+    Data[Length++] = State->Current >> (8 * (i - 1));
+  for (byte i = TouchBarPositionBytes; i > 0; i--)
+    Data[Length++] = State->Target >> (8 * (i - 1));
+  Data[Length++] = State->RampCounter >> 8;
+  Data[Length++] = State->RampCounter;
+  Data[Length++] = State->Direction;
+  Data[Length++] = State->ABCPads;
+  Data[Length++] = State->ABCPrevious[0];
+  Data[Length++] = State->ABCPrevious[1];
+  Data[Length++] = State->ABCPrevious[2];
+  Data[Length++] = State->TSCounter;
+  Data[Length++] = State->Generation;
+  State->Check = Crc8 (Data, Length);
+}
+
+// Restarts a bar at a random point, and runs the original and the restored one side by side. Returns false if a tap across the restart ended it early.
+static boolean Continue (long Run)
+{
+  TouchBarCommon Common = {140, 20};
+  TouchBarConfig Config;
+  Randomize (&Common, &Config);
+  TouchBar Original (&Common, &Config);
+  byte Sample = 0;
+  for (long i = rand () % 3000; i > 0; i--)
+  {
+    Sample = Stream (Sample);
+    Original.Update (Sample);
+  }
+
+  TouchBarSnapshot State;
+  memset (&State, 0xFF, sizeof(State)); // Whatever was in RTC memory
+  Original.Snapshot (&State);
+  TouchBar Restored (&Common, &Config);
+  if (Restored.Restore (&State) == false)
+  {
+    printf ("Run %ld: a fresh snapshot doesn't restore\n", Run);
+    Errors++;
+    return true;
+  }
+
+  for (long i = 0; i < 3000; i++)
+  {
+    Sample = Stream (Sample);
+    Original.Update (Sample);
+    Restored.Update (Sample);
+    if (Original.PadEvent () != 'Z' && Restored.PadEvent () == 'Z')
+      return false; // Touched before the restart, let go after.
+    if (Original.GetPositionInt () != Restored.GetPositionInt () || Original.GetTargetInt () != Restored.GetTargetInt () || Original.PadEvent () != Restored.PadEvent ()
+        || Original.Event () != Restored.Event () || Original.Idle () != Restored.Idle ())
+    {
+      printf ("Run %ld: update %ld after the restart differs: position %lu / %lu, target %lu / %lu, pad event %c / %c\n", Run, i, (unsigned long) Original.GetPositionInt (), (unsigned long) Restored.GetPositionInt (),
+              (unsigned long) Original.GetTargetInt (), (unsigned long) Restored.GetTargetInt (), Original.PadEvent (), Restored.PadEvent ());
+      Errors++;
+      return true;
+    }
+  }
+  return true;
+}
+
+static void Rejects ()
+{
+  TouchBarCommon Common = {140, 20};
+  TouchBarConfig Config;
+  Config.Default = 700;
+  Config.Limit = 1000;
+  Config.Resolution = 50;
+  Config.RampDelay = 10;
+  Config.RampResolution = 5;
+  Config.SetFlags (false, false, true, false);
+  TouchBarConfig Small = Config;
+  Small.Default = 100;
+  Small.Limit = 500;
+
+  TouchBar Source (&Common, &Config);
+  Source.SetTarget (900);
+  for (int i = 0; i < 20; i++)
+    Source.Update (i % 2 ? 2 : 3);
+  TouchBarSnapshot Good = {0, 0, 0, Static, 0, {0, 0, 0}, 0, 0, 0};
+  Source.Snapshot (&Good);
+
+  // A flipped bit anywhere in the fields.
+  long Passed = 0;
+  for (int Field = 0; Field < 10; Field++)
+  {
+    byte Bits = Field < 2 ? 8 * TouchBarPositionBytes : Field == 2 ? 16 : 8;
+    for (byte Bit = 0; Bit < Bits; Bit++)
+    {
+      TouchBarSnapshot Bad = Good;
+      switch (Field)
+      {
+        case 0: Bad.Current ^= (TouchBarPosition)1 << Bit;
+        break;;
+        case 1: Bad.Target ^= (TouchBarPosition)1 << Bit;
+        break;;
+        case 2: Bad.RampCounter ^= 1U << Bit;
+        break;;
+        case 3: Bad.Direction ^= 1 << Bit;
+        break;;
+        case 4: Bad.ABCPads ^= 1 << Bit;
+        break;;
+        case 5: case 6: case 7: Bad.ABCPrevious[Field - 5] ^= 1 << Bit;
+        break;;
+        case 8: Bad.TSCounter ^= 1 << Bit;
+        break;;
+        case 9: Bad.Check ^= 1 << Bit;
+        break;;
+      }
+      TouchBar Target (&Common, &Config);
+      if (Target.Restore (&Bad) || Target.GetPositionInt () != Config.Default || Target.GetTargetInt () != Config.Default)
+        Passed++;
+    }
+  }
+  Expect (Passed == 0, "a flipped bit is turned down, and the bar is left alone");
+
+  // Good CRC, but it doesn't fit.
+  TouchBar Other (&Common, &Small);
+  Expect (Other.Restore (&Good) == false && Other.GetPositionInt () == Small.Default, "a position over the Limit is turned down");
+  TouchBarSnapshot Bad = Good;
+  Bad.Current = 400;
+  Seal (&Bad);
+  Expect (Other.Restore (&Bad) == false, "a target over the Limit is turned down");
+  Bad.Target = 450;
+  Seal (&Bad);
+  Expect (Other.Restore (&Bad) == true && Other.GetPositionInt () == 400 && Other.GetTargetInt () == 450, "resealed within the Limit, it restores");
+  for (int k = 0; k < 4; k++)
+  {
+    Bad = Good;
+    if (k < 3)
+      Bad.ABCPrevious[k] = 8;
+    else
+      Bad.ABCPads |= 0x40;
+    Seal (&Bad);
+    TouchBar Target (&Common, &Config);
+    Expect (Target.Restore (&Bad) == false && Target.GetPositionInt () == Config.Default, "pad bits out of range are turned down");
+  }
+  memset (&Bad, 0xFF, sizeof(Bad));
+  TouchBar Blank (&Common, &Config);
+  Expect (Blank.Restore (&Bad) == false, "erased memory is turned down");
+}
+
+static void Eeprom ()
+{
+  const byte Count = 3;
+  const unsigned int Base = 100;
+  const unsigned int Copy = Count * sizeof(TouchBarSnapshot); // The second copy of every bar starts here
+  TouchBarCommon Common = {140, 20};
+  TouchBarConfig Config;
+  Config.Default = 500;
+  Config.Limit = 60000;
+  Config.Resolution = 10;
+  Config.RampDelay = 1;
+  Config.RampResolution = 1;
+  Config.SetFlags (false, false, false, false);
+  TouchBar Bars[Count] = {TouchBar (&Common, &Config), TouchBar (&Common, &Config), TouchBar (&Common, &Config)};
+  TouchBar Loaded[Count] = {TouchBar (&Common, &Config), TouchBar (&Common, &Config), TouchBar (&Common, &Config)};
+  byte *Data = EEPROM.getDataPtr ();
+
+  memset (Data, 0xFF, 1024);
+  Expect (LoadTouchBarState (Loaded, Count, Base) == 0, "blank EEPROM loads nothing");
+
+  // The newer copy wins, over and over (the Generation rolls over after 256 saves of a bar).
+  long Wrong = 0;
+  for (int Save = 0; Save < 600; Save++)
+  {
+    for (byte Bar = 0; Bar < Count; Bar++)
+      Bars[Bar].SetPosition (Save * (Bar + 1) % 60000);
+    Expect (SaveTouchBarState (Bars, Count, Base) == true, "a bar that moved is written");
+    if (LoadTouchBarState (Loaded, Count, Base) != Count)
+      Wrong++;
+    for (byte Bar = 0; Bar < Count; Bar++)
+      if (Loaded[Bar].GetPositionInt () != Bars[Bar].GetPositionInt ())
+        Wrong++;
+  }
+  Expect (Wrong == 0, "the newest save loads");
+  Expect (SaveTouchBarState (Bars, Count, Base) == false, "nothing moved, nothing is written");
+
+  // A save cut short: the copy it goes over is torn at every byte.
+  byte Before[1024], After[1024];
+  memcpy (Before, Data, 1024);
+  TouchBarPosition Old[Count], New[Count];
+  for (byte Bar = 0; Bar < Count; Bar++)
+  {
+    Old[Bar] = Bars[Bar].GetPositionInt ();
+    Bars[Bar].SetPosition (Old[Bar] + 1234);
+    New[Bar] = Bars[Bar].GetPositionInt ();
+  }
+  SaveTouchBarState (Bars, Count, Base);
+  memcpy (After, Data, 1024);
+  unsigned int First = 1024, Last = 0; // The bytes the save changed
+  for (unsigned int i = 0; i < 1024; i++)
+    if (Before[i] != After[i])
+    {
+      if (First == 1024)
+        First = i;
+      Last = i;
+    }
+  Expect (First >= Base && Last < Base + 2 * Copy, "the save stays within its area");
+  Wrong = 0;
+  for (unsigned int Cut = First; Cut <= Last + 1; Cut++)
+  {
+    memcpy (Data, Before, 1024);
+    memcpy (Data + First, After + First, Cut - First);
+    byte Restored = LoadTouchBarState (Loaded, Count, Base);
+    if (Restored != Count)
+      Wrong++;
+    for (byte Bar = 0; Bar < Count; Bar++)
+    {
+      TouchBarPosition Position = Loaded[Bar].GetPositionInt ();
+      if (Position != Old[Bar] && Position != New[Bar])
+        Wrong++;
+      if (Cut == Last + 1 && Position != New[Bar])
+        Wrong++;
+    }
+  }
+  Expect (Wrong == 0, "a save cut short at any byte loads the copy before it");
+  memcpy (Data, After, 1024);
+}
+
+int main (int argc, char **argv)
+{
+  long Runs = argc > 1 ? atol (argv[1]) : 2000;
+  long Cut = 0;
+  srand (1);
+
+  for (long Run = 0; Run < Runs; Run++)
+    if (Continue (Run) == false)
+      Cut++;
+  Rejects ();
+  Eeprom ();
+
+  printf ("%ld restarts (%ld ended early by a tap across the restart), %u byte snapshots, %ld failures\n", Runs, Cut, (unsigned int) sizeof(TouchBarSnapshot), Errors);
+  return Errors != 0;
+}
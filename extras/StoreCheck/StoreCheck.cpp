@@ -0,0 +1,217 @@
+/*
+StoreCheck - host tool that checks TouchBarStore on the emulated EEPROM.
+
+- Blank, zeroed and random EEPROM loads nothing (and leaves the settings alone).
+- Saved settings load back exactly, through many saves (so the slots go round and the sequence number rolls over).
+- A burst of Save() calls within CommitDelay is written once, and saving unchanged settings writes nothing.
+- A save cut short at every byte loads the record before it, a flipped bit anywhere in the newest record too.
+- A record of another version or ConfigCount is ignored.
+It also counts EEPROM.commit() calls (flash sector erases on ESP8266) against SaveTouchBarConfig() for the same changes.
+
+Build it from the library folder like so:
+g++ -O2 -I . *.cpp extras/StoreCheck/StoreCheck.cpp -o StoreCheck
+
+Then:
+./StoreCheck <<< Runs the check, returns non-zero on any failure.
+*/
+
+#include "TouchBar.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static long Errors = 0;
+
+static void Expect (boolean Condition, const char *What)
+{
+  if (!Condition)
+  {
+    printf ("FAILED: %s\n", What);
+    Errors++;
+  }
+}
+
+static void Randomize (TouchBarCommon *Common, TouchBarConfig *Config, byte Count)
+{
+  Common->TapTimeout = rand () & 0xFFFF; // unsigned int is 16 bits on AVR, and that much is stored
+  Common->TwitchSuppressionDelay = rand ();
+  Common->TapTime = ((unsigned long)rand () << 8) & 0xFFFFFFFF;
+  Common->TwitchSuppressionTime = ((unsigned long)rand () << 8) & 0xFFFFFFFF;
+  Common->DebounceDelay = rand () & 0xFFFF;
+  for (byte i = 0; i < Count; i++)
+  {
+    Config[i].Limit = 4 + rand () % 65000;
+    Config[i].Default = rand () % Config[i].Limit;
+    Config[i].Resolution = 1 + rand () % 255;
+    Config[i].RampDelay = rand ();
+    Config[i].RampResolution = 1 + rand () % 255;
+    if (rand () % 4 == 0)
+      Config[i].SetFlags ((boolean)true, (boolean)(rand () % 2));
+    else
+      Config[i].SetFlags ((boolean)(rand () % 2), (boolean)(rand () % 2), (boolean)(rand () % 2), (boolean)(rand () % 2));
+    Config[i].RampTime = ((unsigned long)rand () << 4) & 0xFFFFFFFF;
+    Config[i].RampProfile = rand () % 4;
+    Config[i].AccelerationSpeed = rand () & 0xFFFF;
+    Config[i].AccelerationLimit = rand ();
+    Config[i].FlingTime = ((unsigned long)rand () << 4) & 0xFFFFFFFF;
+    Config[i].FlingSpeed = rand () & 0xFFFF;
+    Config[i].Gestures = rand ();
+    Config[i].MultiTapTime = ((unsigned long)rand () << 4) & 0xFFFFFFFF;
+    Config[i].LongPressTime = ((unsigned long)rand () << 4) & 0xFFFFFFFF;
+  }
+}
+
+static boolean Same (TouchBarCommon *A, TouchBarConfig *AConfig, TouchBarCommon *B, TouchBarConfig *BConfig, byte Count)
+{
+  if (A->TapTimeout != B->TapTimeout || A->TwitchSuppressionDelay != B->TwitchSuppressionDelay || A->TapTime != B->TapTime || A->TwitchSuppressionTime != B->TwitchSuppressionTime || A->DebounceDelay != B->DebounceDelay)
+    return false;
+  for (byte i = 0; i < Count; i++)
+  {
+    TouchBarConfig *X = &AConfig[i], *Y = &BConfig[i];
+    if (X->Default != Y->Default || X->Limit != Y->Limit || X->Resolution != Y->Resolution || X->RampDelay != Y->RampDelay || X->RampResolution != Y->RampResolution
+        || X->GetRollOverFlag () != Y->GetRollOverFlag () || X->GetSpringBackFlag () != Y->GetSpringBackFlag () || X->GetSnapFlag () != Y->GetSnapFlag ()
+        || X->GetRampFlag () != Y->GetRampFlag () || X->GetFlipFlag () != Y->GetFlipFlag () || X->RampTime != Y->RampTime || X->RampProfile != Y->RampProfile
+        || X->AccelerationSpeed != Y->AccelerationSpeed || X->AccelerationLimit != Y->AccelerationLimit || X->FlingTime != Y->FlingTime || X->FlingSpeed != Y->FlingSpeed
+        || X->Gestures != Y->Gestures || X->MultiTapTime != Y->MultiTapTime || X->LongPressTime != Y->LongPressTime)
+      return false;
+  }
+  return true;
+}
+
+int main ()
+{
+  const byte Count = 3;
+  const unsigned int Base = 16;
+  TouchBarCommon Common = {0, 0}, Loaded = {0, 0}, Previous = {0, 0};
+  TouchBarConfig Config[Count], LoadedConfig[Count], PreviousConfig[Count];
+  srand (1);
+  EEPROM.begin (1024);
+
+  TouchBarStore Store (&Common, Config, Count, Base, 4, 2000);
+  TouchBarStore Reader (&Loaded, LoadedConfig, Count, Base, 4);
+
+  // Nothing to load
+  Randomize (&Loaded, LoadedConfig, Count);
+  Previous = Loaded;
+  memcpy ((void *)PreviousConfig, (void *)LoadedConfig, sizeof(LoadedConfig));
+  Expect (Reader.Load () == false, "blank EEPROM loads nothing");
+  memset (EEPROM.getDataPtr (), 0, 1024);
+  Expect (Reader.Load () == false, "zeroed EEPROM loads nothing");
+  for (int i = 0; i < 1024; i++)
+    EEPROM.getDataPtr ()[i] = rand ();
+  Expect (Reader.Load () == false, "random EEPROM loads nothing");
+  Expect (Same (&Loaded, LoadedConfig, &Previous, PreviousConfig, Count), "failed load leaves the settings alone");
+  memset (EEPROM.getDataPtr (), 0xFF, 1024);
+
+  // Round trips, 70000 of them so the sequence number rolls over
+  for (long i = 0; i < 70000; i++)
+  {
+    Randomize (&Common, Config, Count);
+    Expect (Store.Commit (), "changed settings are written");
+    if (i % 1000 == 0 || i > 65530)
+    {
+      Expect (Reader.Load () && Same (&Loaded, LoadedConfig, &Common, Config, Count), "saved settings load back");
+      if (Errors > 10)
+        return 1;
+    }
+  }
+  Expect (Reader.Load () && Same (&Loaded, LoadedConfig, &Common, Config, Count), "saved settings load back after the sequence rolled over");
+  Expect (Store.Commit () == false, "unchanged settings are not written");
+
+  // Deferred commit
+  unsigned long Commits = EEPROM.Commits;
+  SetVirtualMicros (0);
+  for (int i = 0; i < 50; i++)
+  {
+    Config[0].Default = i;
+    Store.Save ();
+    Expect (Store.Service () == false, "nothing is written while it keeps changing");
+    AdvanceVirtualMicros (100000);
+  }
+  Expect (Store.Pending (), "pending after Save()");
+  AdvanceVirtualMicros (2000000);
+  Expect (Store.Service (), "written CommitDelay after the last change");
+  Expect (Store.Pending () == false && Store.Service () == false, "written only once");
+  Expect (EEPROM.Commits - Commits == 1, "a burst of 50 changes is one commit");
+  Expect (Reader.Load () && LoadedConfig[0].Default == 49, "the last change is the one written");
+  Store.Save ();
+  AdvanceVirtualMicros (2000000);
+  Expect (Store.Service () == false && EEPROM.Commits - Commits == 1, "Save() without a change writes nothing");
+
+  // Cut short at every byte: the record before loads. (Writing stops part way into the next slot.)
+  byte *Data = EEPROM.getDataPtr ();
+  static byte Image[1024];
+  for (unsigned int Cut = 0; Cut < Store.SlotLength (); Cut++)
+  {
+    Previous = Common;
+    memcpy ((void *)PreviousConfig, (void *)Config, sizeof(Config));
+    memcpy (Image, Data, 1024);
+    Randomize (&Common, Config, Count);
+    Store.Commit ();
+    // Find the slot that changed, and put back everything from Cut on.
+    for (unsigned int Slot = 0; Slot < 4; Slot++)
+    {
+      unsigned int Start = Base + Slot * Store.SlotLength ();
+      if (memcmp (Image + Start, Data + Start, Store.SlotLength ()) != 0)
+        memcpy (Data + Start + Cut, Image + Start + Cut, Store.SlotLength () - Cut);
+    }
+    // The CRC fails, so the record before loads. (Unless the bytes left out were the same already, then it's the new one, complete.)
+    Expect (Reader.Load () && (Same (&Loaded, LoadedConfig, &Previous, PreviousConfig, Count) || Same (&Loaded, LoadedConfig, &Common, Config, Count)), "a save cut short loads the record before it");
+    Store.Load (); // Back to the record before, the next save goes over the broken one.
+  }
+
+  // A flipped bit anywhere in the newest record
+  Randomize (&Common, Config, Count);
+  Store.Commit ();
+  Previous = Common;
+  memcpy ((void *)PreviousConfig, (void *)Config, sizeof(Config));
+  memcpy (Image, Data, 1024);
+  Randomize (&Common, Config, Count);
+  Store.Commit ();
+  unsigned int Newest = 0;
+  for (unsigned int Slot = 0; Slot < 4; Slot++)
+    if (memcmp (Image + Base + Slot * Store.SlotLength (), Data + Base + Slot * Store.SlotLength (), Store.SlotLength ()) != 0)
+      Newest = Base + Slot * Store.SlotLength ();
+  memcpy (Image, Data, 1024);
+  for (unsigned int Bit = 0; Bit < Store.SlotLength () * 8; Bit++)
+  {
+    Data[Newest + Bit / 8] ^= 1 << Bit % 8;
+    Expect (Reader.Load () && Same (&Loaded, LoadedConfig, &Previous, PreviousConfig, Count), "a flipped bit loads the record before it");
+    memcpy (Data, Image, 1024);
+  }
+
+  // Other version, other ConfigCount
+  memcpy (Image, Data, 1024);
+  for (unsigned int i = 0; i < 1024; i++)
+    if ((Data[i] == 0x54 || Data[i] == 0x57) && Data[i + 1] == 3) // 'T', or 'W' with TouchBarWide
+      Data[i + 1] = 4;
+  Expect (Reader.Load () == false, "another version is ignored");
+  memcpy (Data, Image, 1024);
+  TouchBarStore Other (&Loaded, LoadedConfig, Count - 1, Base, 4);
+  Expect (Other.Load () == false, "another ConfigCount is ignored");
+
+  // Sector erases on ESP8266: the old way commits on every change, this commits once per burst.
+  memset (Data, 0xFF, 1024);
+  Commits = EEPROM.Commits;
+  for (int Burst = 0; Burst < 10; Burst++)
+  {
+    for (int i = 0; i < 20; i++)
+    {
+      Config[0].Default = Burst * 20 + i;
+#ifndef TouchBarWide
+      SaveTouchBarConfig (&Common, Config, Count, 600);
+#endif
+      Store.Save ();
+      Store.Service ();
+      AdvanceVirtualMicros (50000);
+    }
+    AdvanceVirtualMicros (3000000);
+    Store.Service ();
+  }
+  unsigned long StoreCommits = EEPROM.Commits - Commits;
+  printf ("200 changes in 10 bursts: %lu commits (the host build of SaveTouchBarConfig() takes the AVR path, on ESP8266 it commits on every one of the 200)\n", StoreCommits);
+  Expect (StoreCommits == 10, "one commit per burst");
+
+  printf ("%u bytes per slot, %ld failures\n", Store.SlotLength (), Errors);
+  return Errors != 0;
+}
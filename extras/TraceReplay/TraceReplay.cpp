@@ -0,0 +1,195 @@
+/*
+TraceReplay - host tool that replays a trace recorded on the board with TouchBarRecorder, and checks the recorder and the reader against each other.
+
+Record on the board (see "Recording a trace" in the documentation), save what came out to a file, then replay it with the same settings as on the board,
+the tool prints a CSV timeline (Time,Pads,Position,Target,Tap) of every update with a change, ready for a spreadsheet or gnuplot.
+
+Build it from the library folder like so:
+g++ -O2 -I . *.cpp extras/TraceReplay/TraceReplay.cpp -o TraceReplay
+
+Then:
+./TraceReplay --check <<< Records random scripts from TouchBarSimulator, replays them and compares every update with the live run, returns non-zero on any mismatch.
+./TraceReplay Trace.tbt [Default Limit Resolution RampDelay RampResolution Flags TapTimeout TwitchSuppressionDelay] > Timeline.csv
+  Flags: R(ollOver), S(pringBack), N (Snap), P (Ramp), F(lip) in any order, - for none. The defaults are those of the TouchBar-MPR121-Arduino example: 5000 10000 100 100 25 N 140 20
+*/
+
+#include "TouchBar.h"
+#include "TouchBarSimulator.h"
+#include "TouchBarTrace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static std::vector<byte> Trace;
+
+static void Output (byte Data)
+{
+  Trace.push_back (Data);
+}
+
+static void RandomScript (TouchBarSimulator *Sim)
+{
+  Sim->Clear ();
+  Sim->Idle (1000 + rand () % 100000);
+  for (int i = 0; i < 200; i++)
+  {
+    unsigned long Step = 500 + rand () % 20000;
+    switch (rand () % 6)
+    {
+      case 0: Sim->Tap ('A' + rand () % 3, 1000 + rand () % 60000); break;
+      case 1: Sim->LightSwipe (rand () % 2, 1 + rand () % 30, Step); break;
+      case 2: Sim->HardSwipe (rand () % 2, 1 + rand () % 30, Step); break;
+      case 3: Sim->SkipSwipe (rand () % 2, 1 + rand () % 30, Step); break;
+      case 4: Sim->Twitch (rand () % 8, 'A' + rand () % 3, 1 + rand () % 10, 100 + rand () % 4000); break;
+      case 5: Sim->Hold (rand () % 8, 1000 + rand () % 500000); break;
+    }
+    Sim->Idle (rand () % 3 == 0 ? 1000000 + rand () % 10000000 : rand () % 100000); // Long idle stretches as well, that's where the runs get long.
+  }
+}
+
+static void Timeline (FILE *Out, TouchBar *TB, byte Pads)
+{
+  char Tap = TB->PadEvent ();
+  if (TB->Event () || Tap != 'Z')
+    fprintf (Out, "%lu,%u,%u,%u,%c\n", micros (), Pads, TB->GetPositionInt (), TB->GetTargetInt (), Tap == 'Z' ? '-' : Tap);
+}
+
+static int Check ()
+{
+  long Errors = 0;
+  unsigned long TotalSamples = 0, TotalBytes = 0;
+  srand (1);
+  for (int Run = 0; Run < 40; Run++)
+  {
+    boolean WallClock = Run % 2;
+    TouchBarCommon Common = {(unsigned int)(50 + rand () % 500), (byte)(rand () % 30), WallClock ? micros : 0, (unsigned long)(20000 + rand () % 300000), (unsigned long)(rand () % 5000)};
+    TouchBarConfig Config;
+    Config.Default = 5000;
+    Config.Limit = 10000;
+    Config.Resolution = 1 + rand () % 200;
+    Config.RampDelay = 1 + rand () % 200;
+    Config.RampResolution = 1 + rand () % 100;
+    Config.RampTime = rand () % 50000;
+    if (rand () % 4 == 0)
+      Config.SetFlags (true, (boolean)(rand () % 2));
+    else
+      Config.SetFlags ((boolean)(rand () % 2), (boolean)(rand () % 2), (boolean)(rand () % 2), (boolean)(rand () % 2));
+    if (WallClock)
+      Config.RampProfile = rand () % 4;
+
+    TouchBarSimulator Sim (50 + rand () % 2000);
+    RandomScript (&Sim);
+
+    // Live run, recorded
+    Trace.clear ();
+    TouchBarRecorder Recorder (Output);
+    TouchBar Live (&Common, &Config);
+    Live.SetRecorder (&Recorder);
+    char *LiveText, *ReplayText;
+    size_t LiveLength, ReplayLength;
+    FILE *Out = open_memstream (&LiveText, &LiveLength);
+    fprintf (Out, "Time,Pads,Position,Target,Tap\n");
+    SetVirtualMicros (rand ());
+    byte Sample;
+    unsigned long Samples = 0;
+    while (Sim.Next (&Sample))
+    {
+      Live.Update (Sample);
+      Timeline (Out, &Live, Sample);
+      Samples += 1;
+    }
+    Recorder.Flush ();
+    fclose (Out);
+
+    // Replay
+    TouchBar Replayed (&Common, &Config);
+    TouchBarTraceReader Reader (Trace.data (), Trace.size ());
+    Out = open_memstream (&ReplayText, &ReplayLength);
+    unsigned long ReplaySamples = Reader.Replay (&Replayed, Out);
+    fclose (Out);
+
+    if (ReplaySamples != Samples || Reader.Error () || LiveLength != ReplayLength || memcmp (LiveText, ReplayText, LiveLength) != 0)
+    {
+      Errors += 1;
+      printf ("Run %d (%s): %lu samples live, %lu replayed, the timelines %s\n", Run, WallClock ? "Clock" : "cycle counts", Samples, ReplaySamples, LiveLength == ReplayLength && memcmp (LiveText, ReplayText, LiveLength) == 0 ? "match" : "differ");
+    }
+    if (Recorder.GetSamples () != Samples || Recorder.GetBytes () != Trace.size ())
+    {
+      Errors += 1;
+      printf ("Run %d: the recorder counted %lu samples and %lu bytes, should be %lu and %lu\n", Run, Recorder.GetSamples (), Recorder.GetBytes (), Samples, (unsigned long)Trace.size ());
+    }
+    free (LiveText);
+    free (ReplayText);
+    TotalSamples += Samples;
+    TotalBytes += Trace.size ();
+  }
+
+  // A trace cut short in the middle of a run is an error, not garbage. Cut between 2 runs it's just shorter, so out of all the cuts only one per run (and the bare header) read without an error.
+  byte Pads;
+  unsigned long Count, Start, Runs = 0, Clean = 0;
+  TouchBarTraceReader Full (Trace.data (), Trace.size ());
+  while (Full.Next (&Pads, &Count, &Start))
+    Runs += 1;
+  for (size_t Length = 0; Length <= Trace.size (); Length++)
+  {
+    TouchBarTraceReader Cut (Trace.data (), Length);
+    while (Cut.Next (&Pads, &Count, &Start));
+    if (Cut.Error () == false)
+      Clean += 1;
+  }
+  if (Clean != Runs + 1)
+  {
+    Errors += 1;
+    printf ("%lu runs, but %lu cuts read without an error\n", Runs, Clean);
+  }
+
+  printf ("%lu samples in %lu bytes (%.0f samples per byte, %lu bytes raw), %ld errors\n", TotalSamples, TotalBytes, (double)TotalSamples / TotalBytes, TotalSamples, Errors);
+  return Errors != 0;
+}
+
+static void SetFlags (TouchBarConfig *Config, const char *Flags)
+{
+  if (strchr (Flags, 'R') != 0)
+    Config->SetFlags (true, strchr (Flags, 'F') != 0);
+  else
+    Config->SetFlags (strchr (Flags, 'S') != 0, strchr (Flags, 'N') != 0, strchr (Flags, 'P') != 0, strchr (Flags, 'F') != 0);
+}
+
+int main (int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    printf ("Usage: TraceReplay --check | TraceReplay Trace.tbt [Default Limit Resolution RampDelay RampResolution Flags TapTimeout TwitchSuppressionDelay]\n");
+    return 2;
+  }
+  if (strcmp (argv[1], "--check") == 0)
+    return Check ();
+
+  FILE *File = fopen (argv[1], "rb");
+  if (File == 0)
+  {
+    fprintf (stderr, "Can't open %s\n", argv[1]);
+    return 2;
+  }
+  TouchBarCommon Common = {(unsigned int)(argc > 8 ? atoi (argv[8]) : 140), (byte)(argc > 9 ? atoi (argv[9]) : 20)};
+  TouchBarConfig Config;
+  Config.Default = argc > 2 ? atoi (argv[2]) : 5000;
+  Config.Limit = argc > 3 ? atoi (argv[3]) : 10000;
+  Config.Resolution = argc > 4 ? atoi (argv[4]) : 100;
+  Config.RampDelay = argc > 5 ? atoi (argv[5]) : 100;
+  Config.RampResolution = argc > 6 ? atoi (argv[6]) : 25;
+  SetFlags (&Config, argc > 7 ? argv[7] : "N");
+
+  TouchBar TB (&Common, &Config);
+  TouchBarTraceReader Reader (File); // Streamed, so it takes traces of any length.
+  unsigned long Samples = Reader.Replay (&TB, stdout);
+  fclose (File);
+  fprintf (stderr, "%lu samples replayed\n", Samples);
+  if (Reader.Error ())
+  {
+    fprintf (stderr, "The trace is broken (wrong header, or cut short in the middle of a run).\n");
+    return 1;
+  }
+  return 0;
+}